@@ -0,0 +1,230 @@
+// algorithm/char_filter.hpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_ALGORITHM_CHAR_FILTER
+#define INCLUDED_ALGORITHM_CHAR_FILTER
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE4_2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// A filter keeping only the characters of a set given at construction time,
+// e.g., to sanitise identifiers. There are three kernels which all write
+// the kept characters to `out` and return the end of the output; `out` may
+// be equal to `first`, i.e., the filtering can be done in place. Otherwise
+// `out` needs to have space for `last - first` characters as the vector
+// kernels store more bytes than they keep:
+//
+// - filter_scalar() looks up each character in a table.
+// - filter_sse42() classifies 16 characters at a time using pcmpestrm: the
+//   set is described by up to 8 ranges of characters or, if it needs more
+//   ranges, by groups of 16 characters.
+// - filter_avx2() classifies 32 characters at a time using nibble lookups:
+//   the low nibble of a character selects a byte from one of two tables
+//   (for the high nibble below and at least 8) whose bits indicate which
+//   high nibbles are in the set.
+//
+// AVX2 has no instruction to compress the kept bytes. Instead, each group
+// of eight bytes is compressed using a shuffle selected by the 8 bit mask of
+// kept bytes from a table with 256 entries. The vector kernels fall back to
+// the scalar kernel when the corresponding instructions aren't enabled;
+// has_sse42() and has_avx2() tell whether they are.
+
+namespace cpu {
+    namespace algorithm {
+        class char_filter;
+
+        namespace detail {
+            // the shuffle indices moving the bytes selected by a mask to the front
+            struct compress_table {
+                std::uint64_t index[256];
+                constexpr compress_table(): index() {
+                    for (unsigned mask(0u); mask != 256u; ++mask) {
+                        int out(0);
+                        for (int bit(0); bit != 8; ++bit) {
+                            if (mask & (1u << bit)) {
+                                this->index[mask] |= std::uint64_t(bit) << (8 * out++);
+                            }
+                        }
+                    }
+                }
+            };
+            inline constexpr compress_table compress{};
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::algorithm::char_filter {
+private:
+    bool                  d_table[256]{};
+    alignas(16) unsigned char d_low[16]{};  // high nibbles 0-7 for each low nibble
+    alignas(16) unsigned char d_high[16]{}; // high nibbles 8-15 for each low nibble
+    std::vector<std::uint8_t> d_needles;    // ranges or groups of 16 characters
+    bool                      d_ranges{};
+
+    char* p_scalar(char const* it, char const* last, char* out) const {
+        for (; it != last; ++it) {
+            *out = *it;
+            out += this->d_table[static_cast<unsigned char>(*it)];
+        }
+        return out;
+    }
+#if defined(__SSE4_2__) || defined(__AVX2__)
+    // Writes the bytes of the low 8 bytes of `chars` selected by `mask`. All 8
+    // bytes are stored, i.e., up to 8 bytes after the new end are clobbered.
+    static char* p_compress8(__m128i chars, unsigned mask, char* out) {
+        __m128i const index(_mm_cvtsi64_si128(detail::compress.index[mask]));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(chars, index));
+        return out + __builtin_popcount(mask);
+    }
+    static char* p_compress16(__m128i chars, unsigned mask, char* out) {
+        out = p_compress8(chars, mask & 0xFFu, out);
+        return p_compress8(_mm_srli_si128(chars, 8), mask >> 8, out);
+    }
+#endif
+
+public:
+    explicit char_filter(std::string_view allowed) {
+        for (unsigned char c: allowed) {
+            this->d_table[c] = true;
+        }
+        for (unsigned c(0u); c != 256u; ++c) {
+            if (this->d_table[c]) {
+                (c < 128u? this->d_low: this->d_high)[c & 0xFu] |= 1u << ((c >> 4) & 0x7u);
+            }
+        }
+        std::vector<std::uint8_t> ranges;
+        for (unsigned c(0u); c != 256u; ++c) {
+            if (this->d_table[c] && (c == 0u || !this->d_table[c - 1u])) {
+                ranges.push_back(c);
+            }
+            if (this->d_table[c] && (c == 255u || !this->d_table[c + 1u])) {
+                ranges.push_back(c);
+            }
+        }
+        this->d_ranges = ranges.size() <= 16u;
+        if (this->d_ranges) {
+            this->d_needles = ranges;
+        }
+        else {
+            for (unsigned c(0u); c != 256u; ++c) {
+                if (this->d_table[c]) {
+                    this->d_needles.push_back(c);
+                }
+            }
+        }
+        // the groups are padded by repeating their last character
+        while (this->d_needles.size() % 16u) {
+            this->d_needles.push_back(this->d_needles.empty()? 0u: this->d_needles.back());
+        }
+    }
+
+    static constexpr bool has_sse42() {
+#if defined(__SSE4_2__)
+        return true;
+#else
+        return false;
+#endif
+    }
+    static constexpr bool has_avx2() {
+#if defined(__AVX2__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool allowed(char c) const { return this->d_table[static_cast<unsigned char>(c)]; }
+
+    char* filter_scalar(char const* first, char const* last, char* out) const {
+        return this->p_scalar(first, last, out);
+    }
+
+    char* filter_sse42(char const* first, char const* last, char* out) const {
+#if defined(__SSE4_2__)
+        if (this->d_needles.empty()) {
+            return out;
+        }
+        __m128i const* needles(reinterpret_cast<__m128i const*>(this->d_needles.data()));
+        if (this->d_ranges) {
+            // unused ranges repeat the last range
+            __m128i const ranges(_mm_loadu_si128(needles));
+            for (; 16 <= last - first; first += 16) {
+                __m128i const chars(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first)));
+                __m128i const mask(_mm_cmpestrm(ranges, 16, chars, 16,
+                                                _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK));
+                out = p_compress16(chars, unsigned(_mm_cvtsi128_si32(mask)), out);
+            }
+        }
+        else {
+            std::size_t const groups(this->d_needles.size() / 16u);
+            for (; 16 <= last - first; first += 16) {
+                __m128i const chars(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first)));
+                unsigned mask(0u);
+                for (std::size_t g(0u); g != groups; ++g) {
+                    mask |= unsigned(_mm_cvtsi128_si32(
+                        _mm_cmpestrm(_mm_loadu_si128(needles + g), 16, chars, 16,
+                                     _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK)));
+                }
+                out = p_compress16(chars, mask, out);
+            }
+        }
+#endif
+        return this->p_scalar(first, last, out);
+    }
+
+    char* filter_avx2(char const* first, char const* last, char* out) const {
+#if defined(__AVX2__)
+        __m256i const low(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(this->d_low))));
+        __m256i const high(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(this->d_high))));
+        __m256i const bits(_mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                            1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+        __m256i const nibble(_mm256_set1_epi8(0x0F));
+        for (; 32 <= last - first; first += 32) {
+            __m256i const chars(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(first)));
+            __m256i const lo(_mm256_and_si256(chars, nibble));
+            __m256i const hi(_mm256_and_si256(_mm256_srli_epi16(chars, 4), nibble));
+            __m256i const row(_mm256_blendv_epi8(_mm256_shuffle_epi8(low, lo),
+                                                 _mm256_shuffle_epi8(high, lo), chars));
+            __m256i const bit(_mm256_shuffle_epi8(bits, hi));
+            unsigned const mask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+            out = p_compress16(_mm256_castsi256_si128(chars), mask & 0xFFFFu, out);
+            out = p_compress16(_mm256_extracti128_si256(chars, 1), mask >> 16, out);
+        }
+#endif
+        return this->p_scalar(first, last, out);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
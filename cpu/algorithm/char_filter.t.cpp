@@ -0,0 +1,145 @@
+// algorithm/char_filter.t.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "char_filter.hpp"
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+namespace CA = cpu::algorithm;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    using kernel = char* (CA::char_filter::*)(char const*, char const*, char*) const;
+
+    std::string expected(CA::char_filter const& filter, std::string const& text) {
+        std::string rc;
+        for (char c: text) {
+            if (filter.allowed(c)) {
+                rc.push_back(c);
+            }
+        }
+        return rc;
+    }
+
+    // All byte values with different lengths, in place and into a separate
+    // buffer.
+    bool filters(std::string const& allowed, kernel k) {
+        CA::char_filter filter(allowed);
+        std::mt19937 gen(17);
+        std::uniform_int_distribution<int> dist(0, 255);
+        for (std::size_t size: { 0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u, 1000u, 4099u }) {
+            std::string text(size, '\0');
+            for (char& c: text) {
+                c = char(dist(gen));
+            }
+            std::string const expect(expected(filter, text));
+
+            std::string out(text.size(), 'x');
+            out.resize((filter.*k)(text.data(), text.data() + text.size(), out.data()) - out.data());
+
+            std::string in_place(text);
+            in_place.resize((filter.*k)(in_place.data(), in_place.data() + in_place.size(),
+                                        in_place.data()) - in_place.data());
+            if (out != expect || in_place != expect) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string all_but(std::string const& removed) {
+        std::string rc;
+        for (int c(0); c != 256; ++c) {
+            if (removed.find(char(c)) == std::string::npos) {
+                rc.push_back(char(c));
+            }
+        }
+        return rc;
+    }
+
+    bool filters(std::string const& allowed) {
+        return filters(allowed, &CA::char_filter::filter_scalar)
+            && filters(allowed, &CA::char_filter::filter_sse42)
+            && filters(allowed, &CA::char_filter::filter_avx2)
+            ;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "char_filter digits", []{ return filters("0123456789"); } },
+    { "char_filter identifiers", []{
+            return filters("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-");
+        }
+    },
+    { "char_filter empty set", []{ return filters(""); } },
+    { "char_filter single character", []{ return filters("x"); } },
+    { "char_filter many ranges", []{ return filters("acegikmoqsuwy02468"); } },
+    { "char_filter high and null characters", []{ return filters(std::string("\0\x80\xff\x7f a", 6)); } },
+    { "char_filter all but a few", []{ return filters(all_but(std::string("\0a\xff", 3))); } },
+    { "char_filter availability", []{
+            std::cout << "(sse42=" << CA::char_filter::has_sse42()
+                      << " avx2=" << CA::char_filter::has_avx2() << ") ";
+            return true;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -4,6 +4,8 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/memory/huge_page_allocator.hpp"
+#include "cpu/algorithm/streaming.hpp"
 
 #include <algorithm>
 #include <numeric>
@@ -13,6 +15,8 @@
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <sstream>
+#include <string>
 #include <stdlib.h>
 
 // namespace PSTL = std::experimental::parallel::v1;
@@ -46,17 +50,66 @@ namespace
             return PSTL::copy(PSTL::par, begin, end, to);
         }
     };
+
+    // The streaming copy either uses the default threshold or always uses
+    // non-temporal stores with different prefetch distances.
+    struct stream_copy
+    {
+        cpu::algorithm::streaming_config config;
+        std::string name() const {
+            std::ostringstream out;
+            out << "algorithm::stream_copy(";
+            if (this->config.threshold) {
+                out << "threshold=" << this->config.threshold;
+            }
+            else {
+                out << "prefetch=" << this->config.prefetch;
+            }
+            return out.str() + ")";
+        }
+        template <typename InIt, typename OutIt>
+        OutIt operator()(InIt begin, InIt end, OutIt to) const {
+            return to + (cpu::algorithm::stream_copy(&*begin, &*begin + (end - begin), &*to, this->config)
+                         - &*to);
+        }
+    };
+
+    // The fill competitors only write the output.
+    struct std_fill
+    {
+        static char const* name() { return "std::fill()"; }
+        template <typename InIt, typename OutIt>
+        OutIt operator()(InIt begin, InIt end, OutIt to) const {
+            std::fill(to, to + (end - begin), 17);
+            return to + (end - begin);
+        }
+    };
+    struct stream_fill
+    {
+        static char const* name() { return "algorithm::stream_fill()"; }
+        template <typename InIt, typename OutIt>
+        OutIt operator()(InIt begin, InIt end, OutIt to) const {
+            cpu::algorithm::stream_fill(&*to, &*to + (end - begin), 17);
+            return to + (end - begin);
+        }
+    };
 }
 
 // ----------------------------------------------------------------------------
 
 namespace
 {
+    // the number of times each element is accessed
     template <typename Competitor>
-    void measure(cpu::tube::context&     context,
-                 std::vector<int> const& from,
-                 std::vector<int>&       to,
-                 Competitor const&       competitor)
+    unsigned accesses(Competitor const&) { return 2u; }
+    unsigned accesses(std_fill const&)    { return 1u; }
+    unsigned accesses(stream_fill const&) { return 1u; }
+
+    template <typename Competitor>
+    void measure(cpu::tube::context&                       context,
+                 cpu::memory::huge_page_vector<int> const& from,
+                 cpu::memory::huge_page_vector<int>&       to,
+                 Competitor const&                         competitor)
     {
         auto timer = context.start();
         competitor(from.begin(), from.end(), to.begin());
@@ -64,12 +117,13 @@ namespace
 
         std::ostringstream out;
         out << competitor.name() << " [" << from.size() << "]";
-        context.report(out.str(), time, "<none>");
+        context.report(out.str(), time, "<none>",
+                       cpu::tube::work::of<int>(from.size(), accesses(competitor)));
     }
 
     void run_tests(cpu::tube::context& context, int size) {
-        std::vector<int> from;
-        std::vector<int> to(size);
+        cpu::memory::huge_page_vector<int> from;
+        cpu::memory::huge_page_vector<int> to(size);
         int value(0);
         std::generate_n(std::back_inserter(from), size,
                         [value]() mutable { return ++value; });
@@ -78,6 +132,12 @@ namespace
         measure(context, from, to, std_copy());
         measure(context, from, to, pstl_copy_seq());
         measure(context, from, to, pstl_copy_par());
+        measure(context, from, to, stream_copy{});
+        for (std::size_t prefetch: { 0u, 256u, 512u, 1024u, 2048u }) {
+            measure(context, from, to, stream_copy{{ 0u, prefetch }});
+        }
+        measure(context, from, to, std_fill());
+        measure(context, from, to, stream_fill());
     }
 }
 
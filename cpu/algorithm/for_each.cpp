@@ -4,10 +4,14 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/numa.hpp"
+#include "cpu/memory/huge_page_allocator.hpp"
+#include "cpu/memory/numa_array.hpp"
 
 #include <algorithm>
 #include <numeric>
 #include <complex>
+#include <string>
 #include <thread>
 #include <future>
 #if 0
@@ -66,6 +70,22 @@ namespace
             for (auto& t: threads) { t.join(); }
         }
     };
+    struct numa_thread_for_each
+    {
+        // the pinned workers are started before the measurement
+        cpu::tube::numa_pool& pool{cpu::tube::numa_pool::system()};
+        static char const* name() { return "numa thread for_each()"; }
+        template <typename InIt, typename Fun>
+        void operator()(InIt begin, InIt end, Fun fun) const {
+            // uses the same chunks as a partitioned numa_array
+            int workers(this->pool.workers());
+            long size(std::distance(begin, end));
+            this->pool.run([=](int w){
+                    std::for_each(begin + size * w / workers,
+                                  begin + size * (w + 1) / workers, fun);
+                });
+        }
+    };
     struct async_for_each
     {
         static char const* name() { return "async for_each()"; }
@@ -169,25 +189,36 @@ namespace
 
 namespace
 {
-    template <typename Competitor, typename Fun>
+    template <typename T>
+    std::string placement(cpu::memory::huge_page_vector<T> const&) {
+        return "";
+    }
+    template <typename T>
+    std::string placement(cpu::memory::numa_array<T> const& array) {
+        return std::string(" [") + cpu::memory::to_string(array.placement()) + "]";
+    }
+
+    template <typename Competitor, typename Range, typename Fun>
     void measure(cpu::tube::context&     context,
-                 std::vector<int> const& from,
+                 Range const&            from,
                  Fun                     fun,
                  Competitor const&       competitor)
     {
-        std::vector<int> tmp(from);
+        Range tmp(from);
         auto timer = context.start();
         competitor(tmp.begin(), tmp.end(), fun);
         auto time = timer.measure();
 
         std::ostringstream out;
-        out << competitor.name() << " [" << from.size() << "]";
-        context.report(out.str(), time, "<none>");
+        out << competitor.name() << placement(from) << " [" << from.size() << "]";
+        // each element is read and written
+        context.report(out.str(), time, "<none>",
+                       cpu::tube::work::of<int>(from.size(), 2u));
     }
 
     template <typename Fun>
     void run_tests(cpu::tube::context& context, int size, Fun fun) {
-        std::vector<int> from;
+        cpu::memory::huge_page_vector<int> from;
         int value(0);
         std::generate_n(std::back_inserter(from), size,
                         [value]() mutable { return ++value; });
@@ -195,6 +226,7 @@ namespace
         measure(context, from, fun, std_for_each());
         measure(context, from, fun, std_for_each());
         measure(context, from, fun, thread_for_each());
+        measure(context, from, fun, numa_thread_for_each());
         measure(context, from, fun, async_for_each());
 #ifdef HAS_PSTL
         measure(context, from, fun, pstl_for_each_seq());
@@ -207,6 +239,20 @@ namespace
         measure(context, from, fun, tbb_for_each());
         measure(context, from, fun, omp_for_each());
         measure(context, from, fun, hpx_for_each());
+
+        // The parallel competitors with the pages placed on the NUMA nodes:
+        // the copies being processed keep the placement of the original.
+        for (auto p: { cpu::memory::numa_placement::local,
+                       cpu::memory::numa_placement::interleaved,
+                       cpu::memory::numa_placement::partitioned }) {
+            cpu::memory::numa_array<int> placed(from.size(), p,
+                                                [&from](std::size_t i){ return from[i]; });
+            measure(context, placed, fun, thread_for_each());
+            measure(context, placed, fun, numa_thread_for_each());
+            measure(context, placed, fun, nstd_for_each_par());
+            measure(context, placed, fun, tbb_for_each());
+            measure(context, placed, fun, omp_for_each());
+        }
     }
 }
 
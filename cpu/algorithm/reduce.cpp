@@ -4,11 +4,15 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/numa.hpp"
+#include "cpu/memory/huge_page_allocator.hpp"
+#include "cpu/memory/numa_array.hpp"
 
 #include <algorithm>
 #include <functional>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <nstd/execution/execution.hpp>
@@ -66,6 +70,39 @@ namespace
             return value;
         }
     };
+    struct numa_thread_reduce
+    {
+        // the pinned workers are started before the measurement
+        cpu::tube::numa_pool& pool{cpu::tube::numa_pool::system()};
+        static char const* name() { return "numa thread reduce"; }
+        template <typename InIt, typename T, typename Op>
+        T operator()(InIt begin, InIt end, T init, Op op) const {
+            // uses the same chunks as a partitioned numa_array
+            int workers(this->pool.workers());
+            long size(std::distance(begin, end));
+            // each partial starts with the first element of its chunk and
+            // init is applied once; empty chunks don't contribute
+            std::vector<T>    partial(workers);
+            std::vector<char> used(workers);
+            this->pool.run([&](int w){
+                    InIt it(begin + size * w / workers), to(begin + size * (w + 1) / workers);
+                    if (it != to) {
+                        T value(*it);
+                        while (++it != to) {
+                            value = op(value, *it);
+                        }
+                        partial[w] = value;
+                        used[w]    = true;
+                    }
+                });
+            for (int w(0); w != workers; ++w) {
+                if (used[w]) {
+                    init = op(init, partial[w]);
+                }
+            }
+            return init;
+        }
+    };
 #ifdef HAS_PSTL_REDUCE
     struct pstl_reduce_seq
     {
@@ -163,9 +200,18 @@ namespace
 
 namespace
 {
-    template <typename Competitor, typename T, typename Op>
+    template <typename T>
+    std::string placement(cpu::memory::huge_page_vector<T> const&) {
+        return "";
+    }
+    template <typename T>
+    std::string placement(cpu::memory::numa_array<T> const& array) {
+        return std::string(" [") + cpu::memory::to_string(array.placement()) + "]";
+    }
+
+    template <typename Competitor, typename Range, typename T, typename Op>
     void measure(cpu::tube::context&        context,
-                 std::vector<double> const& range,
+                 Range const&               range,
                  T                          init,
                  Op                         op,
                  Competitor const&          competitor)
@@ -175,16 +221,17 @@ namespace
         auto time = timer.measure();
 
         std::ostringstream out;
-        out << competitor.name() << " [" << range.size() << "]";
+        out << competitor.name() << placement(range) << " [" << range.size() << "]";
         std::ostringstream aux;
         aux.precision(9);
         aux << result;
-        context.report(out.str(), time, aux.str());
+        context.report(out.str(), time, aux.str(),
+                       cpu::tube::work::of<double>(range.size()));
     }
 
     template <typename T, typename Op>
     void run_tests(cpu::tube::context& context, int size, T init, Op op) {
-        std::vector<double> range;
+        cpu::memory::huge_page_vector<double> range;
         int value(0);
         std::generate_n(std::back_inserter(range), size,
                         [value, size]() mutable {
@@ -196,6 +243,7 @@ namespace
         measure(context, range, init, op, std_reduce());
 #endif
         measure(context, range, init, op, loop_reduce());
+        measure(context, range, init, op, numa_thread_reduce());
 #ifdef HAS_PSTL_REDUCE
         measure(context, range, init, op, pstl_reduce_seq());
         measure(context, range, init, op, pstl_reduce_par());
@@ -207,6 +255,18 @@ namespace
         measure(context, range, init, op, omp_reduce());
         measure(context, range, init, op, tbb_reduce());
         measure(context, range, init, op, hpx_reduce());
+
+        // The parallel competitors with the pages placed on the NUMA nodes.
+        for (auto p: { cpu::memory::numa_placement::local,
+                       cpu::memory::numa_placement::interleaved,
+                       cpu::memory::numa_placement::partitioned }) {
+            cpu::memory::numa_array<double> placed(range.size(), p,
+                                                   [&range](std::size_t i){ return range[i]; });
+            measure(context, placed, init, op, numa_thread_reduce());
+            measure(context, placed, init, op, nstd_reduce_par());
+            measure(context, placed, init, op, omp_reduce());
+            measure(context, placed, init, op, tbb_reduce());
+        }
     }
 }
 
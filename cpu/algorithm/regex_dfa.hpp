@@ -0,0 +1,465 @@
+// algorithm/regex_dfa.hpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_ALGORITHM_REGEX_DFA
+#define INCLUDED_ALGORITHM_REGEX_DFA
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// A simple regular expression compiled into a deterministic finite
+// automaton when the object is constructed. The supported syntax is
+//
+//     literal characters, '.' (any character but '\n'), character classes
+//     "[...]" with ranges and negation (as in ECMAScript "[]" is empty),
+//     the escapes \d \D \w \W \s \S and escaped special characters,
+//     grouping "(...)", alternatives "|", and the repetitions "*", "+",
+//     and "?".
+//
+// The pattern is turned into an NFA (Thompson's construction) which is
+// converted into a DFA using the subset construction. The characters are
+// mapped to equivalence classes such that the transition table has one row
+// per state with one entry per class.
+//
+// remove_matches() removes all non-overlapping leftmost-longest matches
+// (which agree with the ECMAScript semantics of std::regex_replace() for
+// simple patterns) using the table to find the longest match at each
+// position. When no match is longer than one character, whether a
+// character is removed only depends on the character, and the text can be
+// split into independent streams: remove_matches_interleaved() processes
+// four streams in the same loop to overlap the table lookups. For other
+// patterns it uses remove_matches().
+
+namespace cpu {
+    namespace algorithm {
+        class regex_dfa;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::algorithm::regex_dfa {
+public:
+    static constexpr std::size_t npos{std::numeric_limits<std::size_t>::max()};
+
+private:
+    using set = std::bitset<256>;
+    struct nfa_state {
+        set              chars;
+        int              next{-1}; // the target of a character transition
+        std::vector<int> epsilon;
+    };
+    struct fragment {
+        int start;
+        int end;
+    };
+
+    // compile time data
+    std::string_view       d_pattern;
+    std::size_t            d_pos{};
+    std::vector<nfa_state> d_nfa;
+
+    // the DFA: state 0 is the dead state
+    unsigned char              d_class[256]{};
+    std::size_t                d_classes{};
+    std::vector<std::uint32_t> d_table;
+    std::vector<bool>          d_accept;
+    std::uint32_t              d_start{};
+    std::size_t                d_max_length{};
+
+    [[noreturn]] void p_error(char const* message) const {
+        throw std::invalid_argument("regex_dfa: " + std::string(message) + " at position "
+                                    + std::to_string(this->d_pos) + " in '"
+                                    + std::string(this->d_pattern) + "'");
+    }
+    bool p_at(char c) const {
+        return this->d_pos != this->d_pattern.size() && this->d_pattern[this->d_pos] == c;
+    }
+    int p_state() {
+        this->d_nfa.emplace_back();
+        return int(this->d_nfa.size() - 1u);
+    }
+    fragment p_chars(set const& chars) {
+        fragment rc{this->p_state(), this->p_state()};
+        this->d_nfa[rc.start].chars = chars;
+        this->d_nfa[rc.start].next  = rc.end;
+        return rc;
+    }
+    fragment p_empty() {
+        fragment rc{this->p_state(), this->p_state()};
+        this->d_nfa[rc.start].epsilon.push_back(rc.end);
+        return rc;
+    }
+
+    static set p_range(unsigned char first, unsigned char last) {
+        set rc;
+        for (unsigned c(first); c <= last; ++c) {
+            rc.set(c);
+        }
+        return rc;
+    }
+    static char p_single(set const& chars) {
+        unsigned c(0u);
+        while (!chars[c]) {
+            ++c;
+        }
+        return char(c);
+    }
+    set p_escape() {
+        if (this->d_pos == this->d_pattern.size()) {
+            this->p_error("trailing backslash");
+        }
+        char c(this->d_pattern[this->d_pos++]);
+        set  digit(p_range('0', '9'));
+        set  word(digit | p_range('a', 'z') | p_range('A', 'Z'));
+        word.set('_');
+        set  space;
+        for (char s: std::string_view(" \t\n\r\f\v")) {
+            space.set(static_cast<unsigned char>(s));
+        }
+        switch (c) {
+        case 'd': return digit;
+        case 'D': return ~digit;
+        case 'w': return word;
+        case 'W': return ~word;
+        case 's': return space;
+        case 'S': return ~space;
+        case 'n': return set().set('\n');
+        case 't': return set().set('\t');
+        case 'r': return set().set('\r');
+        default:  return set().set(static_cast<unsigned char>(c));
+        }
+    }
+    set p_class() {
+        bool negate(this->p_at('^'));
+        this->d_pos += negate;
+        set rc;
+        while (!this->p_at(']')) {
+            if (this->d_pos == this->d_pattern.size()) {
+                this->p_error("unterminated character class");
+            }
+            char c(this->d_pattern[this->d_pos++]);
+            if (c == '\\') {
+                set chars(this->p_escape());
+                if (chars.count() != 1u) {
+                    rc |= chars;
+                    continue;
+                }
+                c = p_single(chars);
+            }
+            if (this->p_at('-') && this->d_pos + 1u < this->d_pattern.size()
+                && this->d_pattern[this->d_pos + 1u] != ']') {
+                ++this->d_pos;
+                char last(this->d_pattern[this->d_pos++]);
+                if (last == '\\') {
+                    set chars(this->p_escape());
+                    if (chars.count() != 1u) {
+                        this->p_error("invalid range");
+                    }
+                    last = p_single(chars);
+                }
+                if (static_cast<unsigned char>(last) < static_cast<unsigned char>(c)) {
+                    this->p_error("invalid range");
+                }
+                rc |= p_range(c, last);
+            }
+            else {
+                rc.set(static_cast<unsigned char>(c));
+            }
+        }
+        ++this->d_pos;
+        return negate? ~rc: rc;
+    }
+    fragment p_atom() {
+        char c(this->d_pattern[this->d_pos++]);
+        switch (c) {
+        case '(': {
+            fragment rc(this->p_alternatives());
+            if (!this->p_at(')')) {
+                this->p_error("missing ')'");
+            }
+            ++this->d_pos;
+            return rc;
+        }
+        case '[':  return this->p_chars(this->p_class());
+        case '.':  return this->p_chars(~set().set('\n'));
+        case '\\': return this->p_chars(this->p_escape());
+        case '*': case '+': case '?': case ')':
+            --this->d_pos;
+            this->p_error("unexpected character");
+        default:   return this->p_chars(set().set(static_cast<unsigned char>(c)));
+        }
+    }
+    fragment p_repeat() {
+        fragment rc(this->p_atom());
+        while (this->p_at('*') || this->p_at('+') || this->p_at('?')) {
+            char op(this->d_pattern[this->d_pos++]);
+            fragment f{this->p_state(), this->p_state()};
+            this->d_nfa[f.start].epsilon.push_back(rc.start);
+            this->d_nfa[rc.end].epsilon.push_back(f.end);
+            if (op != '+') {
+                this->d_nfa[f.start].epsilon.push_back(f.end);
+            }
+            if (op != '?') {
+                this->d_nfa[rc.end].epsilon.push_back(rc.start);
+            }
+            rc = f;
+        }
+        return rc;
+    }
+    fragment p_sequence() {
+        if (this->d_pos == this->d_pattern.size() || this->p_at('|') || this->p_at(')')) {
+            return this->p_empty();
+        }
+        fragment rc(this->p_repeat());
+        while (this->d_pos != this->d_pattern.size() && !this->p_at('|') && !this->p_at(')')) {
+            fragment next(this->p_repeat());
+            this->d_nfa[rc.end].epsilon.push_back(next.start);
+            rc.end = next.end;
+        }
+        return rc;
+    }
+    fragment p_alternatives() {
+        fragment rc(this->p_sequence());
+        while (this->p_at('|')) {
+            ++this->d_pos;
+            fragment next(this->p_sequence());
+            fragment f{this->p_state(), this->p_state()};
+            this->d_nfa[f.start].epsilon = { rc.start, next.start };
+            this->d_nfa[rc.end].epsilon.push_back(f.end);
+            this->d_nfa[next.end].epsilon.push_back(f.end);
+            rc = f;
+        }
+        return rc;
+    }
+
+    std::vector<int> p_closure(std::vector<int> states) const {
+        std::vector<bool> seen(this->d_nfa.size());
+        for (int s: states) {
+            seen[s] = true;
+        }
+        for (std::size_t i(0u); i != states.size(); ++i) {
+            for (int next: this->d_nfa[states[i]].epsilon) {
+                if (!seen[next]) {
+                    seen[next] = true;
+                    states.push_back(next);
+                }
+            }
+        }
+        std::sort(states.begin(), states.end());
+        return states;
+    }
+    void p_compile(int match) {
+        // characters contained in the same character sets share a class
+        std::map<std::vector<bool>, unsigned char> signatures;
+        unsigned char                              representative[256];
+        for (unsigned c(0u); c != 256u; ++c) {
+            std::vector<bool> signature;
+            for (nfa_state const& s: this->d_nfa) {
+                if (s.next != -1) {
+                    signature.push_back(s.chars[c]);
+                }
+            }
+            auto it(signatures.emplace(signature, signatures.size()).first);
+            this->d_class[c] = it->second;
+            representative[it->second] = c;
+        }
+        this->d_classes = signatures.size();
+
+        std::map<std::vector<int>, std::uint32_t> ids{ { std::vector<int>(), 0u } };
+        std::vector<std::vector<int>>             states{ std::vector<int>() };
+        this->d_start = ids.emplace(this->p_closure({ 0 }), 1u).first->second;
+        states.push_back(this->p_closure({ 0 }));
+        for (std::size_t s(0u); s != states.size(); ++s) {
+            this->d_accept.push_back(std::binary_search(states[s].begin(), states[s].end(), match));
+            for (std::size_t k(0u); k != this->d_classes; ++k) {
+                std::vector<int> next;
+                for (int n: states[s]) {
+                    if (this->d_nfa[n].next != -1 && this->d_nfa[n].chars[representative[k]]) {
+                        next.push_back(this->d_nfa[n].next);
+                    }
+                }
+                next = this->p_closure(next);
+                auto it(ids.emplace(next, states.size()));
+                if (it.second) {
+                    states.push_back(next);
+                }
+                this->d_table.push_back(it.first->second);
+            }
+        }
+    }
+    // the length of the longest path from the start to an accepting state;
+    // the length of each state is computed once: mark is 1 while the state
+    // is being visited (i.e., reaching it again is a cycle) and 2 once its
+    // length is known
+    std::size_t p_max_length(std::uint32_t state, std::vector<int>& mark,
+                             std::vector<std::size_t>& length) const {
+        if (mark[state] == 2) {
+            return length[state];
+        }
+        if (mark[state] == 1) {
+            return npos; // a cycle
+        }
+        mark[state] = 1;
+        std::size_t rc(this->d_accept[state]? 0u: npos - 1u);
+        for (std::size_t k(0u); k != this->d_classes; ++k) {
+            std::uint32_t next(this->d_table[state * this->d_classes + k]);
+            if (next != 0u) {
+                std::size_t next_length(this->p_max_length(next, mark, length));
+                if (next_length == npos) {
+                    return npos;
+                }
+                if (next_length != npos - 1u) {
+                    rc = rc == npos - 1u? next_length + 1u: std::max(rc, next_length + 1u);
+                }
+            }
+        }
+        mark[state]   = 2;
+        length[state] = rc;
+        return rc;
+    }
+
+public:
+    explicit regex_dfa(std::string_view pattern)
+        : d_pattern(pattern) {
+        int const start(this->p_state()); // state 0 is the start
+        fragment  body(this->p_alternatives());
+        if (this->d_pos != this->d_pattern.size()) {
+            this->p_error("unmatched ')'");
+        }
+        this->d_nfa[start].epsilon.push_back(body.start);
+        this->p_compile(body.end);
+        std::vector<int>         mark(this->states());
+        std::vector<std::size_t> length(this->states());
+        this->d_max_length = this->p_max_length(this->d_start, mark, length);
+        this->d_nfa.clear();
+        this->d_nfa.shrink_to_fit();
+    }
+
+    std::size_t states() const { return this->d_accept.size(); }
+    std::size_t classes() const { return this->d_classes; }
+    // the length of the longest match or npos if it is unbounded
+    std::size_t max_match_length() const { return this->d_max_length; }
+
+    // the length of the longest match starting at `it` or npos if none
+    std::size_t longest_match(char const* it, char const* last) const {
+        std::uint32_t state(this->d_start);
+        std::size_t   rc(this->d_accept[state]? 0u: npos);
+        for (char const* begin(it); it != last; ) {
+            state = this->d_table[state * this->d_classes
+                                  + this->d_class[static_cast<unsigned char>(*it++)]];
+            if (state == 0u) {
+                break;
+            }
+            if (this->d_accept[state]) {
+                rc = it - begin;
+            }
+        }
+        return rc;
+    }
+    bool matches(std::string_view text) const {
+        return this->longest_match(text.data(), text.data() + text.size()) == text.size();
+    }
+
+    // Writes the text without the matches to `out` (which may be `first`)
+    // and returns the end of the output. Empty matches don't remove anything.
+    char* remove_matches(char const* first, char const* last, char* out) const {
+        if (this->d_max_length == 1u) {
+            std::uint32_t const* row(this->d_table.data() + this->d_start * this->d_classes);
+            for (; first != last; ++first) {
+                *out = *first;
+                out += !this->d_accept[row[this->d_class[static_cast<unsigned char>(*first)]]];
+            }
+            return out;
+        }
+        while (first != last) {
+            std::size_t length(this->longest_match(first, last));
+            if (length == npos || length == 0u) {
+                *out++ = *first++;
+            }
+            else {
+                first += length;
+            }
+        }
+        return out;
+    }
+
+    // Like remove_matches() but for single character matches the text is
+    // processed as four interleaved streams; `out` has to be `first` or
+    // has to have space for `last - first` characters.
+    char* remove_matches_interleaved(char const* first, char const* last, char* out) const {
+        constexpr int streams{4};
+        std::size_t const size(last - first);
+        if (this->d_max_length != 1u || size < 64u) {
+            return this->remove_matches(first, last, out);
+        }
+        std::vector<unsigned char> keep(256u);
+        std::uint32_t const* row(this->d_table.data() + this->d_start * this->d_classes);
+        for (unsigned c(0u); c != 256u; ++c) {
+            keep[c] = !this->d_accept[row[this->d_class[c]]];
+        }
+
+        std::size_t const length(size / streams);
+        char const*       in[streams];
+        char*             to[streams];
+        for (int s(0); s != streams; ++s) {
+            in[s] = first + s * length;
+            to[s] = out + s * length;
+        }
+        for (std::size_t i(0u); i != length; ++i) {
+            for (int s(0); s != streams; ++s) {
+                unsigned char c(*in[s]++);
+                *to[s] = char(c);
+                to[s] += keep[c];
+            }
+        }
+        // the last stream also takes the remainder; then join the streams
+        for (; in[streams - 1] != last; ++in[streams - 1]) {
+            *to[streams - 1] = *in[streams - 1];
+            to[streams - 1] += keep[static_cast<unsigned char>(*in[streams - 1])];
+        }
+        char* end(to[0]);
+        for (int s(1); s != streams; ++s) {
+            char* begin(out + s * length);
+            std::memmove(end, begin, to[s] - begin);
+            end += to[s] - begin;
+        }
+        return end;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
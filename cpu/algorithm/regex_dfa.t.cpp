@@ -0,0 +1,195 @@
+// algorithm/regex_dfa.t.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "regex_dfa.hpp"
+#include <iostream>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+namespace CA = cpu::algorithm;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    std::string random_text(std::size_t size, char const* alphabet) {
+        std::mt19937 gen(17);
+        std::string  chars(alphabet);
+        std::string  rc;
+        for (std::size_t i(0u); i != size; ++i) {
+            rc.push_back(chars[gen() % chars.size()]);
+        }
+        return rc;
+    }
+
+    // Compares full matches of all short strings over the alphabet and the
+    // removal of the matches from a random text with std::regex.
+    bool like_std_regex(char const* pattern, char const* alphabet) {
+        CA::regex_dfa dfa(pattern);
+        std::regex    re(pattern);
+        std::string   chars(alphabet);
+        std::vector<std::string> texts{ "" };
+        for (std::size_t i(0u); i != texts.size() && texts[i].size() < 4u; ++i) {
+            for (char c: chars) {
+                texts.push_back(texts[i] + c);
+            }
+        }
+        for (std::string const& text: texts) {
+            if (dfa.matches(text) != std::regex_match(text, re)) {
+                std::cout << "pattern='" << pattern << "' text='" << text << "' ";
+                return false;
+            }
+        }
+        std::string text(random_text(1000u, alphabet));
+        std::string expect(std::regex_replace(text, re, ""));
+        std::string out(text.size(), '\0');
+        out.resize(dfa.remove_matches(text.data(), text.data() + text.size(), &out[0]) - out.data());
+        std::string interleaved(text);
+        interleaved.resize(dfa.remove_matches_interleaved(interleaved.data(),
+                                                          interleaved.data() + interleaved.size(),
+                                                          &interleaved[0]) - interleaved.data());
+        if (out != expect || interleaved != expect) {
+            std::cout << "pattern='" << pattern << "' ";
+            return false;
+        }
+        return true;
+    }
+
+    bool rejects(char const* pattern) {
+        try {
+            CA::regex_dfa dfa(pattern);
+            return false;
+        }
+        catch (std::invalid_argument const&) {
+            return true;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "regex_dfa character classes", []{
+            return like_std_regex("\\D", "a0 9x\n")
+                && like_std_regex("[^0-9a-z_-]", "a0-_Z9 .")
+                && like_std_regex("[]a]", "]ab")
+                && like_std_regex("[a\\]]", "]ab")
+                && like_std_regex("[\\d.]", "1.x")
+                && like_std_regex("\\w", "a_ -")
+                && like_std_regex("\\s", "a \t\n")
+                && like_std_regex(".", "a\n")
+                ;
+        }
+    },
+    { "regex_dfa sequences and alternatives", []{
+            return like_std_regex("ab", "abc")
+                && like_std_regex("ab|cd", "abcd")
+                && like_std_regex("a(b|c)d", "abcd")
+                && like_std_regex("x|", "xy")
+                ;
+        }
+    },
+    { "regex_dfa repetitions", []{
+            return like_std_regex("[0-9]+", "12a ")
+                && like_std_regex("a*b", "ab")
+                && like_std_regex("a?b", "ab")
+                && like_std_regex("(ab)+", "abx")
+                && like_std_regex("a*", "ab")
+                && like_std_regex("x(a|b)*y", "abxy")
+                ;
+        }
+    },
+    { "regex_dfa max_match_length", []{
+            return CA::regex_dfa("\\D").max_match_length() == 1u
+                && CA::regex_dfa("ab|c").max_match_length() == 2u
+                && CA::regex_dfa("a?").max_match_length() == 1u
+                && CA::regex_dfa("a+").max_match_length() == CA::regex_dfa::npos
+                ;
+        }
+    },
+    { "regex_dfa long repeated alternation", []{
+            // each state has several classes leading to the same target:
+            // the longest match has to be found without visiting all paths
+            std::string pattern, optional;
+            for (int i(0); i != 40; ++i) {
+                pattern  += "(a|b|c|d)";
+                optional += "(a|b|c|d)?";
+            }
+            CA::regex_dfa dfa(pattern);
+            return dfa.max_match_length() == 40u
+                && dfa.matches(std::string(40, 'c'))
+                && CA::regex_dfa(optional).max_match_length() == 40u;
+        }
+    },
+    { "regex_dfa classes", []{
+            // the classes are the characters in and not in the set; the
+            // states are the dead, the start, and the accepting state
+            CA::regex_dfa single("[^0-9a-z]");
+            CA::regex_dfa pair("[0-9][0-9a-z]");
+            return single.classes() == 2u && single.states() == 3u
+                && pair.classes() == 3u && pair.states() == 4u;
+        }
+    },
+    { "regex_dfa invalid patterns", []{
+            return rejects("(a") && rejects("a)") && rejects("[a") && rejects("*")
+                && rejects("a\\") && rejects("[z-a]");
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -4,6 +4,7 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/memory/huge_page_allocator.hpp"
 
 #include <algorithm>
 #include <numeric>
@@ -132,26 +133,28 @@ namespace
 namespace
 {
     template <typename Competitor, typename Comp>
-    void measure(cpu::tube::context&     context,
-                 std::vector<int> const& from,
-                 Comp                    comp,
-                 Competitor const&       competitor)
+    void measure(cpu::tube::context&                       context,
+                 cpu::memory::huge_page_vector<int> const& from,
+                 Comp                                      comp,
+                 Competitor const&                         competitor)
     {
-        std::vector<int> tmp(from);
+        cpu::memory::huge_page_vector<int> tmp(from);
         auto timer = context.start();
         competitor(tmp.begin(), tmp.end(), comp);
         auto time = timer.measure();
 
         std::ostringstream out;
         out << competitor.name() << " [" << from.size() << "]";
-        context.report(out.str(), time, "<none>");
+        // the bytes moved depend on the algorithm: only the items are reported
+        context.report(out.str(), time, "<none>",
+                       cpu::tube::work{ 0u, from.size() });
     }
 
     template <typename Comp>
     void run_tests(cpu::tube::context& context, int size, Comp comp) {
         std:: minstd_rand simple_rand;
         simple_rand.seed(42);
-        std::vector<int> from;
+        cpu::memory::huge_page_vector<int> from;
         std::generate_n(std::back_inserter(from), size, simple_rand);
 
         measure(context, from, comp, std_sort());
@@ -0,0 +1,243 @@
+// cpu/algorithm/streaming.hpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_ALGORITHM_STREAMING
+#define INCLUDED_ALGORITHM_STREAMING
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__GLIBC__)
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Versions of copy, fill, and transform for trivially copyable types which
+// write the output using non-temporal stores when it is at least
+// `threshold` bytes: normal stores first read each cache line of the
+// destination (write allocate), i.e., a third of the memory traffic of a
+// copy is wasted when the output doesn't fit into the caches anyway. The
+// streaming stores go to memory without reading the line and without
+// displacing the cache contents. An sfence at the end makes the stores
+// visible to other threads in order with later stores.
+//
+// The output is written in cache lines using two 32 byte AVX stores after
+// storing the elements up to the first cache line boundary normally, i.e.,
+// each pair of streaming stores fills one complete line. If
+// `prefetch` isn't zero, the input `prefetch` bytes ahead is prefetched for
+// each cache line. Outputs below the threshold, the tail after the last
+// complete line, builds without AVX, and types whose size doesn't divide 32
+// use the std algorithms.
+//
+// The default threshold is half the last level cache as reported by the C
+// library or 8MB if it doesn't report it.
+
+namespace cpu {
+    namespace algorithm {
+        struct streaming_config;
+        std::size_t default_streaming_threshold();
+        constexpr bool has_streaming() {
+#if defined(__AVX__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        template <typename T>
+        T* stream_copy(T const* first, T const* last, T* to, streaming_config const& config);
+        template <typename T>
+        T* stream_copy(T const* first, T const* last, T* to);
+        template <typename T>
+        void stream_fill(T* first, T* last, T const& value, streaming_config const& config);
+        template <typename T>
+        void stream_fill(T* first, T* last, T const& value);
+        template <typename S, typename T, typename Fun>
+        T* stream_transform(S const* first, S const* last, T* to, Fun fun,
+                            streaming_config const& config);
+        template <typename S, typename T, typename Fun>
+        T* stream_transform(S const* first, S const* last, T* to, Fun fun);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::algorithm::streaming_config {
+    std::size_t threshold{cpu::algorithm::default_streaming_threshold()};
+    std::size_t prefetch{0u}; // bytes; 0 means no prefetch
+};
+
+inline std::size_t
+cpu::algorithm::default_streaming_threshold() {
+    static std::size_t const threshold([]{
+#if defined(__GLIBC__) && defined(_SC_LEVEL3_CACHE_SIZE)
+            long size(::sysconf(_SC_LEVEL3_CACHE_SIZE));
+            if (0 < size) {
+                return std::size_t(size) / 2u;
+            }
+#endif
+            return std::size_t(8u) << 20;
+        }());
+    return threshold;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace cpu {
+    namespace algorithm {
+        namespace detail {
+            template <typename T>
+            constexpr bool streamable() {
+                return has_streaming() && std::is_trivially_copyable<T>::value && 32u % sizeof(T) == 0u;
+            }
+            template <typename T>
+            bool use_streaming(T const* to, std::size_t size, streaming_config const& config) {
+                return streamable<T>() && config.threshold <= size * sizeof(T) && to;
+            }
+            // the streaming stores write whole cache lines
+            template <typename T>
+            bool aligned(T const* to) {
+                return reinterpret_cast<std::uintptr_t>(to) % 64u == 0u;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+T*
+cpu::algorithm::stream_copy(T const* first, T const* last, T* to,
+                            streaming_config const& config) {
+#if defined(__AVX__)
+    if (detail::use_streaming(to, last - first, config)) {
+        for (; first != last && !detail::aligned(to); ++first, ++to) {
+            *to = *first;
+        }
+        char const*       src(reinterpret_cast<char const*>(first));
+        char*             dst(reinterpret_cast<char*>(to));
+        std::size_t const bytes((last - first) * sizeof(T) / 64u * 64u);
+        for (std::size_t i(0u); i != bytes; i += 64u) {
+            if (config.prefetch) {
+                _mm_prefetch(src + i + config.prefetch, _MM_HINT_NTA);
+            }
+            __m256i const lo(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)));
+            __m256i const hi(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i + 32u)));
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), lo);
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32u), hi);
+        }
+        _mm_sfence();
+        first += bytes / sizeof(T);
+        to    += bytes / sizeof(T);
+    }
+#endif
+    return std::copy(first, last, to);
+}
+
+template <typename T>
+T*
+cpu::algorithm::stream_copy(T const* first, T const* last, T* to) {
+    return cpu::algorithm::stream_copy(first, last, to, streaming_config());
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+void
+cpu::algorithm::stream_fill(T* first, T* last, T const& value,
+                            streaming_config const& config) {
+#if defined(__AVX__)
+    if (detail::use_streaming(first, last - first, config)) {
+        for (; first != last && !detail::aligned(first); ++first) {
+            *first = value;
+        }
+        alignas(32) T pattern[32u / sizeof(T)];
+        std::fill(std::begin(pattern), std::end(pattern), value);
+        __m256i const     line(_mm256_load_si256(reinterpret_cast<__m256i const*>(pattern)));
+        char*             dst(reinterpret_cast<char*>(first));
+        std::size_t const bytes((last - first) * sizeof(T) / 64u * 64u);
+        for (std::size_t i(0u); i != bytes; i += 64u) {
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), line);
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32u), line);
+        }
+        _mm_sfence();
+        first += bytes / sizeof(T);
+    }
+#endif
+    std::fill(first, last, value);
+}
+
+template <typename T>
+void
+cpu::algorithm::stream_fill(T* first, T* last, T const& value) {
+    cpu::algorithm::stream_fill(first, last, value, streaming_config());
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename S, typename T, typename Fun>
+T*
+cpu::algorithm::stream_transform(S const* first, S const* last, T* to, Fun fun,
+                                 streaming_config const& config) {
+#if defined(__AVX__)
+    if (detail::use_streaming(to, last - first, config)) {
+        for (; first != last && !detail::aligned(to); ++first, ++to) {
+            *to = fun(*first);
+        }
+        constexpr std::size_t per_line(64u / sizeof(T));
+        std::size_t const     lines((last - first) / per_line);
+        for (std::size_t l(0u); l != lines; ++l, first += per_line, to += per_line) {
+            if (config.prefetch) {
+                _mm_prefetch(reinterpret_cast<char const*>(first) + config.prefetch, _MM_HINT_NTA);
+            }
+            alignas(32) T line[per_line];
+            for (std::size_t i(0u); i != per_line; ++i) {
+                line[i] = fun(first[i]);
+            }
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(to),
+                                _mm256_load_si256(reinterpret_cast<__m256i const*>(line)));
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(to) + 1,
+                                _mm256_load_si256(reinterpret_cast<__m256i const*>(line) + 1));
+        }
+        _mm_sfence();
+    }
+#endif
+    return std::transform(first, last, to, fun);
+}
+
+template <typename S, typename T, typename Fun>
+T*
+cpu::algorithm::stream_transform(S const* first, S const* last, T* to, Fun fun) {
+    return cpu::algorithm::stream_transform(first, last, to, fun, streaming_config());
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,188 @@
+// cpu/algorithm/streaming.t.cpp                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "streaming.hpp"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace CA = cpu::algorithm;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    // streaming is used regardless of the size with the threshold 0
+    CA::streaming_config const configs[] = {
+        { 0u, 0u }, { 0u, 256u }, { 0u, 2048u }, { std::size_t(1u) << 30, 0u }
+    };
+
+    template <typename T>
+    bool test_copy() {
+        std::vector<T> from(1000);
+        for (std::size_t i(0u); i != from.size(); ++i) {
+            from[i] = T(i % 100u + 1u); // T() marks unwritten elements
+        }
+        for (auto const& config: configs) {
+            for (std::size_t offset(0u); offset != 8u; ++offset) {
+                for (std::size_t size: { 0u, 1u, 17u, 64u, 500u, 990u }) {
+                    std::vector<T> to(1000, T());
+                    T* end(CA::stream_copy(from.data() + 1u, from.data() + 1u + size,
+                                           to.data() + offset, config));
+                    if (end != to.data() + offset + size
+                        || !std::equal(from.data() + 1u, from.data() + 1u + size, to.data() + offset)
+                        || std::count(to.begin(), to.end(), T()) != std::ptrdiff_t(1000u - size)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool test_fill() {
+        for (auto const& config: configs) {
+            for (std::size_t offset(0u); offset != 8u; ++offset) {
+                for (std::size_t size: { 0u, 1u, 17u, 64u, 500u, 990u }) {
+                    std::vector<T> to(1000, T());
+                    CA::stream_fill(to.data() + offset, to.data() + offset + size, T(42), config);
+                    if (std::count(to.begin(), to.end(), T(42)) != std::ptrdiff_t(size)
+                        || std::count(to.begin() + offset, to.begin() + offset + size, T(42))
+                           != std::ptrdiff_t(size)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "threshold", []{
+            return 0u < CA::default_streaming_threshold()
+                && CA::streaming_config().threshold == CA::default_streaming_threshold()
+                && CA::streaming_config().prefetch == 0u;
+        }
+    },
+    { "copy char", []{ return test_copy<char>(); } },
+    { "copy int", []{ return test_copy<int>(); } },
+    { "copy double", []{ return test_copy<double>(); } },
+    { "copy 3 byte struct", []{
+            struct rgb { unsigned char r, g, b; };
+            std::vector<rgb> from(300, rgb{1, 2, 3}), to(300, rgb{});
+            CA::stream_copy(from.data(), from.data() + from.size(), to.data(), configs[0]);
+            return std::all_of(to.begin(), to.end(), [](rgb c){
+                    return c.r == 1 && c.g == 2 && c.b == 3;
+                });
+        }
+    },
+    { "fill char", []{ return test_fill<char>(); } },
+    { "fill int", []{ return test_fill<int>(); } },
+    { "fill double", []{ return test_fill<double>(); } },
+    { "transform", []{
+            std::vector<int> from(1000);
+            std::iota(from.begin(), from.end(), 0);
+            auto fun = [](int value){ return std::int64_t(value) * 3 + 1; };
+            for (auto const& config: configs) {
+                for (std::size_t offset(0u); offset != 8u; ++offset) {
+                    for (std::size_t size: { 0u, 1u, 17u, 64u, 500u, 990u }) {
+                        std::vector<std::int64_t> to(1000, -1);
+                        std::int64_t* end(CA::stream_transform(from.data() + 3u,
+                                                               from.data() + 3u + size,
+                                                               to.data() + offset, fun, config));
+                        for (std::size_t i(0u); i != to.size(); ++i) {
+                            bool inside(offset <= i && i < offset + size);
+                            if (to[i] != (inside? fun(int(i - offset + 3u)): -1)) {
+                                return false;
+                            }
+                        }
+                        if (end != to.data() + offset + size) {
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+    },
+    { "destination in the middle of a cache line", []{
+            // the streaming stores only start at the next cache line
+            alignas(64) static char buffer[4096 + 64];
+            alignas(64) static char source[4096];
+            std::iota(std::begin(source), std::end(source), char(1));
+            char* to(buffer + 32);
+            bool success(!CA::detail::aligned(to) && CA::detail::aligned(to + 32));
+            std::fill(std::begin(buffer), std::end(buffer), char(0));
+            char* end(CA::stream_copy(std::begin(source), std::end(source), to, configs[0]));
+            success = success && end == to + 4096
+                && std::equal(std::begin(source), std::end(source), to)
+                && std::count(buffer, to, char(0)) == 32 && std::count(end, std::end(buffer), char(0)) == 32;
+            CA::stream_fill(to, to + 4000, char(7), configs[0]);
+            success = success && std::count(to, to + 4000, char(7)) == 4000 && to[4000] == source[4000];
+            int* ints(reinterpret_cast<int*>(to));
+            CA::stream_transform(ints, ints + 1000, ints, [](int v){ return -v; }, configs[0]);
+            return success && ints[0] == -0x07070707 && ints[999] == -0x07070707;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
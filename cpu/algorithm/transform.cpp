@@ -4,6 +4,7 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/algorithm/streaming.hpp"
 
 #include <algorithm>
 #include <numeric>
@@ -15,6 +16,8 @@
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <sstream>
+#include <string>
 #include <stdlib.h>
 
 #include <hpx/hpx_init.hpp>
@@ -66,6 +69,29 @@ namespace
             return to + (end - begin);
         }
     };
+    // The streaming transform either uses the default threshold or always
+    // uses non-temporal stores with different prefetch distances.
+    struct stream_transform
+    {
+        cpu::algorithm::streaming_config config;
+        std::string name() const {
+            std::ostringstream out;
+            out << "algorithm::stream_transform(";
+            if (this->config.threshold) {
+                out << "threshold=" << this->config.threshold;
+            }
+            else {
+                out << "prefetch=" << this->config.prefetch;
+            }
+            return out.str() + ")";
+        }
+        template <typename InIt, typename OutIt, typename Fun>
+        OutIt operator()(InIt begin, InIt end, OutIt to, Fun fun) const {
+            return to + (cpu::algorithm::stream_transform(&*begin, &*begin + (end - begin), &*to,
+                                                          fun, this->config)
+                         - &*to);
+        }
+    };
     struct hpx_transform
     {
         static char const* name() { return "hpx::parallel::transform()"; }
@@ -94,7 +120,9 @@ namespace
 
         std::ostringstream out;
         out << competitor.name() << " [" << from.size() << "]";
-        context.report(out.str(), time, "<none>");
+        // each element is read and its result written
+        context.report(out.str(), time, "<none>",
+                       cpu::tube::work::of<int>(from.size(), 2u));
     }
 
     template <typename Fun>
@@ -110,6 +138,10 @@ namespace
         measure(context, from, to, fun, pstl_transform_seq());
         measure(context, from, to, fun, pstl_transform_par());
         measure(context, from, to, fun, tbb_transform());
+        measure(context, from, to, fun, stream_transform{});
+        for (std::size_t prefetch: { 0u, 256u, 512u, 1024u, 2048u }) {
+            measure(context, from, to, fun, stream_transform{{ 0u, prefetch }});
+        }
         measure(context, from, to, fun, hpx__transform());
     }
 }
@@ -0,0 +1,299 @@
+// data-structures/concurrent_hash_set.hpp                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_CONCURRENT_HASH_SET
+#define INCLUDED_DATA_STRUCTURES_CONCURRENT_HASH_SET
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// A hash set which can be used concurrently from multiple threads. It uses
+// the same layout as hash_set, i.e., an array of flags holding the lower hash
+// bits and a parallel array of values, with these differences:
+// - The flags are atomic and a slot is claimed using a CAS from "empty" to
+//   "busy". The value is constructed and then the hash bits are published.
+// - find() never waits: a busy slot is simply skipped as the concurrent
+//   insertion isn't complete, yet.
+// - When the load factor is exceeded a table of twice the size is attached
+//   to the current one. Inserting threads then claim chunks of the old table
+//   and copy them over until the migration is complete. The old tables are
+//   kept until the set is destroyed as concurrent readers may still use them.
+// Elements can't be erased.
+
+namespace cpu {
+    namespace data_structures {
+        template <typename Key,
+                  typename Hash = std::hash<Key>,
+                  typename Equal = std::equal_to<Key>>
+        class concurrent_hash_set;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Key, typename Hash, typename Equal>
+class cpu::data_structures::concurrent_hash_set {
+private:
+    using flag = unsigned char; // high bit: not in use; other bits: lower hash bits
+    static constexpr flag empty_flag{0x80};
+    static constexpr flag busy_flag{0x81};  // claimed, value under construction
+    static constexpr flag moved_flag{0x82}; // empty slot frozen during migration
+    static bool p_is_used(flag f) { return !(f & flag{0x80}); }
+
+    static constexpr std::size_t chunk_size{1024u};
+
+    union element {
+        Key value;
+        element() {}
+        ~element() {}
+    };
+
+    enum class status { absent, present, inserted, moved, full };
+
+    struct table {
+        std::size_t                          d_mask;
+        std::unique_ptr<std::atomic<flag>[]> d_flags{new std::atomic<flag>[this->d_mask + 1u]};
+        std::unique_ptr<element[]>           d_values{new element[this->d_mask + 1u]};
+        std::atomic<std::size_t>             d_count{};    // claimed slots
+        std::atomic<table*>                  d_next{};     // migration target
+        std::atomic<bool>                    d_growing{};  // d_next being allocated
+        std::atomic<std::size_t>             d_cursor{};   // next slot to migrate
+        std::atomic<std::size_t>             d_migrated{}; // migrated slots
+
+        explicit table(std::size_t capacity): d_mask(capacity - 1u) {
+            for (std::size_t i{}; i != capacity; ++i) {
+                this->d_flags[i].store(empty_flag, std::memory_order_relaxed);
+            }
+        }
+        ~table() {
+            for (std::size_t i{}; i != this->d_mask + 1u; ++i) {
+                if (p_is_used(this->d_flags[i].load(std::memory_order_relaxed))) {
+                    this->d_values[i].value.~Key();
+                }
+            }
+        }
+        std::size_t capacity() const { return this->d_mask + 1u; }
+        std::size_t threshold() const { return this->d_mask - (this->d_mask >> 3); }
+    };
+
+    std::atomic<table*> d_current;
+    table*              d_first;
+    std::atomic<std::ptrdiff_t> d_size{};
+    Hash                d_hash;
+    Equal               d_equal;
+
+    // Probe the table and report whether the key is present. A moved slot
+    // means that the key has to be looked for in the next table.
+    status p_find(table const* t, std::size_t hash, Key const& key) const {
+        flag const x(hash & 0x7f);
+        for (std::size_t index{(hash >> 7) & t->d_mask}, n{}; n != t->capacity();
+             ++n, index = (index + 1u) & t->d_mask) {
+            flag f{t->d_flags[index].load(std::memory_order_acquire)};
+            if (f == empty_flag) {
+                return status::absent;
+            }
+            if (f == moved_flag) {
+                return status::moved;
+            }
+            if (f == x && this->d_equal(key, t->d_values[index].value)) {
+                return status::present;
+            }
+        }
+        return status::moved;
+    }
+
+    template <typename K>
+    status p_insert(table* t, std::size_t hash, K&& key, bool migrating) {
+        flag const x(hash & 0x7f);
+        for (std::size_t index{(hash >> 7) & t->d_mask}, n{}; n != t->capacity();
+             ++n, index = (index + 1u) & t->d_mask) {
+            std::atomic<flag>& slot{t->d_flags[index]};
+            flag f{slot.load(std::memory_order_acquire)};
+            while (f == busy_flag) {
+                std::this_thread::yield();
+                f = slot.load(std::memory_order_acquire);
+            }
+            if (f == moved_flag) {
+                return status::moved;
+            }
+            if (f == empty_flag) {
+                std::size_t count{t->d_count.fetch_add(1u, std::memory_order_relaxed)};
+                if (!migrating && t->threshold() <= count) {
+                    t->d_count.fetch_sub(1u, std::memory_order_relaxed);
+                    return status::full;
+                }
+                if (slot.compare_exchange_strong(f, busy_flag, std::memory_order_acq_rel)) {
+                    new(&t->d_values[index].value) Key(std::forward<K>(key));
+                    slot.store(x, std::memory_order_release);
+                    return status::inserted;
+                }
+                t->d_count.fetch_sub(1u, std::memory_order_relaxed);
+                // the slot was claimed by someone else: look at it again
+                n -= 1u;
+                index = (index - 1u) & t->d_mask;
+                continue;
+            }
+            if (f == x && this->d_equal(key, t->d_values[index].value)) {
+                return status::present;
+            }
+        }
+        return status::full;
+    }
+
+    void p_migrate(table* from, table* to, std::size_t index) {
+        std::atomic<flag>& slot{from->d_flags[index]};
+        flag f{slot.load(std::memory_order_acquire)};
+        while (f == busy_flag
+               || (f == empty_flag
+                   && !slot.compare_exchange_weak(f, moved_flag, std::memory_order_acq_rel))) {
+            if (f == busy_flag) {
+                std::this_thread::yield();
+                f = slot.load(std::memory_order_acquire);
+            }
+        }
+        if (p_is_used(f)) {
+            // the value is copied as concurrent readers may still look at it
+            Key const& value{from->d_values[index].value};
+            this->p_insert(to, this->d_hash(value) >> 3, value, true);
+        }
+    }
+
+    // Help migrating the chunks of "from" and wait until all are done.
+    void p_help(table* from, table* to) {
+        for (std::size_t begin; from->capacity() > (begin = from->d_cursor.fetch_add(chunk_size)); ) {
+            std::size_t end{std::min(begin + chunk_size, from->capacity())};
+            for (std::size_t index{begin}; index != end; ++index) {
+                this->p_migrate(from, to, index);
+            }
+            from->d_migrated.fetch_add(end - begin, std::memory_order_acq_rel);
+        }
+        while (from->d_migrated.load(std::memory_order_acquire) != from->capacity()) {
+            std::this_thread::yield();
+        }
+        this->d_current.compare_exchange_strong(from, to);
+    }
+
+    // Only the thread winning the race on d_growing allocates the next
+    // table; the others wait until it is attached. If the allocation fails
+    // the flag is reset so the growth can be attempted again.
+    void p_grow(table* t) {
+        if (!t->d_growing.exchange(true, std::memory_order_acq_rel)) {
+            try {
+                t->d_next.store(new table(2u * t->capacity()), std::memory_order_release);
+            }
+            catch (...) {
+                t->d_growing.store(false, std::memory_order_release);
+                throw;
+            }
+            return;
+        }
+        while (!t->d_next.load(std::memory_order_acquire)
+               && t->d_growing.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    using size_type = std::size_t;
+
+    concurrent_hash_set(): concurrent_hash_set{16u} {}
+    explicit concurrent_hash_set(std::size_t capacity, // must be a power of 2
+                                 const Hash& hash = Hash{},
+                                 const Equal& equal = Equal{})
+        : d_current{new table(std::max(capacity, chunk_size))}
+        , d_first{this->d_current.load()}
+        , d_hash{hash}
+        , d_equal{equal} {
+    }
+    concurrent_hash_set(concurrent_hash_set const&) = delete;
+    void operator=(concurrent_hash_set const&) = delete;
+    ~concurrent_hash_set() {
+        for (table* t{this->d_first}; t; ) {
+            table* next{t->d_next.load()};
+            delete t;
+            t = next;
+        }
+    }
+
+    bool      empty() const { return 0 == this->d_size.load(); }
+    size_type size() const { return this->d_size.load(); }
+
+    bool contains(Key const& key) const {
+        auto hash{this->d_hash(key) >> 3};
+        for (table* t{this->d_current.load(std::memory_order_acquire)}; t;
+             t = t->d_next.load(std::memory_order_acquire)) {
+            switch (this->p_find(t, hash, key)) {
+            case status::present:
+                return true;
+            case status::absent:
+                if (!t->d_next.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Returns true if the key was inserted and false if it was present.
+    template <typename... T>
+    bool emplace(T&&... a) {
+        Key  key(std::forward<T>(a)...);
+        auto hash{this->d_hash(key) >> 3};
+        for (table* t{this->d_current.load(std::memory_order_acquire)}; ; ) {
+            if (table* next = t->d_next.load(std::memory_order_acquire)) {
+                this->p_help(t, next);
+                t = next;
+                continue;
+            }
+            switch (this->p_insert(t, hash, std::move(key), false)) {
+            case status::inserted:
+                ++this->d_size;
+                return true;
+            case status::present:
+                return false;
+            case status::absent:
+            case status::full:
+                this->p_grow(t);
+                break;
+            case status::moved:
+                break;
+            }
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
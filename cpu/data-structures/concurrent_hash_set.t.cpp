@@ -0,0 +1,137 @@
+// data-structures/concurrent_hash_set.t.cpp                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "concurrent_hash_set.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "initial state", []{
+            DS::concurrent_hash_set<std::string> container;
+            return container.empty()
+                && 0u == container.size()
+                && !container.contains("foo")
+                ;
+        }
+    },
+    {
+        "emplace a single element", []{
+            DS::concurrent_hash_set<std::string> container;
+            bool rc1 = container.emplace("foo");
+            bool rc2 = container.emplace("foo");
+            return rc1
+                && !rc2
+                && 1u == container.size()
+                && container.contains("foo")
+                && !container.contains("bar")
+                ;
+        }
+    },
+    {
+        "emplace enough elements to resize", []{
+            DS::concurrent_hash_set<int> container;
+            bool success{true};
+            for (int i{0}; i != 10000; ++i) {
+                success = success && container.emplace(i);
+            }
+            for (int i{0}; i != 10000; ++i) {
+                success = success && !container.emplace(i) && container.contains(i);
+            }
+            return success
+                && 10000u == container.size()
+                && !container.contains(10000)
+                ;
+        }
+    },
+    {
+        "concurrent emplace of overlapping keys", []{
+            DS::concurrent_hash_set<std::string> container;
+            std::atomic<int>         inserted{0};
+            std::vector<std::thread> threads;
+            for (int t{0}; t != 4; ++t) {
+                threads.emplace_back([&, t]{
+                        for (int i{0}; i != 20000; ++i) {
+                            if (container.emplace("key" + std::to_string((t * 10000 + i) % 30000))) {
+                                ++inserted;
+                            }
+                        }
+                    });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            bool success{true};
+            for (int i{0}; i != 30000; ++i) {
+                success = success && container.contains("key" + std::to_string(i));
+            }
+            return success
+                && 30000 == inserted
+                && 30000u == container.size()
+                ;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,123 @@
+// data-structures/eytzinger_set.hpp                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_EYTZINGER_SET
+#define INCLUDED_DATA_STRUCTURES_EYTZINGER_SET
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// A static set storing the sorted keys in breadth-first order of an implicit
+// binary search tree: the children of node k are 2k and 2k + 1 (index 0 is
+// unused). The search only computes the next index, i.e., it doesn't branch
+// on the comparison, and prefetches the cache line holding the descendants
+// a few levels down.
+
+namespace cpu {
+    namespace data_structures {
+        template <typename Key, typename Compare = std::less<Key>>
+        class eytzinger_set;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Key, typename Compare>
+class cpu::data_structures::eytzinger_set {
+private:
+    // number of keys per cache line: the descendants of k on the level
+    // log2(stride) further down are consecutive starting at k * stride
+    static constexpr std::size_t stride{sizeof(Key) < 64u? 64u / sizeof(Key): 1u};
+
+    std::vector<Key> d_values; // d_values[0] is unused
+    Compare          d_compare;
+
+    template <typename It>
+    void p_build(It& it, std::size_t k) {
+        if (k < this->d_values.size()) {
+            this->p_build(it, 2u * k);
+            this->d_values[k] = *it++;
+            this->p_build(it, 2u * k + 1u);
+        }
+    }
+
+    // Returns the index of the first key not less than key or 0 if there
+    // is no such key.
+    std::size_t p_lower_bound(Key const& key) const {
+        Key const*        values{this->d_values.data()};
+        std::size_t const size{this->d_values.size()};
+        std::size_t       k{1u};
+        while (k < size) {
+            __builtin_prefetch(reinterpret_cast<void const*>(
+                reinterpret_cast<std::uintptr_t>(values) + k * stride * sizeof(Key)));
+            k = 2u * k + this->d_compare(values[k], key);
+        }
+        // the path went right after the sought node: drop trailing ones and
+        // the left turn following the node
+        k >>= __builtin_ffsll(~static_cast<long long>(k));
+        return k;
+    }
+
+public:
+    using value_type = Key;
+    using size_type  = std::size_t;
+
+    eytzinger_set(): d_values(1u) {}
+    template <typename InIt>
+    eytzinger_set(InIt it, InIt end, Compare const& compare = Compare())
+        : d_compare(compare) {
+        std::vector<Key> sorted(it, end);
+        std::sort(sorted.begin(), sorted.end(), this->d_compare);
+        sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                                 [this](Key const& k0, Key const& k1){
+                                     return !this->d_compare(k0, k1) && !this->d_compare(k1, k0);
+                                 }),
+                     sorted.end());
+        this->d_values.resize(sorted.size() + 1u);
+        auto sit{sorted.cbegin()};
+        this->p_build(sit, 1u);
+    }
+
+    bool      empty() const { return this->d_values.size() == 1u; }
+    size_type size() const { return this->d_values.size() - 1u; }
+
+    // Returns a pointer to the first key not less than key or nullptr.
+    Key const* lower_bound(Key const& key) const {
+        std::size_t k{this->p_lower_bound(key)};
+        return k? &this->d_values[k]: nullptr;
+    }
+    bool contains(Key const& key) const {
+        std::size_t k{this->p_lower_bound(key)};
+        return k && !this->d_compare(key, this->d_values[k]);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,130 @@
+// data-structures/flat_map.hpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_FLAT_MAP
+#define INCLUDED_DATA_STRUCTURES_FLAT_MAP
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// A map represented as a std::vector of key/value pairs sorted by key. Like
+// flat_set, ranges are inserted by appending, sorting, and merging. When a
+// key occurs multiple times the first occurrence is retained.
+
+namespace cpu {
+    namespace data_structures {
+        template <typename Key, typename Value, typename Compare = std::less<Key>>
+        class flat_map;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Key, typename Value, typename Compare>
+class cpu::data_structures::flat_map {
+public:
+    using key_type       = Key;
+    using mapped_type    = Value;
+    using value_type     = std::pair<Key, Value>;
+    using size_type      = std::size_t;
+    using iterator       = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    std::vector<value_type> d_values;
+    Compare                 d_compare;
+
+    bool p_less(value_type const& v0, value_type const& v1) const {
+        return this->d_compare(v0.first, v1.first);
+    }
+    template <typename It>
+    It p_lower_bound(It begin, It end, Key const& key) const {
+        return std::lower_bound(begin, end, key,
+                                [this](value_type const& v, Key const& k){
+                                    return this->d_compare(v.first, k);
+                                });
+    }
+
+public:
+    flat_map() = default;
+    explicit flat_map(Compare const& compare): d_compare(compare) {}
+    template <typename InIt>
+    flat_map(InIt it, InIt end, Compare const& compare = Compare())
+        : d_compare(compare) {
+        this->insert(it, end);
+    }
+
+    bool           empty() const { return this->d_values.empty(); }
+    size_type      size() const { return this->d_values.size(); }
+    iterator       begin() { return this->d_values.begin(); }
+    iterator       end() { return this->d_values.end(); }
+    const_iterator begin() const { return this->d_values.begin(); }
+    const_iterator end() const { return this->d_values.end(); }
+    void           reserve(size_type size) { this->d_values.reserve(size); }
+
+    template <typename InIt>
+    void insert(InIt it, InIt end) {
+        auto less{[this](value_type const& v0, value_type const& v1){
+                return this->p_less(v0, v1);
+            }};
+        auto size{this->d_values.size()};
+        this->d_values.insert(this->d_values.end(), it, end);
+        auto mid{this->d_values.begin() + size};
+        std::stable_sort(mid, this->d_values.end(), less);
+        std::inplace_merge(this->d_values.begin(), mid, this->d_values.end(), less);
+        this->d_values.erase(std::unique(this->d_values.begin(), this->d_values.end(),
+                                         [less](value_type const& v0, value_type const& v1){
+                                             return !less(v0, v1) && !less(v1, v0);
+                                         }),
+                             this->d_values.end());
+    }
+    Value& operator[](Key const& key) {
+        auto it{this->p_lower_bound(this->begin(), this->end(), key)};
+        if (it == this->end() || this->d_compare(key, it->first)) {
+            it = this->d_values.insert(it, value_type(key, Value()));
+        }
+        return it->second;
+    }
+
+    iterator find(Key const& key) {
+        auto it{this->p_lower_bound(this->begin(), this->end(), key)};
+        return it == this->end() || this->d_compare(key, it->first)? this->end(): it;
+    }
+    const_iterator find(Key const& key) const {
+        auto it{this->p_lower_bound(this->begin(), this->end(), key)};
+        return it == this->end() || this->d_compare(key, it->first)? this->end(): it;
+    }
+    bool contains(Key const& key) const {
+        return this->find(key) != this->end();
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
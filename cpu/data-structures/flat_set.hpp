@@ -0,0 +1,117 @@
+// data-structures/flat_set.hpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_FLAT_SET
+#define INCLUDED_DATA_STRUCTURES_FLAT_SET
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// A set represented as a sorted std::vector. Inserting a range appends the
+// elements, sorts the new tail, and merges it with the existing elements,
+// i.e., bulk insertion costs O(m log m + n) instead of O(m n).
+
+namespace cpu {
+    namespace data_structures {
+        template <typename Key, typename Compare = std::less<Key>>
+        class flat_set;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Key, typename Compare>
+class cpu::data_structures::flat_set {
+private:
+    std::vector<Key> d_values;
+    Compare          d_compare;
+
+    bool p_equal(Key const& k0, Key const& k1) const {
+        return !this->d_compare(k0, k1) && !this->d_compare(k1, k0);
+    }
+
+public:
+    using value_type     = Key;
+    using size_type      = std::size_t;
+    using iterator       = typename std::vector<Key>::const_iterator;
+    using const_iterator = iterator;
+
+    flat_set() = default;
+    explicit flat_set(Compare const& compare): d_compare(compare) {}
+    template <typename InIt>
+    flat_set(InIt it, InIt end, Compare const& compare = Compare())
+        : d_compare(compare) {
+        this->insert(it, end);
+    }
+
+    bool           empty() const { return this->d_values.empty(); }
+    size_type      size() const { return this->d_values.size(); }
+    const_iterator begin() const { return this->d_values.begin(); }
+    const_iterator end() const { return this->d_values.end(); }
+    void           reserve(size_type size) { this->d_values.reserve(size); }
+
+    template <typename InIt>
+    void insert(InIt it, InIt end) {
+        auto size{this->d_values.size()};
+        this->d_values.insert(this->d_values.end(), it, end);
+        auto mid{this->d_values.begin() + size};
+        std::sort(mid, this->d_values.end(), this->d_compare);
+        std::inplace_merge(this->d_values.begin(), mid, this->d_values.end(),
+                           this->d_compare);
+        this->d_values.erase(std::unique(this->d_values.begin(), this->d_values.end(),
+                                         [this](Key const& k0, Key const& k1){
+                                             return this->p_equal(k0, k1);
+                                         }),
+                             this->d_values.end());
+    }
+    template <typename... T>
+    std::pair<iterator, bool> emplace(T&&... a) {
+        Key  key(std::forward<T>(a)...);
+        auto it{this->lower_bound(key)};
+        if (it != this->end() && !this->d_compare(key, *it)) {
+            return std::make_pair(it, false);
+        }
+        return std::make_pair(this->d_values.insert(it, std::move(key)), true);
+    }
+
+    const_iterator lower_bound(Key const& key) const {
+        return std::lower_bound(this->begin(), this->end(), key, this->d_compare);
+    }
+    const_iterator find(Key const& key) const {
+        auto it{this->lower_bound(key)};
+        return it == this->end() || this->d_compare(key, *it)? this->end(): it;
+    }
+    bool contains(Key const& key) const {
+        return this->find(key) != this->end();
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,184 @@
+// data-structures/flat_set.t.cpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "flat_set.hpp"
+#include "flat_map.hpp"
+#include "eytzinger_set.hpp"
+#include "static_btree_set.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    // Check contains() for all values in [-1, 3 * size] against a brute
+    // force search of a random set of values from [0, 3 * size).
+    template <typename Set>
+    bool agrees_with_find(int size) {
+        std::minstd_rand rand;
+        rand.seed(17);
+        std::vector<int> values;
+        for (int i{0}; i != size; ++i) {
+            values.push_back(rand() % (3 * size));
+        }
+        Set container(values.begin(), values.end());
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        bool success{container.size() == values.size()};
+        for (int i{-1}; success && i <= 3 * size; ++i) {
+            success = container.contains(i)
+                == std::binary_search(values.begin(), values.end(), i);
+        }
+        return success;
+    }
+
+    template <typename Set>
+    bool agrees_with_find() {
+        for (int size: { 0, 1, 2, 15, 16, 17, 100, 272, 1000, 4913 }) {
+            if (!agrees_with_find<Set>(size)) {
+                std::cout << "size=" << size << " ";
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "flat_set initial state", []{
+            DS::flat_set<std::string> container;
+            return container.empty()
+                && 0u == container.size()
+                && container.begin() == container.end()
+                && container.find("foo") == container.end()
+                ;
+        }
+    },
+    { "flat_set bulk insert sorts and removes duplicates", []{
+            std::string keys[] = { "pqr", "abc", "mno", "abc", "def" };
+            std::string more[] = { "ghi", "def", "jkl" };
+            DS::flat_set<std::string> container(std::begin(keys), std::end(keys));
+            container.insert(std::begin(more), std::end(more));
+            std::vector<std::string> expect{ "abc", "def", "ghi", "jkl", "mno", "pqr" };
+            return std::equal(container.begin(), container.end(), expect.begin(), expect.end())
+                && container.contains("jkl")
+                && !container.contains("xyz")
+                ;
+        }
+    },
+    { "flat_set emplace", []{
+            DS::flat_set<std::string> container;
+            auto rc1 = container.emplace("foo");
+            auto rc2 = container.emplace("bar");
+            auto rc3 = container.emplace("foo");
+            return rc1.second
+                && rc2.second
+                && !rc3.second
+                && 2u == container.size()
+                && "bar" == *container.begin()
+                && container.find("foo") == rc3.first
+                ;
+        }
+    },
+    { "flat_set agrees with find", []{ return agrees_with_find<DS::flat_set<int>>(); } },
+    { "flat_map bulk insert retains the first value", []{
+            std::pair<std::string, int> values[] = { { "b", 1 }, { "a", 2 }, { "b", 3 } };
+            DS::flat_map<std::string, int> container(std::begin(values), std::end(values));
+            container["c"] = 4;
+            return 3u == container.size()
+                && container.find("a")->second == 2
+                && container.find("b")->second == 1
+                && container["c"] == 4
+                && container.find("d") == container.end()
+                ;
+        }
+    },
+    { "eytzinger_set agrees with find", []{ return agrees_with_find<DS::eytzinger_set<int>>(); } },
+    { "eytzinger_set lower_bound", []{
+            std::string keys[] = { "b", "d", "f" };
+            DS::eytzinger_set<std::string> container(std::begin(keys), std::end(keys));
+            return *container.lower_bound("a") == "b"
+                && *container.lower_bound("d") == "d"
+                && *container.lower_bound("e") == "f"
+                && container.lower_bound("g") == nullptr
+                ;
+        }
+    },
+    { "static_btree_set agrees with find", []{ return agrees_with_find<DS::static_btree_set<int>>(); } },
+    { "static_btree_set with strings", []{
+            std::vector<std::string> keys;
+            for (int i{0}; i != 1000; i += 2) {
+                keys.push_back(std::to_string(10000 + i));
+            }
+            DS::static_btree_set<std::string> container(keys.begin(), keys.end());
+            bool success{container.size() == keys.size()};
+            for (int i{0}; success && i != 1000; ++i) {
+                success = container.contains(std::to_string(10000 + i)) == (i % 2 == 0);
+            }
+            return success;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,329 @@
+// data-structures/hash.hpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_HASH
+#define INCLUDED_DATA_STRUCTURES_HASH
+
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Hash functions for contiguous character sequences. Each hash is a function
+// object which can be used with any type providing data() and size(), e.g.,
+// std::string or std::string_view, and a static function bytes() hashing a
+// range of bytes:
+//
+// - fnv1a_hash: the classic byte-at-a-time FNV-1a.
+// - wy_hash: reads 8 bytes at a time and mixes using the two halves of a
+//   64x64->128 bit multiplication (in the style of wyhash).
+// - xxh3_hash: strings longer than 128 bytes are processed in 64 byte
+//   stripes with eight independent accumulators (in the style of XXH3) which
+//   are kept in AVX2 registers when available; shorter strings use wy_hash.
+// - aes_hash: uses the AES round instructions to mix 16 bytes at a time. The
+//   availability of AES-NI is determined at run-time and wy_hash is used if
+//   it isn't available.
+//
+// The values are not compatible with the respective reference
+// implementations.
+
+namespace cpu {
+    namespace data_structures {
+        struct fnv1a_hash;
+        struct wy_hash;
+        struct xxh3_hash;
+        struct aes_hash;
+
+        namespace hash_detail {
+            template <typename Hash>
+            struct sequence_hash;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace cpu {
+    namespace data_structures {
+        namespace hash_detail {
+            constexpr std::uint64_t secret[] = {
+                0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+                0x1d8e4e27c47d124full, 0x9e3779b185ebca87ull,
+                0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull
+            };
+            constexpr std::uint64_t prime32{0x9e3779b1u};
+
+            inline std::uint64_t read64(unsigned char const* p) {
+                std::uint64_t rc;
+                std::memcpy(&rc, p, sizeof(rc));
+                return rc;
+            }
+            inline std::uint64_t read32(unsigned char const* p) {
+                std::uint32_t rc;
+                std::memcpy(&rc, p, sizeof(rc));
+                return rc;
+            }
+            // multiply and fold the 128 bit product
+            inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) {
+                unsigned __int128 r{static_cast<unsigned __int128>(a) * b};
+                return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+            }
+            inline std::uint64_t avalanche(std::uint64_t h) {
+                h ^= h >> 37;
+                h *= 0x165667919e3779f9ull;
+                return h ^ (h >> 32);
+            }
+
+            template <typename Hash>
+            struct sequence_hash {
+                template <typename Sequence>
+                std::size_t operator()(Sequence const& s) const {
+                    return Hash::bytes(s.data(), s.size());
+                }
+            };
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::data_structures::fnv1a_hash
+    : cpu::data_structures::hash_detail::sequence_hash<fnv1a_hash> {
+    static constexpr std::uint64_t basis{0xcbf29ce484222325ull};
+    static constexpr std::uint64_t prime{1099511628211ull};
+
+    static std::uint64_t bytes(void const* data, std::size_t size) {
+        unsigned char const* it{static_cast<unsigned char const*>(data)};
+        std::uint64_t result{basis};
+        for (unsigned char const* end{it + size}; it != end; ++it) {
+            result ^= *it;
+            result *= prime;
+        }
+        return result;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+struct cpu::data_structures::wy_hash
+    : cpu::data_structures::hash_detail::sequence_hash<wy_hash> {
+    static std::uint64_t bytes(void const* data, std::size_t size) {
+        using namespace hash_detail;
+        unsigned char const* p{static_cast<unsigned char const*>(data)};
+        std::uint64_t seed{secret[0] ^ size};
+        std::uint64_t a, b;
+        if (size <= 16u) {
+            if (4u <= size) {
+                // two possibly overlapping pairs of 4 bytes cover the string
+                std::size_t const off{(size >> 3) << 2};
+                a = (read32(p) << 32) | read32(p + off);
+                b = (read32(p + size - 4u) << 32) | read32(p + size - 4u - off);
+            }
+            else if (0u < size) {
+                a = (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[size >> 1]) << 8) | p[size - 1u];
+                b = 0u;
+            }
+            else {
+                a = b = 0u;
+            }
+        }
+        else {
+            std::size_t i{size};
+            if (48u < i) {
+                // three independent multiplication chains
+                std::uint64_t see1{seed}, see2{seed};
+                do {
+                    seed = mum(read64(p)      ^ secret[1], read64(p + 8u)  ^ seed);
+                    see1 = mum(read64(p + 16u) ^ secret[2], read64(p + 24u) ^ see1);
+                    see2 = mum(read64(p + 32u) ^ secret[3], read64(p + 40u) ^ see2);
+                    p += 48u;
+                    i -= 48u;
+                } while (48u < i);
+                seed ^= see1 ^ see2;
+            }
+            for (; 16u < i; i -= 16u, p += 16u) {
+                seed = mum(read64(p) ^ secret[1], read64(p + 8u) ^ seed);
+            }
+            a = read64(p + i - 16u);
+            b = read64(p + i - 8u);
+        }
+        return mum(secret[1] ^ size, mum(a ^ secret[1], b ^ seed));
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+struct cpu::data_structures::xxh3_hash
+    : cpu::data_structures::hash_detail::sequence_hash<xxh3_hash> {
+    static constexpr std::size_t stripe_size{64u};
+    static constexpr std::size_t block_stripes{16u};
+
+    // One stripe: lane i accumulates the product of the two 32 bit halves of
+    // data[i] ^ key[i] and the data of its neighbour lane i ^ 1.
+    static void accumulate_scalar(std::uint64_t* acc, unsigned char const* p) {
+        using namespace hash_detail;
+        for (std::size_t i{0}; i != 8u; ++i) {
+            std::uint64_t const dk{read64(p + 8u * i) ^ secret[i]};
+            acc[i] += read64(p + 8u * (i ^ 1u)) + (dk & 0xffffffffu) * (dk >> 32);
+        }
+    }
+    static void accumulate(std::uint64_t* acc, unsigned char const* p) {
+        using namespace hash_detail;
+#if defined(__AVX2__)
+        for (int i{0}; i != 2; ++i) {
+            __m256i* a{reinterpret_cast<__m256i*>(acc) + i};
+            __m256i const d{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p) + i)};
+            __m256i const k{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(secret) + i)};
+            __m256i const dk{_mm256_xor_si256(d, k)};
+            __m256i const hi{_mm256_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1))};
+            __m256i const swapped{_mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2))};
+            _mm256_storeu_si256(a, _mm256_add_epi64(_mm256_loadu_si256(a),
+                                   _mm256_add_epi64(_mm256_mul_epu32(dk, hi), swapped)));
+        }
+#else
+        accumulate_scalar(acc, p);
+#endif
+    }
+    static void scramble(std::uint64_t* acc) {
+        using namespace hash_detail;
+        for (std::size_t i{0}; i != 8u; ++i) {
+            acc[i] = ((acc[i] ^ (acc[i] >> 47)) ^ secret[7 - i]) * prime32;
+        }
+    }
+    template <void (*Accumulate)(std::uint64_t*, unsigned char const*)>
+    static std::uint64_t hash(void const* data, std::size_t size) {
+        using namespace hash_detail;
+        if (size <= 128u) {
+            return wy_hash::bytes(data, size);
+        }
+        unsigned char const* p{static_cast<unsigned char const*>(data)};
+        alignas(32) std::uint64_t acc[8] = {
+            prime32, secret[0], secret[1], secret[2],
+            secret[3], secret[4], secret[5], prime32
+        };
+        std::size_t const stripes{(size - 1u) / stripe_size};
+        for (std::size_t s{0}; s != stripes; ++s, p += stripe_size) {
+            Accumulate(acc, p);
+            if ((s + 1u) % block_stripes == 0u) {
+                scramble(acc);
+            }
+        }
+        // the last stripe overlaps the previous one unless the size is a
+        // multiple of the stripe size
+        Accumulate(acc, static_cast<unsigned char const*>(data) + size - stripe_size);
+
+        std::uint64_t result{size * 0x9e3779b185ebca87ull};
+        for (std::size_t i{0}; i != 4u; ++i) {
+            result += mum(acc[2u * i] ^ secret[2u * i], acc[2u * i + 1u] ^ secret[2u * i + 1u]);
+        }
+        return avalanche(result);
+    }
+    static std::uint64_t bytes(void const* data, std::size_t size) {
+        return hash<accumulate>(data, size);
+    }
+    // the hash without the vectorized accumulation; the values are identical
+    static std::uint64_t scalar_bytes(void const* data, std::size_t size) {
+        return hash<accumulate_scalar>(data, size);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+struct cpu::data_structures::aes_hash
+    : cpu::data_structures::hash_detail::sequence_hash<aes_hash> {
+#if defined(__x86_64__)
+    __attribute__((target("aes,sse4.1")))
+    static std::uint64_t aes_bytes(void const* data, std::size_t size) {
+        using namespace hash_detail;
+        unsigned char const* p{static_cast<unsigned char const*>(data)};
+        auto load{[](unsigned char const* q){
+                return _mm_loadu_si128(reinterpret_cast<__m128i const*>(q));
+            }};
+        __m128i const key0{_mm_set_epi64x(secret[1], secret[2])};
+        __m128i const key1{_mm_set_epi64x(secret[3], secret[4])};
+        __m128i h0{_mm_set_epi64x(size, secret[0])};
+        __m128i h1{_mm_set_epi64x(secret[5], size)};
+        if (16u < size) {
+            // two independent lanes for 32 bytes at a time; the final 16 or
+            // 32 bytes may overlap bytes already processed
+            std::size_t i{size};
+            for (; 32u < i; i -= 32u, p += 32u) {
+                h0 = _mm_aesenc_si128(_mm_xor_si128(h0, load(p)), key0);
+                h1 = _mm_aesenc_si128(_mm_xor_si128(h1, load(p + 16u)), key1);
+            }
+            unsigned char const* end{p + i};
+            h0 = _mm_aesenc_si128(_mm_xor_si128(h0, load(i <= 16u? end - 32u: p)), key0);
+            h1 = _mm_aesenc_si128(_mm_xor_si128(h1, load(end - 16u)), key1);
+        }
+        else {
+            // as for wy_hash, overlapping reads avoid copying to a buffer
+            std::uint64_t a{}, b{};
+            if (8u <= size) {
+                a = read64(p);
+                b = read64(p + size - 8u);
+            }
+            else if (4u <= size) {
+                a = read32(p);
+                b = read32(p + size - 4u);
+            }
+            else if (0u < size) {
+                a = (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[size >> 1]) << 8) | p[size - 1u];
+            }
+            h0 = _mm_aesenc_si128(_mm_xor_si128(h0, _mm_set_epi64x(b, a)), key0);
+            h1 = key1;
+        }
+        __m128i h{_mm_aesenc_si128(h0, h1)};
+        h = _mm_aesenc_si128(h, key0);
+        return std::uint64_t(_mm_cvtsi128_si64(h)) ^ std::uint64_t(_mm_extract_epi64(h, 1));
+    }
+#endif
+
+    using function = std::uint64_t(*)(void const*, std::size_t);
+    // the implementation used on the current processor
+    static function select() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1")) {
+            return &aes_bytes;
+        }
+#endif
+        return &wy_hash::bytes;
+    }
+    static inline function const implementation{select()};
+    static bool uses_aes() { return implementation != &wy_hash::bytes; }
+
+    static std::uint64_t bytes(void const* data, std::size_t size) {
+        return implementation(data, size);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,162 @@
+// data-structures/hash.t.cpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "hash.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    // Strings of all lengths up to 300 hash to different values and changing
+    // any byte changes the hash, i.e., no byte is skipped.
+    template <typename Hash>
+    bool uses_all_bytes() {
+        std::string          value;
+        std::vector<std::uint64_t> hashes;
+        for (std::size_t size{0}; size != 300u; ++size) {
+            std::uint64_t hash{Hash()(value)};
+            hashes.push_back(hash);
+            for (char& c: value) {
+                c ^= 0x01;
+                if (hash == Hash()(value)) {
+                    return false;
+                }
+                c ^= 0x01;
+            }
+            value.push_back(char('a' + size % 26u));
+        }
+        std::sort(hashes.begin(), hashes.end());
+        return hashes.end() == std::adjacent_find(hashes.begin(), hashes.end());
+    }
+
+    // The hash only depends on the content, not on the type or the address.
+    template <typename Hash>
+    bool depends_on_content() {
+        for (std::size_t size: { 0u, 3u, 8u, 17u, 100u, 1000u }) {
+            std::string s0(size + 1u, 'x');
+            std::string s1(size, 'x');
+            std::string_view v0(s0.data() + 1, size);
+            if (Hash()(s1) != Hash()(v0)
+                || Hash::bytes(s1.data(), s1.size()) != Hash()(s1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "fnv1a_hash reference values", []{
+            return 0xcbf29ce484222325ull == DS::fnv1a_hash()(std::string())
+                && 0xaf63dc4c8601ec8cull == DS::fnv1a_hash()(std::string("a"))
+                && 0x85944171f73967e8ull == DS::fnv1a_hash()(std::string("foobar"))
+                ;
+        }
+    },
+    { "fnv1a_hash uses all bytes", []{ return uses_all_bytes<DS::fnv1a_hash>(); } },
+    { "wy_hash uses all bytes", []{ return uses_all_bytes<DS::wy_hash>(); } },
+    { "xxh3_hash uses all bytes", []{ return uses_all_bytes<DS::xxh3_hash>(); } },
+    { "aes_hash uses all bytes", []{ return uses_all_bytes<DS::aes_hash>(); } },
+    { "fnv1a_hash depends on the content", []{ return depends_on_content<DS::fnv1a_hash>(); } },
+    { "wy_hash depends on the content", []{ return depends_on_content<DS::wy_hash>(); } },
+    { "xxh3_hash depends on the content", []{ return depends_on_content<DS::xxh3_hash>(); } },
+    { "aes_hash depends on the content", []{ return depends_on_content<DS::aes_hash>(); } },
+    { "xxh3_hash vectorized and scalar agree", []{
+            // all lengths up to 256, a few around the block size, at all
+            // offsets within a vector
+            std::string buffer(2200u, '\0');
+            for (std::size_t i{0}; i != buffer.size(); ++i) {
+                buffer[i] = char(i * 131u + (i >> 3));
+            }
+            std::vector<std::size_t> sizes;
+            for (std::size_t size{0}; size <= 256u; ++size) {
+                sizes.push_back(size);
+            }
+            for (std::size_t size: { 1023u, 1024u, 1025u, 1088u, 2048u, 2111u }) {
+                sizes.push_back(size);
+            }
+            for (std::size_t size: sizes) {
+                for (std::size_t offset{0}; offset != 32u; ++offset) {
+                    char const* data{buffer.data() + offset};
+                    if (DS::xxh3_hash::bytes(data, size)
+                        != DS::xxh3_hash::scalar_bytes(data, size)) {
+                        std::cout << "size=" << size << " offset=" << offset << "\n";
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    },
+    { "xxh3_hash uses wy_hash for short strings", []{
+            std::string value(128u, 'x');
+            return DS::wy_hash()(value) == DS::xxh3_hash()(value)
+                && DS::wy_hash()(value + "x") != DS::xxh3_hash()(value + "x")
+                ;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -132,6 +132,11 @@ private:
         // since the buckets can never be full this point isn't reached!
         return this->p_end();
     }
+    void p_prefetch(std::size_t hash) const {
+        auto index{(hash >> 7) & this->d_mask};
+        __builtin_prefetch(this->p_begin() + index);
+        __builtin_prefetch(&this->d_values[index]);
+    }
     void p_resize() {
         hash_set tmp(2 * (this->d_mask + 1), this->d_hash, this->d_equal);
         for (auto& key: *this) {
@@ -190,6 +195,33 @@ public:
         auto it{this->p_find(hash, key)};
         return p_is_empty(*it)? this->end(): const_iterator{this, it - this->p_begin()};
     }
+    // Determine for each key in [it, end) whether it is contained and write
+    // the result to `to`. The lookups are software-pipelined: the hash for a
+    // key window_size positions ahead is computed and its bucket prefetched
+    // before the current key is compared, i.e., multiple cache misses are
+    // in flight at the same time.
+    static constexpr std::size_t window_size{16u};
+    template <typename FwdIt, typename OutIt>
+    OutIt contains_batch(FwdIt it, FwdIt end, OutIt to) const {
+        std::size_t hashes[window_size];
+        std::size_t count{};
+        FwdIt       ahead{it};
+        for (; count != window_size && ahead != end; ++count, ++ahead) {
+            hashes[count] = this->d_hash(*ahead) >> 3;
+            this->p_prefetch(hashes[count]);
+        }
+        for (std::size_t index{}; it != end; ++it, ++index) {
+            std::size_t& hash{hashes[index % window_size]};
+            *to = !p_is_empty(*this->p_find(hash, *it));
+            ++to;
+            if (ahead != end) {
+                hash = this->d_hash(*ahead) >> 3;
+                this->p_prefetch(hash);
+                ++ahead;
+            }
+        }
+        return to;
+    }
 
     void swap(hash_set& other) {
         using std::swap;
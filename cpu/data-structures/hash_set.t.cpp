@@ -26,6 +26,7 @@
 #include "hash_set.hpp"
 #include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -126,6 +127,38 @@ static std::pair<char const*, bool(*)()> tests[] = {
                 && std::equal(std::begin(keys), std::end(keys), content.begin(), content.end())
                 ;
         }
+    },
+    {
+        "contains_batch agrees with find()", []{
+            DS::hash_set<int> container;
+            for (int i{0}; i < 1000; i += 3) {
+                container.emplace(i);
+            }
+            std::vector<int> keys;
+            for (int i{0}; i != 1000; ++i) {
+                keys.push_back((i * 7919) % 1000);
+            }
+            std::vector<bool> found;
+            container.contains_batch(keys.begin(), keys.end(), std::back_inserter(found));
+            bool success{found.size() == keys.size()};
+            for (std::size_t i{0}; success && i != keys.size(); ++i) {
+                success = found[i] == (container.find(keys[i]) != container.end());
+            }
+            return success;
+        }
+    },
+    {
+        "contains_batch with fewer keys than the window", []{
+            DS::hash_set<std::string> container;
+            container.emplace("foo");
+            std::string keys[] = { "foo", "bar" };
+            std::vector<bool> found;
+            container.contains_batch(std::begin(keys), std::end(keys), std::back_inserter(found));
+            return found.size() == 2u
+                && found[0]
+                && !found[1]
+                ;
+        }
     }
 };
 
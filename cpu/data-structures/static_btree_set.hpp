@@ -0,0 +1,160 @@
+// data-structures/static_btree_set.hpp                               -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_STATIC_BTREE_SET
+#define INCLUDED_DATA_STRUCTURES_STATIC_BTREE_SET
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// A static B-tree ("S-tree") without pointers: the sorted keys are stored in
+// nodes of node_size keys and node k has the children k * (node_size + 1) + i
+// + 1 for i in [0, node_size]. This is a plain B-tree, not a B+-tree: inner
+// nodes hold keys, too, and a search may end in any node. With 16 ints a
+// node is exactly one cache line and the search within a node is done by
+// counting the keys less than the sought key. For int keys with
+// std::less<int> this count uses AVX2 compares when available; keys which
+// are expensive to compare use a binary search within the node instead.
+// Unused key positions of the last nodes are padded with the largest key.
+
+namespace cpu {
+    namespace data_structures {
+        template <typename Key, typename Compare = std::less<Key>>
+        class static_btree_set;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Key, typename Compare>
+class cpu::data_structures::static_btree_set {
+public:
+    static constexpr std::size_t node_size{16u};
+
+private:
+    struct alignas(64) node {
+        Key keys[node_size];
+    };
+
+    std::vector<node> d_nodes;
+    std::size_t       d_size{};
+    Compare           d_compare;
+
+    static std::size_t p_child(std::size_t k, std::size_t i) {
+        return k * (node_size + 1u) + i + 1u;
+    }
+
+    template <typename It>
+    void p_build(It& it, It end, Key const& pad, std::size_t k) {
+        if (k < this->d_nodes.size()) {
+            for (std::size_t i{}; i != node_size; ++i) {
+                this->p_build(it, end, pad, p_child(k, i));
+                this->d_nodes[k].keys[i] = it != end? *it++: pad;
+            }
+            this->p_build(it, end, pad, p_child(k, node_size));
+        }
+    }
+
+    // number of keys in the node less than key
+    std::size_t p_rank(node const& n, Key const& key) const {
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<Key, int> && std::is_same_v<Compare, std::less<int>>) {
+            __m256i const x{_mm256_set1_epi32(key)};
+            __m256i const lo{_mm256_cmpgt_epi32(x, _mm256_load_si256(reinterpret_cast<__m256i const*>(n.keys)))};
+            __m256i const hi{_mm256_cmpgt_epi32(x, _mm256_load_si256(reinterpret_cast<__m256i const*>(n.keys + 8)))};
+            unsigned int mask(_mm256_movemask_ps(_mm256_castsi256_ps(lo))
+                              | (_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8));
+            return __builtin_popcount(mask);
+        }
+#endif
+        if constexpr (std::is_arithmetic_v<Key>) {
+            // branch-free count which the compiler can vectorise
+            std::size_t rank{};
+            for (std::size_t i{}; i != node_size; ++i) {
+                rank += this->d_compare(n.keys[i], key);
+            }
+            return rank;
+        }
+        else {
+            // expensive comparisons: the keys within a node are sorted
+            return std::lower_bound(n.keys, n.keys + node_size, key, this->d_compare) - n.keys;
+        }
+    }
+
+public:
+    using value_type = Key;
+    using size_type  = std::size_t;
+
+    static_btree_set() = default;
+    template <typename InIt>
+    static_btree_set(InIt it, InIt end, Compare const& compare = Compare())
+        : d_compare(compare) {
+        std::vector<Key> sorted(it, end);
+        std::sort(sorted.begin(), sorted.end(), this->d_compare);
+        sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                                 [this](Key const& k0, Key const& k1){
+                                     return !this->d_compare(k0, k1) && !this->d_compare(k1, k0);
+                                 }),
+                     sorted.end());
+        this->d_size = sorted.size();
+        if (!sorted.empty()) {
+            this->d_nodes.resize((sorted.size() + node_size - 1u) / node_size);
+            auto sit{sorted.cbegin()};
+            this->p_build(sit, sorted.cend(), sorted.back(), 0u);
+        }
+    }
+
+    bool      empty() const { return this->d_size == 0u; }
+    size_type size() const { return this->d_size; }
+
+    // Returns a pointer to the first key not less than key or nullptr.
+    Key const* lower_bound(Key const& key) const {
+        Key const* result{};
+        for (std::size_t k{}; k < this->d_nodes.size(); ) {
+            node const& n{this->d_nodes[k]};
+            std::size_t i{this->p_rank(n, key)};
+            if (i != node_size) {
+                result = n.keys + i;
+            }
+            k = p_child(k, i);
+        }
+        return result;
+    }
+    bool contains(Key const& key) const {
+        Key const* k{this->lower_bound(key)};
+        return k && !this->d_compare(key, *k);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,154 @@
+// data-structures/string_pool.hpp                                    -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_DATA_STRUCTURES_STRING_POOL
+#define INCLUDED_DATA_STRUCTURES_STRING_POOL
+
+#include "cpu/data-structures/hash_set.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// A string pool interns strings: each distinct string is copied once into a
+// bump-allocated arena and identified by a dense 32 bit id. The ids and the
+// string_views referring to the arena remain valid until the pool is
+// destroyed. The ids are held by a hash_set whose hash and equality
+// functions look up the entry for an id which stores the full hash, i.e.,
+// growing the set doesn't rehash the strings and most mismatches are
+// detected without comparing characters.
+//
+// Lookups of strings not yet in the pool use a reserved probe id which
+// refers to the sought string. Thus, find() isn't thread-safe even though
+// it is const.
+
+namespace cpu {
+    namespace data_structures {
+        class string_pool;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::data_structures::string_pool {
+public:
+    using id_type   = std::uint32_t;
+    using size_type = std::size_t;
+    static constexpr id_type npos{std::numeric_limits<id_type>::max()};
+
+private:
+    struct entry {
+        char const* data;
+        std::size_t size;
+        std::size_t hash;
+        std::string_view view() const { return std::string_view(this->data, this->size); }
+    };
+    struct id_hash {
+        string_pool const* d_pool;
+        std::size_t operator()(id_type id) const { return this->d_pool->p_entry(id).hash; }
+    };
+    struct id_equal {
+        string_pool const* d_pool;
+        bool operator()(id_type id0, id_type id1) const {
+            entry const& e0{this->d_pool->p_entry(id0)};
+            entry const& e1{this->d_pool->p_entry(id1)};
+            return e0.hash == e1.hash && e0.view() == e1.view();
+        }
+    };
+
+    std::size_t                          d_chunk_size;
+    std::vector<std::unique_ptr<char[]>> d_chunks;
+    char*                                d_next{};
+    char*                                d_end{};
+    std::size_t                          d_bytes{};
+    std::vector<entry>                   d_entries;
+    mutable entry                        d_probe{};
+    hash_set<id_type, id_hash, id_equal> d_ids;
+
+    entry const& p_entry(id_type id) const {
+        return id == npos? this->d_probe: this->d_entries[id];
+    }
+    char const* p_allocate(std::string_view s) {
+        if (std::size_t(this->d_end - this->d_next) < s.size()) {
+            std::size_t size{std::max(s.size(), this->d_chunk_size)};
+            this->d_chunks.emplace_back(new char[size]);
+            this->d_next = this->d_chunks.back().get();
+            this->d_end  = this->d_next + size;
+        }
+        char* rc{this->d_next};
+        std::copy(s.begin(), s.end(), rc);
+        this->d_next  += s.size();
+        this->d_bytes += s.size();
+        return rc;
+    }
+
+public:
+    explicit string_pool(std::size_t chunk_size = 64u * 1024u)
+        : d_chunk_size(chunk_size)
+        , d_ids(16u, id_hash{this}, id_equal{this}) {
+    }
+    string_pool(string_pool const&) = delete; // the functions refer to this
+    void operator=(string_pool const&) = delete;
+
+    bool      empty() const { return this->d_entries.empty(); }
+    size_type size() const { return this->d_entries.size(); }
+    // number of characters stored in the arena
+    size_type bytes() const { return this->d_bytes; }
+
+    // Returns the id of s, adding a copy of s to the pool if necessary. The
+    // entry is added before the insertion attempt so the set is probed only
+    // once and it is removed again if s was already present.
+    id_type intern(std::string_view s) {
+        id_type id(this->d_entries.size());
+        this->d_entries.push_back(entry{s.data(), s.size(), std::hash<std::string_view>()(s)});
+        auto rc{this->d_ids.emplace(id)};
+        if (rc.second) {
+            this->d_entries.back().data = this->p_allocate(s);
+        }
+        else {
+            this->d_entries.pop_back();
+        }
+        return *rc.first;
+    }
+    std::string_view intern_view(std::string_view s) {
+        return (*this)[this->intern(s)];
+    }
+    // Returns the id of s or npos if s isn't in the pool.
+    id_type find(std::string_view s) const {
+        this->d_probe = entry{s.data(), s.size(), std::hash<std::string_view>()(s)};
+        auto it{this->d_ids.find(npos)};
+        return it == this->d_ids.end()? npos: *it;
+    }
+    std::string_view operator[](id_type id) const { return this->d_entries[id].view(); }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
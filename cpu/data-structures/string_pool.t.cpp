@@ -0,0 +1,140 @@
+// data-structures/string_pool.t.cpp                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "string_pool.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "initial state", []{
+            DS::string_pool pool;
+            return pool.empty()
+                && 0u == pool.size()
+                && 0u == pool.bytes()
+                && DS::string_pool::npos == pool.find("foo")
+                ;
+        }
+    },
+    { "interning a string copies it", []{
+            DS::string_pool pool;
+            std::string     value("/usr/local/include/foo");
+            auto            id{pool.intern(value)};
+            std::string_view view{pool[id]};
+            value[1] = 'X';
+            return !pool.empty()
+                && 1u == pool.size()
+                && 22u == pool.bytes()
+                && view == "/usr/local/include/foo"
+                && view.data() != value.data()
+                && id == pool.find("/usr/local/include/foo")
+                ;
+        }
+    },
+    { "interning a string twice yields the same id", []{
+            DS::string_pool pool;
+            auto id0{pool.intern("foo")};
+            auto id1{pool.intern("bar")};
+            auto id2{pool.intern(std::string("foo"))};
+            std::string_view view{pool.intern_view("bar")};
+            return id0 == id2
+                && id0 != id1
+                && 2u == pool.size()
+                && 6u == pool.bytes()
+                && view.data() == pool[id1].data()
+                ;
+        }
+    },
+    { "ids and views are stable while the pool grows", []{
+            DS::string_pool pool(64u);
+            std::vector<std::string_view> views;
+            for (int i{0}; i != 10000; ++i) {
+                views.push_back(pool.intern_view("/some/path/" + std::to_string(i)));
+            }
+            views.push_back(pool.intern_view(std::string(1000u, 'x')));
+            bool success{10001u == pool.size()};
+            for (int i{0}; success && i != 10000; ++i) {
+                std::string value("/some/path/" + std::to_string(i));
+                success = views[i] == value
+                    && pool.find(value) == DS::string_pool::id_type(i)
+                    && pool.intern(value) == DS::string_pool::id_type(i)
+                    ;
+            }
+            return success
+                && views.back() == std::string(1000u, 'x')
+                && 10001u == pool.size()
+                ;
+        }
+    },
+    { "the empty string can be interned", []{
+            DS::string_pool pool;
+            auto id{pool.intern("")};
+            return 1u == pool.size()
+                && pool[id].empty()
+                && id == pool.intern(std::string())
+                && id == pool.find("")
+                ;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
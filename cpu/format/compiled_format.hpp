@@ -0,0 +1,179 @@
+// format/compiled_format.hpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_FORMAT_COMPILED_FORMAT
+#define INCLUDED_FORMAT_COMPILED_FORMAT
+
+#include "cpu/format/format_int.hpp"
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// A format string parsed at compile time: the format string is a constexpr
+// character array with static storage duration, e.g.
+//
+//     constexpr char greeting[] = "hello {}, you are {} years old\n";
+//     using format = cpu::format::compiled_format<greeting, name, int>;
+//     char buffer[format::max_size];
+//     char* end = format::format(buffer, n, age);
+//
+// Each "{}" is a slot for the next argument and "{{" and "}}" denote literal
+// braces. The format string is split into fixed chunks when the template is
+// instantiated and the number of slots is checked against the number of
+// argument types. The arguments are formatted by formatter<T> which has to
+// provide a compile-time upper bound max_size on the number of characters
+// produced and a function format(to, value) returning the end of the output.
+// Thus, max_size of the compiled_format is an upper bound for the whole
+// output and the characters are written without any bounds checks.
+//
+// formatter is provided for the integer types and char; other types can be
+// supported by specialising cpu::format::formatter.
+
+namespace cpu {
+    namespace format {
+        template <typename T, typename = void>
+        struct formatter;
+
+        template <char const* Format, typename... T>
+        class compiled_format;
+
+        namespace detail {
+            constexpr std::size_t length(char const* s) {
+                std::size_t rc(0u);
+                while (s[rc]) {
+                    ++rc;
+                }
+                return rc;
+            }
+
+            // The literal text of a format string with the escaped braces
+            // resolved and the position of the slots in this text.
+            template <std::size_t Size, std::size_t Slots>
+            struct parsed_format {
+                char        text[Size + 1u]{};
+                std::size_t end[Slots + 1u]{}; // end of the chunk before slot i
+                std::size_t slots{0u};
+                bool        valid{true};
+            };
+
+            template <std::size_t Size, std::size_t Slots>
+            constexpr parsed_format<Size, Slots> parse(char const* format) {
+                parsed_format<Size, Slots> rc{};
+                std::size_t out(0u);
+                for (std::size_t i(0u); i != Size; ++i) {
+                    if (format[i] == '{' && i + 1u != Size && format[i + 1u] == '{') {
+                        rc.text[out++] = '{';
+                        ++i;
+                    }
+                    else if (format[i] == '}' && i + 1u != Size && format[i + 1u] == '}') {
+                        rc.text[out++] = '}';
+                        ++i;
+                    }
+                    else if (format[i] == '{' && i + 1u != Size && format[i + 1u] == '}') {
+                        if (rc.slots == Slots) {
+                            rc.valid = false;
+                            return rc;
+                        }
+                        rc.end[rc.slots++] = out;
+                        ++i;
+                    }
+                    else if (format[i] == '{' || format[i] == '}') {
+                        rc.valid = false; // unmatched brace
+                        return rc;
+                    }
+                    else {
+                        rc.text[out++] = format[i];
+                    }
+                }
+                rc.end[rc.slots] = out;
+                return rc;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Int>
+struct cpu::format::formatter<Int, std::enable_if_t<std::is_integral_v<Int>
+                                                    && !std::is_same_v<Int, bool>
+                                                    && !std::is_same_v<Int, char>>> {
+    static constexpr std::size_t max_size = cpu::format::max_size<Int>;
+    static char* format(char* to, Int value) { return cpu::format::format_int(to, value); }
+};
+
+template <>
+struct cpu::format::formatter<char> {
+    static constexpr std::size_t max_size = 1u;
+    static char* format(char* to, char value) { *to = value; return to + 1; }
+};
+
+// ----------------------------------------------------------------------------
+
+template <char const* Format, typename... T>
+class cpu::format::compiled_format {
+private:
+    static constexpr std::size_t size{detail::length(Format)};
+    static constexpr detail::parsed_format<size, sizeof...(T)> parsed{
+        detail::parse<size, sizeof...(T)>(Format)
+    };
+    static_assert(parsed.valid, "format string contains an unmatched brace or too many slots");
+    static_assert(parsed.slots == sizeof...(T), "format string has fewer slots than arguments");
+
+    template <std::size_t I>
+    static char* chunk(char* to) {
+        constexpr std::size_t begin{I == 0u? 0u: parsed.end[I - 1u]};
+        constexpr std::size_t length{parsed.end[I] - begin};
+        if constexpr (length != 0u) {
+            std::memcpy(to, parsed.text + begin, length);
+        }
+        return to + length;
+    }
+    template <std::size_t... I>
+    static char* p_format(char* to, std::index_sequence<I...>, T const&... args) {
+        to = chunk<0u>(to);
+        ((to = chunk<I + 1u>(formatter<T>::format(to, args))), ...);
+        return to;
+    }
+
+public:
+    // an upper bound of the characters written by format()
+    static constexpr std::size_t max_size{
+        parsed.end[sizeof...(T)] + (std::size_t(0u) + ... + formatter<T>::max_size)
+    };
+
+    // Writes the formatted arguments to `to` which has to have space for at
+    // least max_size characters and returns the end of the output. The
+    // result isn't null-terminated.
+    static char* format(char* to, T const&... args) {
+        return p_format(to, std::index_sequence_for<T...>(), args...);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,142 @@
+// format/compiled_format.t.cpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "compiled_format.hpp"
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+namespace CF = cpu::format;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct point { int x, y; };
+
+    constexpr char empty_format[]   = "";
+    constexpr char literal_format[] = "no slots";
+    constexpr char ints_format[]    = "{} + {} = {}";
+    constexpr char escaped_format[] = "{{{}}} }}{{";
+    constexpr char point_format[]   = "point={} c={}\n";
+    constexpr char adjacent_format[] = "{}{}";
+
+    template <typename Format, typename... T>
+    std::string format(T const&... args) {
+        char buffer[Format::max_size];
+        return std::string(buffer, Format::format(buffer, args...));
+    }
+}
+
+template <>
+struct cpu::format::formatter<point> {
+    static constexpr std::size_t max_size = 3u + 2u * formatter<int>::max_size;
+    static char* format(char* to, point p) {
+        *to++ = '(';
+        to = formatter<int>::format(to, p.x);
+        *to++ = ',';
+        to = formatter<int>::format(to, p.y);
+        *to++ = ')';
+        return to;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "empty format string", []{
+            using format_type = CF::compiled_format<empty_format>;
+            return 0u == format_type::max_size
+                && format<format_type>().empty()
+                ;
+        }
+    },
+    { "format string without slots", []{
+            using format_type = CF::compiled_format<literal_format>;
+            return 8u == format_type::max_size
+                && "no slots" == format<format_type>()
+                ;
+        }
+    },
+    { "integer slots", []{
+            using format_type = CF::compiled_format<ints_format, int, unsigned char, long>;
+            return 6u + 11u + 3u + 20u == format_type::max_size
+                && "1 + 255 = -256" == format<format_type>(1, (unsigned char)(255), -256l)
+                && "-2147483648 + 0 = 0" == format<format_type>(std::numeric_limits<int>::min(), (unsigned char)(0), 0l)
+                ;
+        }
+    },
+    { "escaped braces", []{
+            using format_type = CF::compiled_format<escaped_format, int>;
+            return "{17} }{" == format<format_type>(17)
+                ;
+        }
+    },
+    { "user-defined formatter", []{
+            using format_type = CF::compiled_format<point_format, point, char>;
+            return 10u + 25u + 1u == format_type::max_size
+                && "point=(-1,2) c=x\n" == format<format_type>(point{-1, 2}, 'x')
+                ;
+        }
+    },
+    { "adjacent slots", []{
+            using format_type = CF::compiled_format<adjacent_format, int, int>;
+            return "12" == format<format_type>(1, 2);
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,201 @@
+// format/format_int.hpp                                              -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_FORMAT_FORMAT_INT
+#define INCLUDED_FORMAT_FORMAT_INT
+
+#include <limits>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Formatting of integers in decimal: count_digits() determines the number of
+// digits from the position of the most significant bit and one comparison
+// with a power of 10, i.e., without a loop. format_int() then writes the
+// digits from the back two at a time using a table of the 100 digit pairs.
+// The result isn't null-terminated and the buffer needs to have space for
+// max_size<Int> characters.
+
+namespace cpu {
+    namespace format {
+        template <typename Int>
+        constexpr std::size_t max_size = std::numeric_limits<Int>::digits10 + 1
+                                       + std::is_signed_v<Int>;
+        template <>
+        constexpr std::size_t max_size<unsigned __int128> = 39;
+        template <>
+        constexpr std::size_t max_size<__int128> = 40;
+
+        int count_digits(std::uint32_t value);
+        int count_digits(std::uint64_t value);
+
+        template <typename Int>
+        char* format_int(char* to, Int value);
+
+        namespace detail {
+            template <typename UInt>
+            char* format_digits(char* to, UInt value, int digits);
+            char* format_uint(char* to, std::uint32_t value);
+            char* format_uint(char* to, std::uint64_t value);
+            char* format_uint(char* to, unsigned __int128 value);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace cpu {
+    namespace format {
+        namespace detail {
+            inline constexpr char digit_pairs[201] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+
+            inline constexpr std::uint64_t powers_of_10[] = {
+                1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u,
+                100000000u, 1000000000u, 10000000000u, 100000000000u,
+                1000000000000u, 10000000000000u, 100000000000000u,
+                1000000000000000u, 10000000000000000u, 100000000000000000u,
+                1000000000000000000u, 10000000000000000000u
+            };
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// An estimate of log10 is obtained from the bit width as bits * 1233 >> 12
+// (1233 / 4096 is approximately log10(2)); it is off by at most one which
+// is corrected by comparing with the corresponding power of 10. Setting the
+// lowest bit doesn't change the result except that 0 yields 1 digit.
+
+inline int
+cpu::format::count_digits(std::uint64_t value)
+{
+    int const bits(64 - __builtin_clzll(value | 1u));
+    int const t((bits * 1233) >> 12);
+    return t + 1 - ((value | 1u) < detail::powers_of_10[t]);
+}
+
+inline int
+cpu::format::count_digits(std::uint32_t value)
+{
+    int const bits(32 - __builtin_clz(value | 1u));
+    int const t((bits * 1233) >> 12);
+    return t + 1 - ((value | 1u) < detail::powers_of_10[t]);
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename UInt>
+inline char*
+cpu::format::detail::format_digits(char* to, UInt value, int digits)
+{
+    char* end(to + digits);
+    char* it(end);
+    while (100u <= value) {
+        unsigned const pair(static_cast<unsigned>(value % 100u) * 2u);
+        value /= 100u;
+        it -= 2;
+        std::memcpy(it, digit_pairs + pair, 2u);
+    }
+    if (10u <= value) {
+        it -= 2;
+        std::memcpy(it, digit_pairs + value * 2u, 2u);
+    }
+    else {
+        *--it = char('0' + value);
+    }
+    return end;
+}
+
+inline char*
+cpu::format::detail::format_uint(char* to, std::uint32_t value)
+{
+    return format_digits(to, value, count_digits(value));
+}
+
+inline char*
+cpu::format::detail::format_uint(char* to, std::uint64_t value)
+{
+    // the 32 bit division is cheaper when the value fits
+    return value <= std::numeric_limits<std::uint32_t>::max()
+        ? format_uint(to, static_cast<std::uint32_t>(value))
+        : format_digits(to, value, count_digits(value));
+}
+
+inline char*
+cpu::format::detail::format_uint(char* to, unsigned __int128 value)
+{
+    // split into chunks of 19 digits which fit into 64 bits
+    std::uint64_t const chunk(powers_of_10[19]);
+    if (value <= std::numeric_limits<std::uint64_t>::max()) {
+        return format_uint(to, static_cast<std::uint64_t>(value));
+    }
+    unsigned __int128 const high(value / chunk);
+    std::uint64_t const     low(static_cast<std::uint64_t>(value % chunk));
+    to = format_uint(to, high);
+    std::memset(to, '0', 19u);
+    format_digits(to + 19 - count_digits(low), low, count_digits(low));
+    return to + 19;
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Int>
+inline char*
+cpu::format::format_int(char* to, Int value)
+{
+    static_assert(std::is_integral_v<Int> || std::is_same_v<Int, __int128>
+                  || std::is_same_v<Int, unsigned __int128>,
+                  "format_int() requires an integer type");
+    static_assert(!std::is_same_v<Int, bool>, "format_int() doesn't format bool");
+    using unsigned_type = std::conditional_t<
+        (sizeof(Int) > sizeof(std::uint64_t)), unsigned __int128,
+        std::conditional_t<(sizeof(Int) > sizeof(std::uint32_t)),
+                           std::uint64_t, std::uint32_t>>;
+
+    unsigned_type magnitude(static_cast<unsigned_type>(value));
+    if constexpr (std::is_signed_v<Int> || std::is_same_v<Int, __int128>) {
+        if (value < 0) {
+            *to++ = '-';
+            magnitude = unsigned_type(0) - magnitude; // no overflow for min()
+        }
+    }
+    return detail::format_uint(to, magnitude);
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
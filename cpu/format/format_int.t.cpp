@@ -0,0 +1,151 @@
+// format/format_int.t.cpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "format_int.hpp"
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+namespace CF = cpu::format;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Int>
+    bool formats_like_to_string(Int value) {
+        char buffer[CF::max_size<Int>];
+        char* end(CF::format_int(buffer, value));
+        std::string expect(std::to_string(value));
+        if (std::string(buffer, end) != expect) {
+            std::cout << "expected=" << expect << " got=" << std::string(buffer, end) << " ";
+            return false;
+        }
+        return true;
+    }
+
+    // Check the limits, the powers of 10 and their neighbours, and some
+    // random values.
+    template <typename Int>
+    bool formats_like_to_string() {
+        using limits = std::numeric_limits<Int>;
+        bool success(formats_like_to_string(limits::min())
+                     && formats_like_to_string(limits::max())
+                     && formats_like_to_string(Int(0)));
+        for (Int p(1); success && p <= limits::max() / 10; p *= 10) {
+            success = formats_like_to_string(Int(p - 1))
+                && formats_like_to_string(p)
+                && formats_like_to_string(Int(p + 1))
+                && formats_like_to_string(Int(p * 10 - 1))
+                && (!limits::is_signed || formats_like_to_string(Int(-p)))
+                ;
+        }
+        std::mt19937_64 gen(17);
+        for (int i(0); success && i != 10000; ++i) {
+            success = formats_like_to_string(Int(gen() >> (gen() % 64)));
+        }
+        return success;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> tests[] = {
+    { "count_digits", []{
+            bool success(CF::count_digits(std::uint32_t(0)) == 1
+                         && CF::count_digits(std::uint64_t(0)) == 1
+                         && CF::count_digits(std::numeric_limits<std::uint32_t>::max()) == 10
+                         && CF::count_digits(std::numeric_limits<std::uint64_t>::max()) == 20);
+            std::uint64_t p(1);
+            for (int digits(1); success && digits != 20; ++digits, p *= 10u) {
+                success = CF::count_digits(p) == digits
+                    && CF::count_digits(p * 10u - 1u) == digits
+                    && (p * 10u - 1u > std::numeric_limits<std::uint32_t>::max()
+                        || CF::count_digits(std::uint32_t(p * 10u - 1u)) == digits)
+                    ;
+            }
+            return success;
+        }
+    },
+    { "format_int signed char", []{ return formats_like_to_string<signed char>(); } },
+    { "format_int unsigned char", []{ return formats_like_to_string<unsigned char>(); } },
+    { "format_int short", []{ return formats_like_to_string<short>(); } },
+    { "format_int unsigned short", []{ return formats_like_to_string<unsigned short>(); } },
+    { "format_int int", []{ return formats_like_to_string<int>(); } },
+    { "format_int unsigned int", []{ return formats_like_to_string<unsigned int>(); } },
+    { "format_int long", []{ return formats_like_to_string<long>(); } },
+    { "format_int unsigned long", []{ return formats_like_to_string<unsigned long>(); } },
+    { "format_int long long", []{ return formats_like_to_string<long long>(); } },
+    { "format_int unsigned long long", []{ return formats_like_to_string<unsigned long long>(); } },
+    { "format_int 128 bit", []{
+            unsigned __int128 const max(~static_cast<unsigned __int128>(0));
+            char buffer[CF::max_size<__int128>];
+            std::string umax(buffer, CF::format_int(buffer, max));
+            std::string smin(buffer, CF::format_int(buffer, static_cast<__int128>(max / 2u + 1u)));
+            std::string mid(buffer, CF::format_int(buffer, static_cast<unsigned __int128>(1u) << 64));
+            std::string zeros(buffer, CF::format_int(buffer, static_cast<unsigned __int128>(10000000000000000000u) * 100u + 7u));
+            return umax == "340282366920938463463374607431768211455"
+                && smin == "-170141183460469231731687303715884105728"
+                && mid == "18446744073709551616"
+                && zeros == "1000000000000000000007"
+                ;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
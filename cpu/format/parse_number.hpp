@@ -0,0 +1,255 @@
+// format/parse_number.hpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_FORMAT_PARSE_NUMBER
+#define INCLUDED_FORMAT_PARSE_NUMBER
+
+#include <charconv>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Parsing of decimal numbers with the interface of std::from_chars(): the
+// digits are converted several at a time instead of one by one. Eight
+// characters are loaded into a 64 bit word which is checked for digits and
+// converted using three multiplications (SWAR, i.e., SIMD within a
+// register). A run of fewer than eight digits is shifted such that the
+// missing digits become leading zeros. With SSE4.1 up to 16 digits are
+// converted at a time in the same way using vector instructions. The wide
+// loads are only used when there are enough characters before `last`, i.e.,
+// the parser never reads beyond the range.
+//
+// parse_double() uses the same digit conversion for the mantissa and
+// computes the result with one multiplication or division by an exact
+// power of 10 when that is correctly rounded (the mantissa fits into 53
+// bits and the exponent is at most 22). Other cases, including "inf" and
+// "nan", are delegated to std::from_chars().
+
+namespace cpu {
+    namespace format {
+        template <typename Int>
+        std::from_chars_result parse_int(char const* first, char const* last, Int& value);
+        std::from_chars_result parse_double(char const* first, char const* last, double& value);
+
+        namespace detail {
+            std::uint64_t load8(char const* it);
+            int           count_digits8(std::uint64_t chars);
+            std::uint32_t convert8(std::uint64_t digits);
+            bool          parse_digits(char const*& it, char const* last, std::uint64_t& value);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::uint64_t
+cpu::format::detail::load8(char const* it)
+{
+    std::uint64_t rc;
+    std::memcpy(&rc, it, sizeof(rc));
+    return rc;
+}
+
+// The argument has '0' removed from each byte (using xor), i.e., digits are
+// the bytes with a value below 10. Adding 0x76 to the low 7 bits sets the
+// high bit of the other bytes without a carry into the next byte.
+inline int
+cpu::format::detail::count_digits8(std::uint64_t chars)
+{
+    std::uint64_t const high(0x8080808080808080u);
+    std::uint64_t const other((((chars & ~high) + 0x7676767676767676u) | chars) & high);
+    return other? __builtin_ctzll(other) / 8: 8;
+}
+
+// Converts eight digit values with the first digit in the lowest byte:
+// adjacent digits are combined into pairs, then the pairs into groups of
+// four, and finally the two groups.
+inline std::uint32_t
+cpu::format::detail::convert8(std::uint64_t digits)
+{
+    digits = (digits * 10u) + (digits >> 8);
+    digits = (((digits & 0x000000FF000000FFu) * (100u + (1000000ull << 32)))
+              + (((digits >> 16) & 0x000000FF000000FFu) * (1u + (10000ull << 32)))) >> 32;
+    return std::uint32_t(digits);
+}
+
+// Appends the digits starting at `it` to `value`, advancing `it` past the
+// digits. Returns false if the value doesn't fit into 64 bits in which case
+// the remaining digits are skipped.
+inline bool
+cpu::format::detail::parse_digits(char const*& it, char const* last, std::uint64_t& value)
+{
+    static constexpr std::uint64_t powers[] = {
+        1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u,
+        1000000000u, 10000000000u, 100000000000u, 1000000000000u,
+        10000000000000u, 100000000000000u, 1000000000000000u, 10000000000000000u
+    };
+    bool fits(true);
+    auto append = [&](std::uint64_t factor, std::uint64_t digits) {
+        fits = fits
+            && !__builtin_mul_overflow(value, factor, &value)
+            && !__builtin_add_overflow(value, digits, &value);
+    };
+
+#if defined(__SSE4_1__)
+    // The digits at the start of 16 characters are moved to the end using a
+    // shuffle; the positions in front become zero, i.e., leading zeros.
+    alignas(16) static constexpr signed char shift[32] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+         0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+    };
+    while (16 <= last - it) {
+        __m128i const chars(_mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(it)),
+                                         _mm_set1_epi8('0')));
+        // digits are the bytes which are unsigned at most 9
+        __m128i const nine(_mm_set1_epi8(9));
+        unsigned const mask(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chars, nine), nine)));
+        int const count(__builtin_ctz(~mask));
+        if (count == 0) {
+            return fits;
+        }
+        __m128i digits(_mm_shuffle_epi8(chars, _mm_loadu_si128(reinterpret_cast<__m128i const*>(shift + count))));
+        __m128i pairs(_mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                              10, 1, 10, 1, 10, 1, 10, 1)));
+        __m128i quads(_mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1)));
+        __m128i packed(_mm_packus_epi32(quads, quads));
+        __m128i eights(_mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1)));
+        std::uint64_t high(std::uint32_t(_mm_cvtsi128_si32(eights)));
+        std::uint64_t low(std::uint32_t(_mm_extract_epi32(eights, 1)));
+        append(powers[count], high * 100000000u + low);
+        it += count;
+        if (count != 16) {
+            return fits;
+        }
+    }
+#endif
+    while (8 <= last - it) {
+        std::uint64_t const chars(load8(it) ^ 0x3030303030303030u);
+        int const           count(count_digits8(chars));
+        if (count == 0) {
+            return fits;
+        }
+        append(powers[count], convert8(chars << (8 * (8 - count))));
+        it += count;
+        if (count != 8) {
+            return fits;
+        }
+    }
+    for (; it != last && unsigned(*it - '0') < 10u; ++it) {
+        append(10u, unsigned(*it - '0'));
+    }
+    return fits;
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Int>
+inline std::from_chars_result
+cpu::format::parse_int(char const* first, char const* last, Int& value)
+{
+    static_assert(std::is_integral_v<Int> && !std::is_same_v<Int, bool>
+                  && sizeof(Int) <= sizeof(std::uint64_t),
+                  "parse_int() requires an integer type of at most 64 bits");
+    char const* it(first);
+    bool const  negative(std::is_signed_v<Int> && it != last && *it == '-');
+    it += negative;
+
+    char const*   begin(it);
+    std::uint64_t magnitude(0u);
+    bool          fits(detail::parse_digits(it, last, magnitude));
+    if (it == begin) {
+        return { first, std::errc::invalid_argument };
+    }
+
+    using unsigned_type = std::make_unsigned_t<Int>;
+    std::uint64_t const limit(std::uint64_t(std::numeric_limits<Int>::max()) + negative);
+    if (!fits || limit < magnitude) {
+        return { it, std::errc::result_out_of_range };
+    }
+    value = Int(negative? unsigned_type(0u) - unsigned_type(magnitude): unsigned_type(magnitude));
+    return { it, std::errc() };
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::from_chars_result
+cpu::format::parse_double(char const* first, char const* last, double& value)
+{
+    static constexpr double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    char const*   it(first);
+    bool const    negative(it != last && *it == '-');
+    it += negative;
+
+    std::uint64_t mantissa(0u);
+    char const*   begin(it);
+    bool          fits(detail::parse_digits(it, last, mantissa));
+    std::size_t   digits(it - begin);
+    long          exponent(0);
+    if (it != last && *it == '.') {
+        char const* fraction(++it);
+        fits = detail::parse_digits(it, last, mantissa) && fits;
+        digits  += it - fraction;
+        exponent = -long(it - fraction);
+    }
+    if (digits == 0u) {
+        return std::from_chars(first, last, value);
+    }
+    if (it != last && (*it == 'e' || *it == 'E')) {
+        char const* exp(it + 1);
+        bool const  exp_negative(exp != last && *exp == '-');
+        exp += exp != last && (*exp == '-' || *exp == '+');
+        char const*   exp_begin(exp);
+        std::uint64_t exp_value(0u);
+        if (detail::parse_digits(exp, last, exp_value) && exp != exp_begin && exp_value < 1000u) {
+            exponent += exp_negative? -long(exp_value): long(exp_value);
+            it = exp;
+        }
+        else if (exp != exp_begin) {
+            return std::from_chars(first, last, value);
+        }
+    }
+
+    if (!fits || (std::uint64_t(1u) << 53) < mantissa || exponent < -22 || 22 < exponent) {
+        return std::from_chars(first, last, value);
+    }
+    double result(static_cast<double>(mantissa));
+    result = exponent < 0? result / powers[-exponent]: result * powers[exponent];
+    value = negative? -result: result;
+    return { it, std::errc() };
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,187 @@
+// format/parse_number.t.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "parse_number.hpp"
+#include "format_int.hpp"
+#include <charconv>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace CF = cpu::format;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    // The string is parsed at different positions within a buffer followed
+    // by different suffixes to exercise the 16, 8, and 1 digit paths.
+    template <typename T, typename Parse>
+    bool parses_like_from_chars(std::string const& text, Parse parse) {
+        for (std::string suffix: { "", " ", "\n123", "x", "0123456789012345678901234" }) {
+            std::string input(text + suffix);
+            T expect{}, got{};
+            auto e(std::from_chars(input.data(), input.data() + input.size(), expect));
+            auto g(parse(input.data(), input.data() + input.size(), got));
+            if (e.ptr != g.ptr || e.ec != g.ec
+                || (e.ec == std::errc() && std::memcmp(&expect, &got, sizeof(T)) != 0)) {
+                std::cout << "input='" << input << "' ";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Int>
+    bool parse_int(std::string const& text) {
+        return parses_like_from_chars<Int>(text, [](char const* f, char const* l, Int& v){
+                return CF::parse_int(f, l, v);
+            });
+    }
+    bool parse_double(std::string const& text) {
+        return parses_like_from_chars<double>(text, [](char const* f, char const* l, double& v){
+                return CF::parse_double(f, l, v);
+            });
+    }
+
+    template <typename Int>
+    bool parses_ints() {
+        using limits = std::numeric_limits<Int>;
+        std::string const fixed[] = {
+            "0", "-0", "00000000000000000000000042", "-", "", "x", "+1", " 1",
+            std::to_string(limits::min()), std::to_string(limits::max()),
+            std::to_string(limits::max()) + "0", "-" + std::to_string(limits::max()) + "0",
+            "99999999999999999999999", "18446744073709551616", "9223372036854775808",
+            "-9223372036854775809", "12345678", "123456789", "1234567890123456",
+            "12345678901234567"
+        };
+        for (std::string const& text: fixed) {
+            if (!parse_int<Int>(text)) {
+                return false;
+            }
+        }
+        std::mt19937_64 gen(17);
+        for (int i(0); i != 10000; ++i) {
+            std::uint64_t bits(gen() >> (gen() % 64u));
+            if (!parse_int<Int>(std::to_string(Int(bits)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parses_doubles() {
+        std::string const fixed[] = {
+            "0", "-0", "0.0", "1.", ".5", "-.5", ".", "-", "e5", "1e", "1e+", "1e-5",
+            "1E22", "1e23", "1e-22", "1e-23", "123.456e3", "9007199254740992",
+            "9007199254740993", "0.1234567890123456789", "1e400", "1e-400",
+            "inf", "-nan", "12345678901234567890123456789", "3.14159", "1e0001"
+        };
+        for (std::string const& text: fixed) {
+            if (!parse_double(text)) {
+                return false;
+            }
+        }
+        std::mt19937_64 gen(17);
+        std::uniform_real_distribution<double> dist(0.0, 1e6);
+        char buffer[64];
+        for (int i(0); i != 10000; ++i) {
+            double value(dist(gen));
+            for (char const* format: { "%.3f", "%.17g", "%g", "%e" }) {
+                std::snprintf(buffer, sizeof(buffer), format, value);
+                if (!parse_double(buffer)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "parse_int signed char", []{ return parses_ints<signed char>(); } },
+    { "parse_int unsigned char", []{ return parses_ints<unsigned char>(); } },
+    { "parse_int short", []{ return parses_ints<short>(); } },
+    { "parse_int unsigned short", []{ return parses_ints<unsigned short>(); } },
+    { "parse_int int", []{ return parses_ints<int>(); } },
+    { "parse_int unsigned int", []{ return parses_ints<unsigned int>(); } },
+    { "parse_int long", []{ return parses_ints<long>(); } },
+    { "parse_int unsigned long", []{ return parses_ints<unsigned long>(); } },
+    { "parse_int round trip with format_int", []{
+            std::mt19937_64 gen(4711);
+            char buffer[CF::max_size<long>];
+            for (int i(0); i != 100000; ++i) {
+                long value(long(gen()) >> (gen() % 64u));
+                char* end(CF::format_int(buffer, value));
+                long got(0);
+                auto rc(CF::parse_int(buffer, end, got));
+                if (rc.ptr != end || rc.ec != std::errc() || got != value) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    },
+    { "parse_double", []{ return parses_doubles(); } },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
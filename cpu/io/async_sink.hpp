@@ -0,0 +1,413 @@
+// io/async_sink.hpp                                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_ASYNC_SINK
+#define INCLUDED_IO_ASYNC_SINK
+
+#include "cpu/io/file.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// An output sink overlapping the formatting with the write: the data is
+// copied into one of two buffers. When the current buffer is full its write
+// is submitted and the other buffer is used once its previous write has
+// completed. Thus, at most one write is in flight and the writes happen in
+// order at the current file position, i.e., the sink also works with pipes
+// and devices.
+//
+// The writes are submitted to an io_uring set up using the system calls
+// directly. If io_uring isn't available (it may be disabled or the kernel
+// too old to support IORING_OP_WRITE, which is probed when setting up the
+// ring) a thread doing the write(2) calls is used instead; uses_uring()
+// tells which one is used.
+
+namespace cpu {
+    namespace io {
+        class async_sink;
+
+        namespace detail {
+            class async_writer;
+            class uring_writer;
+            class thread_writer;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::detail::async_writer {
+public:
+    virtual ~async_writer() = default;
+    // starts writing the buffer which has to stay unchanged until wait()
+    virtual void submit(char const* data, std::size_t size) = 0;
+    // waits for the completion of a submitted write, if any
+    virtual void wait() = 0;
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::detail::uring_writer
+    : public cpu::io::detail::async_writer {
+private:
+    struct mapping {
+        void*       d_address{MAP_FAILED};
+        std::size_t d_size{};
+        mapping() = default;
+        mapping(int fd, std::size_t size, off_t offset)
+            : d_address(::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, fd, offset))
+            , d_size(size) {
+            if (this->d_address == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "mmap(io_uring)");
+            }
+        }
+        mapping(mapping&& other)
+            : d_address(std::exchange(other.d_address, MAP_FAILED))
+            , d_size(other.d_size) {
+        }
+        mapping& operator=(mapping&& other) {
+            std::swap(this->d_address, other.d_address);
+            std::swap(this->d_size, other.d_size);
+            return *this;
+        }
+        ~mapping() {
+            if (this->d_address != MAP_FAILED) {
+                ::munmap(this->d_address, this->d_size);
+            }
+        }
+        template <typename T>
+        T* at(std::size_t offset) const {
+            return reinterpret_cast<T*>(static_cast<char*>(this->d_address) + offset);
+        }
+    };
+
+    io_uring_params d_params{};
+    int             d_file;
+    int             d_ring;
+    mapping         d_sq;
+    mapping         d_cq;
+    mapping         d_sqes;
+    char const*     d_data{};
+    std::size_t     d_size{};
+
+    static int p_setup(io_uring_params* params) {
+        int rc(::syscall(__NR_io_uring_setup, 2, params));
+        if (rc < 0) {
+            throw std::system_error(errno, std::generic_category(), "io_uring_setup()");
+        }
+        return rc;
+    }
+    // Kernels before 5.6 set up a ring but reject IORING_OP_WRITE when it
+    // is submitted; they don't support probing either.
+    void p_probe() const {
+        constexpr unsigned ops{256u};
+        union {
+            io_uring_probe probe;
+            char           buffer[sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op)];
+        } u;
+        std::memset(&u, 0, sizeof(u));
+        if (::syscall(__NR_io_uring_register, this->d_ring, IORING_REGISTER_PROBE,
+                      &u.probe, ops) < 0) {
+            throw std::system_error(errno, std::generic_category(), "io_uring_register(probe)");
+        }
+        if (u.probe.ops_len <= IORING_OP_WRITE
+            || !(u.probe.ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED)) {
+            throw std::system_error(EOPNOTSUPP, std::generic_category(), "io_uring write");
+        }
+    }
+    void p_enter(unsigned submit, unsigned wait) {
+        while (::syscall(__NR_io_uring_enter, this->d_ring, submit, wait,
+                         wait? IORING_ENTER_GETEVENTS: 0u, nullptr, 0) < 0) {
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "io_uring_enter()");
+            }
+        }
+    }
+    void p_submit() {
+        io_uring_sqe* sqes(this->d_sqes.at<io_uring_sqe>(0u));
+        unsigned*     tail(this->d_sq.at<unsigned>(this->d_params.sq_off.tail));
+        unsigned      mask(*this->d_sq.at<unsigned>(this->d_params.sq_off.ring_mask));
+        unsigned      index(*tail & mask);
+
+        io_uring_sqe& sqe(sqes[index]);
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.fd     = this->d_file;
+        sqe.addr   = reinterpret_cast<std::uintptr_t>(this->d_data);
+        sqe.len    = unsigned(this->d_size);
+        sqe.off    = ~std::uint64_t(); // the current file position
+        this->d_sq.at<unsigned>(this->d_params.sq_off.array)[index] = index;
+        __atomic_store_n(tail, *tail + 1u, __ATOMIC_RELEASE);
+        this->p_enter(1u, 0u);
+    }
+
+public:
+    uring_writer(int file)
+        : d_file(file)
+        , d_ring(p_setup(&this->d_params)) {
+        try {
+            this->p_probe();
+            io_uring_params const& p(this->d_params);
+            std::size_t sq_size(p.sq_off.array + p.sq_entries * sizeof(unsigned));
+            std::size_t cq_size(p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe));
+            if (p.features & IORING_FEAT_SINGLE_MMAP) {
+                this->d_sq = mapping(this->d_ring, std::max(sq_size, cq_size), IORING_OFF_SQ_RING);
+            }
+            else {
+                this->d_sq = mapping(this->d_ring, sq_size, IORING_OFF_SQ_RING);
+                this->d_cq = mapping(this->d_ring, cq_size, IORING_OFF_CQ_RING);
+            }
+            this->d_sqes = mapping(this->d_ring, p.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+        }
+        catch (...) {
+            ::close(this->d_ring);
+            throw;
+        }
+    }
+    ~uring_writer() {
+        try {
+            this->wait();
+        }
+        catch (...) {
+        }
+        this->d_sqes = mapping();
+        this->d_cq   = mapping();
+        this->d_sq   = mapping();
+        ::close(this->d_ring);
+    }
+
+    void submit(char const* data, std::size_t size) override {
+        this->d_data = data;
+        this->d_size = size;
+        if (0u < size) {
+            this->p_submit();
+        }
+    }
+    // Short writes are resubmitted for the remaining data. A write which
+    // completes without writing anything can't make progress and is an
+    // error like a failing write(2).
+    void wait() override {
+        mapping const&  cq(this->d_cq.d_address == MAP_FAILED? this->d_sq: this->d_cq);
+        unsigned*       head(cq.at<unsigned>(this->d_params.cq_off.head));
+        unsigned const* tail(cq.at<unsigned>(this->d_params.cq_off.tail));
+        unsigned        mask(*cq.at<unsigned>(this->d_params.cq_off.ring_mask));
+        while (0u < this->d_size) {
+            if (*head == __atomic_load_n(tail, __ATOMIC_ACQUIRE)) {
+                this->p_enter(0u, 1u);
+                continue;
+            }
+            int res(cq.at<io_uring_cqe>(this->d_params.cq_off.cqes)[*head & mask].res);
+            __atomic_store_n(head, *head + 1u, __ATOMIC_RELEASE);
+            if (res < 0 && res != -EINTR && res != -EAGAIN) {
+                this->d_size = 0u;
+                throw std::system_error(-res, std::generic_category(), "io_uring write");
+            }
+            if (res == 0) {
+                this->d_size = 0u;
+                throw std::system_error(EIO, std::generic_category(), "io_uring write");
+            }
+            if (0 < res) {
+                this->d_data += res;
+                this->d_size -= res;
+            }
+            if (0u < this->d_size) {
+                this->p_submit();
+            }
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::detail::thread_writer
+    : public cpu::io::detail::async_writer {
+private:
+    file*                   d_file;
+    std::mutex              d_mutex;
+    std::condition_variable d_condition;
+    char const*             d_data{};
+    std::size_t             d_size{};
+    bool                    d_pending{false};
+    bool                    d_done{false};
+    std::exception_ptr      d_error;
+    std::thread             d_thread;
+
+    void p_run() {
+        std::unique_lock<std::mutex> lock(this->d_mutex);
+        while (true) {
+            this->d_condition.wait(lock, [this]{ return this->d_pending || this->d_done; });
+            if (!this->d_pending) {
+                return;
+            }
+            lock.unlock();
+            try {
+                this->d_file->write(this->d_data, this->d_size);
+            }
+            catch (...) {
+                this->d_error = std::current_exception();
+            }
+            lock.lock();
+            this->d_pending = false;
+            this->d_condition.notify_all();
+        }
+    }
+
+public:
+    explicit thread_writer(file& f)
+        : d_file(&f)
+        , d_thread([this]{ this->p_run(); }) {
+    }
+    ~thread_writer() {
+        {
+            std::lock_guard<std::mutex> lock(this->d_mutex);
+            this->d_done = true;
+        }
+        this->d_condition.notify_all();
+        this->d_thread.join();
+    }
+
+    void submit(char const* data, std::size_t size) override {
+        std::lock_guard<std::mutex> lock(this->d_mutex);
+        this->d_data    = data;
+        this->d_size    = size;
+        this->d_pending = true;
+        this->d_condition.notify_all();
+    }
+    void wait() override {
+        std::unique_lock<std::mutex> lock(this->d_mutex);
+        this->d_condition.wait(lock, [this]{ return !this->d_pending; });
+        if (this->d_error) {
+            std::rethrow_exception(std::exchange(this->d_error, nullptr));
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::async_sink {
+public:
+    enum class mode { automatic, uring, thread };
+
+private:
+    struct deleter {
+        void operator()(char* buffer) const { ::operator delete(buffer, std::align_val_t(4096)); }
+    };
+
+    file                                  d_file;
+    std::size_t                           d_size;
+    std::unique_ptr<char, deleter>        d_buffers[2];
+    int                                   d_current{};
+    char*                                 d_next;
+    bool                                  d_uring{};
+    std::unique_ptr<detail::async_writer> d_writer;
+
+    std::unique_ptr<detail::async_writer> p_writer(mode m) {
+        if (m != mode::thread) {
+            try {
+                auto rc(std::make_unique<detail::uring_writer>(this->d_file.get()));
+                this->d_uring = true;
+                return rc;
+            }
+            catch (std::system_error const&) {
+                if (m == mode::uring) {
+                    throw;
+                }
+            }
+        }
+        return std::make_unique<detail::thread_writer>(this->d_file);
+    }
+    char* p_buffer() const { return this->d_buffers[this->d_current].get(); }
+    // submits the current buffer and switches to the other one
+    void p_swap() {
+        this->d_writer->wait();
+        this->d_writer->submit(this->p_buffer(), this->d_next - this->p_buffer());
+        this->d_current = 1 - this->d_current;
+        this->d_next    = this->p_buffer();
+    }
+
+public:
+    static constexpr std::size_t default_size{1u << 20};
+
+    explicit async_sink(char const* name, std::size_t size = default_size,
+                        mode m = mode::automatic)
+        : d_file(name, O_WRONLY | O_CREAT | O_TRUNC)
+        , d_size(size)
+        , d_buffers{
+            std::unique_ptr<char, deleter>(static_cast<char*>(::operator new(size, std::align_val_t(4096)))),
+            std::unique_ptr<char, deleter>(static_cast<char*>(::operator new(size, std::align_val_t(4096))))
+          }
+        , d_next(d_buffers[0].get())
+        , d_writer(this->p_writer(m)) {
+    }
+    async_sink(async_sink const&) = delete;
+    void operator=(async_sink const&) = delete;
+    ~async_sink() {
+        try {
+            this->flush();
+        }
+        catch (...) {
+        }
+    }
+
+    bool uses_uring() const { return this->d_uring; }
+    void write(char const* data, std::size_t size) {
+        while (std::size_t(this->p_buffer() + this->d_size - this->d_next) < size) {
+            std::size_t n(this->p_buffer() + this->d_size - this->d_next);
+            std::memcpy(this->d_next, data, n);
+            this->d_next += n;
+            data += n;
+            size -= n;
+            this->p_swap();
+        }
+        std::memcpy(this->d_next, data, size);
+        this->d_next += size;
+    }
+    // writes the buffered data and waits for the completion of all writes
+    void flush() {
+        this->p_swap();
+        this->d_writer->wait();
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
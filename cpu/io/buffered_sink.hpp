@@ -0,0 +1,98 @@
+// io/buffered_sink.hpp                                               -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_BUFFERED_SINK
+#define INCLUDED_IO_BUFFERED_SINK
+
+#include "cpu/io/file.hpp"
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+
+// ----------------------------------------------------------------------------
+// An output sink copying the data into a large page-aligned buffer which is
+// written with one write(2) whenever it is full. Writes larger than the
+// buffer bypass it.
+
+namespace cpu {
+    namespace io {
+        class buffered_sink;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::buffered_sink {
+private:
+    struct deleter {
+        void operator()(char* buffer) const { ::operator delete(buffer, std::align_val_t(4096)); }
+    };
+
+    file                          d_file;
+    std::size_t                   d_size;
+    std::unique_ptr<char, deleter> d_buffer;
+    char*                         d_next;
+
+public:
+    static constexpr std::size_t default_size{1u << 20};
+
+    explicit buffered_sink(char const* name, std::size_t size = default_size)
+        : d_file(name, O_WRONLY | O_CREAT | O_TRUNC)
+        , d_size(size)
+        , d_buffer(static_cast<char*>(::operator new(size, std::align_val_t(4096))))
+        , d_next(d_buffer.get()) {
+    }
+    buffered_sink(buffered_sink const&) = delete;
+    void operator=(buffered_sink const&) = delete;
+    ~buffered_sink() {
+        try {
+            this->flush();
+        }
+        catch (...) {
+        }
+    }
+
+    void write(char const* data, std::size_t size) {
+        if (std::size_t(this->d_buffer.get() + this->d_size - this->d_next) < size) {
+            this->flush();
+            if (this->d_size <= size) {
+                this->d_file.write(data, size);
+                return;
+            }
+        }
+        std::memcpy(this->d_next, data, size);
+        this->d_next += size;
+    }
+    void flush() {
+        this->d_file.write(this->d_buffer.get(), this->d_next - this->d_buffer.get());
+        this->d_next = this->d_buffer.get();
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
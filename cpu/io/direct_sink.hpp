@@ -0,0 +1,130 @@
+// io/direct_sink.hpp                                                 -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_DIRECT_SINK
+#define INCLUDED_IO_DIRECT_SINK
+
+#include "cpu/io/file.hpp"
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// An output sink bypassing the page cache using O_DIRECT: the data is
+// collected in a block-aligned buffer whose whole blocks are written
+// directly. The final partial block is written after clearing O_DIRECT.
+// If the file can't be opened with O_DIRECT (e.g., on tmpfs or for
+// /dev/null) it is opened normally; direct() tells which one was used.
+
+namespace cpu {
+    namespace io {
+        class direct_sink;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::direct_sink {
+private:
+    static constexpr std::size_t block{4096u};
+    struct deleter {
+        void operator()(char* buffer) const { ::operator delete(buffer, std::align_val_t(block)); }
+    };
+
+    bool                           d_direct{true};
+    file                           d_file;
+    std::size_t                    d_size;
+    std::unique_ptr<char, deleter> d_buffer;
+    char*                          d_next;
+
+    file p_open(char const* name) {
+        try {
+            return file(name, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT);
+        }
+        catch (std::system_error const&) {
+            this->d_direct = false;
+            return file(name, O_WRONLY | O_CREAT | O_TRUNC);
+        }
+    }
+    // writes the whole blocks and moves the remainder to the front
+    void p_write_blocks() {
+        std::size_t used(this->d_next - this->d_buffer.get());
+        std::size_t whole(used / block * block);
+        this->d_file.write(this->d_buffer.get(), whole);
+        std::memmove(this->d_buffer.get(), this->d_buffer.get() + whole, used - whole);
+        this->d_next = this->d_buffer.get() + (used - whole);
+    }
+
+public:
+    static constexpr std::size_t default_size{4u << 20};
+
+    // the buffer size is rounded up to a multiple of the block size
+    explicit direct_sink(char const* name, std::size_t size = default_size)
+        : d_file(this->p_open(name))
+        , d_size((std::max(size, block) + block - 1u) / block * block)
+        , d_buffer(static_cast<char*>(::operator new(this->d_size, std::align_val_t(block))))
+        , d_next(d_buffer.get()) {
+    }
+    direct_sink(direct_sink const&) = delete;
+    void operator=(direct_sink const&) = delete;
+    ~direct_sink() {
+        try {
+            this->p_write_blocks();
+            if (this->d_direct) {
+                ::fcntl(this->d_file.get(), F_SETFL,
+                        ::fcntl(this->d_file.get(), F_GETFL) & ~O_DIRECT);
+            }
+            this->d_file.write(this->d_buffer.get(), this->d_next - this->d_buffer.get());
+        }
+        catch (...) {
+        }
+    }
+
+    bool direct() const { return this->d_direct; }
+    void write(char const* data, std::size_t size) {
+        while (std::size_t(this->d_buffer.get() + this->d_size - this->d_next) < size) {
+            std::size_t n(this->d_buffer.get() + this->d_size - this->d_next);
+            std::memcpy(this->d_next, data, n);
+            this->d_next += n;
+            data += n;
+            size -= n;
+            this->p_write_blocks();
+        }
+        std::memcpy(this->d_next, data, size);
+        this->d_next += size;
+    }
+    // Only whole blocks can be written directly, i.e., up to one block
+    // remains buffered.
+    void flush() { this->p_write_blocks(); }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
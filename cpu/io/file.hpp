@@ -0,0 +1,113 @@
+// io/file.hpp                                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_FILE
+#define INCLUDED_IO_FILE
+
+#include <string>
+#include <system_error>
+#include <utility>
+#include <cerrno>
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// A file descriptor closed on destruction and helpers for the output sinks:
+// failing system calls throw std::system_error and writes are retried until
+// all bytes are written.
+
+namespace cpu {
+    namespace io {
+        class file;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::file {
+private:
+    int d_fd;
+
+public:
+    file(char const* name, int flags, mode_t mode = 0666)
+        : d_fd(::open(name, flags, mode)) {
+        if (this->d_fd < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    std::string("open(\"") + name + "\")");
+        }
+    }
+    file(file&& other): d_fd(std::exchange(other.d_fd, -1)) {}
+    file& operator=(file&& other) {
+        std::swap(this->d_fd, other.d_fd);
+        return *this;
+    }
+    ~file() {
+        if (0 <= this->d_fd) {
+            ::close(this->d_fd);
+        }
+    }
+
+    int get() const { return this->d_fd; }
+
+    void write(char const* data, std::size_t size) {
+        while (0u < size) {
+            ssize_t rc(::write(this->d_fd, data, size));
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "write()");
+            }
+            data += rc;
+            size -= rc;
+        }
+    }
+    // Writes all buffers, possibly modifying the iovecs when the kernel
+    // accepted only part of the data.
+    void writev(iovec* it, int count) {
+        while (0 < count) {
+            ssize_t rc(::writev(this->d_fd, it, count));
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "writev()");
+            }
+            for (; 0 < count && std::size_t(rc) >= it->iov_len; ++it, --count) {
+                rc -= it->iov_len;
+            }
+            if (0 < count) {
+                it->iov_base = static_cast<char*>(it->iov_base) + rc;
+                it->iov_len -= rc;
+            }
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
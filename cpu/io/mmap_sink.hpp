@@ -0,0 +1,118 @@
+// io/mmap_sink.hpp                                                   -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_MMAP_SINK
+#define INCLUDED_IO_MMAP_SINK
+
+#include "cpu/io/file.hpp"
+#include <algorithm>
+#include <system_error>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// An output sink writing into a shared mapping of the file: the file is
+// grown with ftruncate(2) by a window of the file and the window is mapped.
+// When the window is full it is unmapped and the next window is added. On
+// destruction the file is truncated to the size actually written. This
+// sink only works with regular files.
+
+namespace cpu {
+    namespace io {
+        class mmap_sink;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::mmap_sink {
+private:
+    file        d_file;
+    std::size_t d_window;
+    off_t       d_offset{};    // file offset of the mapped window
+    char*       d_begin{};
+    char*       d_next{};
+    char*       d_end{};
+
+    void p_unmap() {
+        if (this->d_begin) {
+            ::munmap(this->d_begin, this->d_end - this->d_begin);
+            this->d_offset += this->d_end - this->d_begin;
+            this->d_begin = this->d_next = this->d_end = nullptr;
+        }
+    }
+    void p_map() {
+        this->p_unmap();
+        if (::ftruncate(this->d_file.get(), this->d_offset + this->d_window) < 0) {
+            throw std::system_error(errno, std::generic_category(), "ftruncate()");
+        }
+        void* rc(::mmap(nullptr, this->d_window, PROT_WRITE, MAP_SHARED,
+                        this->d_file.get(), this->d_offset));
+        if (rc == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap()");
+        }
+        this->d_begin = this->d_next = static_cast<char*>(rc);
+        this->d_end   = this->d_begin + this->d_window;
+    }
+
+public:
+    static constexpr std::size_t default_window{64u << 20};
+
+    // the window is rounded up to a multiple of the page size
+    explicit mmap_sink(char const* name, std::size_t window = default_window)
+        : d_file(name, O_RDWR | O_CREAT | O_TRUNC) {
+        std::size_t page(::sysconf(_SC_PAGESIZE));
+        this->d_window = (std::max(window, page) + page - 1u) / page * page;
+        this->p_map();
+    }
+    mmap_sink(mmap_sink const&) = delete;
+    void operator=(mmap_sink const&) = delete;
+    ~mmap_sink() {
+        off_t size(this->d_offset + (this->d_next - this->d_begin));
+        this->p_unmap();
+        ::ftruncate(this->d_file.get(), size);
+    }
+
+    void write(char const* data, std::size_t size) {
+        while (std::size_t(this->d_end - this->d_next) < size) {
+            std::size_t n(this->d_end - this->d_next);
+            std::memcpy(this->d_next, data, n);
+            data += n;
+            size -= n;
+            this->p_map();
+        }
+        std::memcpy(this->d_next, data, size);
+        this->d_next += size;
+    }
+    void flush() {}
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,199 @@
+// io/sink.t.cpp                                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "async_sink.hpp"
+#include "buffered_sink.hpp"
+#include "direct_sink.hpp"
+#include "mmap_sink.hpp"
+#include "writev_sink.hpp"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+namespace IO = cpu::io;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    std::string temp_name() {
+        return "/tmp/cputube-sink-" + std::to_string(::getpid());
+    }
+    std::string read_file(std::string const& name) {
+        std::ifstream in(name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Writes lines of varying length and some chunks larger than the
+    // buffers to the sink and checks that the file has the same content.
+    // The lines are kept alive until the sink is destroyed as writev_sink
+    // doesn't copy them.
+    template <typename Sink, typename... Args>
+    bool writes_everything(Args... args) {
+        std::string const name(temp_name());
+        std::vector<std::string> lines;
+        std::string expect;
+        for (int i(0); i != 20000; ++i) {
+            lines.push_back(std::string(i % 97, char('a' + i % 26)) + std::to_string(i) + "\n");
+            if (i % 5000 == 4999) {
+                lines.push_back(std::string(20000 + i, 'x'));
+            }
+        }
+        {
+            Sink sink(name.c_str(), args...);
+            for (std::string const& line: lines) {
+                sink.write(line.data(), line.size());
+                expect += line;
+            }
+            sink.flush();
+            std::string const tail("tail");
+            sink.write(tail.data(), tail.size());
+            expect += tail;
+            sink.flush();
+        }
+        bool rc(read_file(name) == expect);
+        std::remove(name.c_str());
+        return rc;
+    }
+
+    template <typename Sink, typename... Args>
+    bool writes_nothing(Args... args) {
+        std::string const name(temp_name());
+        std::fstream(name, std::ios::out) << "old content";
+        {
+            Sink sink(name.c_str(), args...);
+        }
+        bool rc(read_file(name).empty());
+        std::remove(name.c_str());
+        return rc;
+    }
+
+    template <typename Sink>
+    bool throws_on_open_failure() {
+        try {
+            Sink sink("/no/such/directory/file");
+            return false;
+        }
+        catch (std::system_error const&) {
+            return true;
+        }
+    }
+
+    // Writing to /dev/full fails: the error of the final flush must not
+    // escape the destructor (which would terminate the program).
+    template <typename Sink>
+    bool survives_failed_flush() {
+        static char const text[] = "some text";
+        try {
+            Sink sink("/dev/full");
+            sink.write(text, sizeof(text) - 1u);
+        }
+        catch (std::system_error const&) {
+            return false;
+        }
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "async_sink writes everything", []{ return writes_everything<IO::async_sink>(); } },
+    { "async_sink with small buffer", []{ return writes_everything<IO::async_sink>(std::size_t(100u)); } },
+    { "async_sink using a thread", []{
+            return writes_everything<IO::async_sink>(std::size_t(1000u), IO::async_sink::mode::thread);
+        }
+    },
+    { "async_sink using io_uring", []{
+            try {
+                IO::async_sink sink("/dev/null", 16u, IO::async_sink::mode::uring);
+            }
+            catch (std::system_error const&) {
+                std::cout << "(io_uring not available) ";
+                return true;
+            }
+            return writes_everything<IO::async_sink>(std::size_t(1000u), IO::async_sink::mode::uring);
+        }
+    },
+    { "async_sink writes nothing", []{ return writes_nothing<IO::async_sink>(); } },
+    { "async_sink open failure", []{ return throws_on_open_failure<IO::async_sink>(); } },
+    { "async_sink failed final flush", []{ return survives_failed_flush<IO::async_sink>(); } },
+    { "buffered_sink writes everything", []{ return writes_everything<IO::buffered_sink>(); } },
+    { "buffered_sink with small buffer", []{ return writes_everything<IO::buffered_sink>(std::size_t(100u)); } },
+    { "buffered_sink writes nothing", []{ return writes_nothing<IO::buffered_sink>(); } },
+    { "buffered_sink open failure", []{ return throws_on_open_failure<IO::buffered_sink>(); } },
+    { "buffered_sink failed final flush", []{ return survives_failed_flush<IO::buffered_sink>(); } },
+    { "writev_sink writes everything", []{ return writes_everything<IO::writev_sink>(); } },
+    { "writev_sink with small capacity", []{ return writes_everything<IO::writev_sink>(3); } },
+    { "writev_sink writes nothing", []{ return writes_nothing<IO::writev_sink>(); } },
+    { "writev_sink open failure", []{ return throws_on_open_failure<IO::writev_sink>(); } },
+    { "writev_sink failed final flush", []{ return survives_failed_flush<IO::writev_sink>(); } },
+    { "mmap_sink writes everything", []{ return writes_everything<IO::mmap_sink>(); } },
+    { "mmap_sink with small window", []{ return writes_everything<IO::mmap_sink>(std::size_t(1u)); } },
+    { "mmap_sink writes nothing", []{ return writes_nothing<IO::mmap_sink>(); } },
+    { "mmap_sink open failure", []{ return throws_on_open_failure<IO::mmap_sink>(); } },
+    { "direct_sink writes everything", []{ return writes_everything<IO::direct_sink>(); } },
+    { "direct_sink with small buffer", []{ return writes_everything<IO::direct_sink>(std::size_t(1u)); } },
+    { "direct_sink writes nothing", []{ return writes_nothing<IO::direct_sink>(); } },
+    { "direct_sink open failure", []{ return throws_on_open_failure<IO::direct_sink>(); } },
+    { "direct_sink failed final flush", []{ return survives_failed_flush<IO::direct_sink>(); } },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,89 @@
+// io/writev_sink.hpp                                                 -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_IO_WRITEV_SINK
+#define INCLUDED_IO_WRITEV_SINK
+
+#include "cpu/io/file.hpp"
+#include <vector>
+#include <climits>
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/uio.h>
+
+// ----------------------------------------------------------------------------
+// An output sink which doesn't copy the data: write() only records the
+// buffer and up to capacity() buffers are written with one writev(2). The
+// data passed to write() has to stay unchanged until it is written, i.e.,
+// until the capacity()th call to write() since the last flush or until the
+// next explicit flush().
+
+namespace cpu {
+    namespace io {
+        class writev_sink;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::io::writev_sink {
+private:
+    file               d_file;
+    std::vector<iovec> d_iovecs;
+    int                d_count{};
+
+public:
+    static constexpr int default_capacity{IOV_MAX};
+
+    explicit writev_sink(char const* name, int capacity = default_capacity)
+        : d_file(name, O_WRONLY | O_CREAT | O_TRUNC)
+        , d_iovecs(capacity < IOV_MAX? capacity: IOV_MAX) {
+    }
+    writev_sink(writev_sink const&) = delete;
+    void operator=(writev_sink const&) = delete;
+    ~writev_sink() {
+        try {
+            this->flush();
+        }
+        catch (...) {
+        }
+    }
+
+    int capacity() const { return int(this->d_iovecs.size()); }
+    void write(char const* data, std::size_t size) {
+        this->d_iovecs[this->d_count++] = iovec{const_cast<char*>(data), size};
+        if (this->d_count == this->capacity()) {
+            this->flush();
+        }
+    }
+    void flush() {
+        this->d_file.writev(this->d_iovecs.data(), this->d_count);
+        this->d_count = 0;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,106 @@
+// cpu/memory/allocation_policy.hpp                                   -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_ALLOCATION_POLICY
+#define INCLUDED_MEMORY_ALLOCATION_POLICY
+
+#include "cpu/memory/allocator.hpp"
+#include "cpu/memory/monotonic_arena.hpp"
+#include "cpu/memory/pool_resource.hpp"
+#include "cpu/memory/thread_local_resource.hpp"
+#include <memory>
+#include <memory_resource>
+
+// ----------------------------------------------------------------------------
+// The allocator dimension of the benchmarks: a policy provides allocators
+// for any type T and the release of all memory when the objects using the
+// allocators were destroyed:
+//
+//     template <typename T> using allocator_type = ...;
+//     template <typename T> allocator_type<T> allocator() const;
+//     void release() const;
+//
+// Copies of a policy share the resource. for_each_allocation_policy() calls
+// a function with the name and an object of each policy except the default
+// std::allocator which the benchmarks measure anyway.
+
+namespace cpu {
+    namespace memory {
+        template <typename Resource>
+        class resource_policy;
+        template <typename Resource>
+        class pmr_policy;
+
+        template <typename Fun>
+        void for_each_allocation_policy(Fun fun);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Resource>
+class cpu::memory::resource_policy {
+private:
+    std::shared_ptr<Resource> d_resource{std::make_shared<Resource>()};
+
+public:
+    template <typename T>
+    using allocator_type = resource_allocator<T, Resource>;
+
+    template <typename T>
+    allocator_type<T> allocator() const { return allocator_type<T>(this->d_resource.get()); }
+    void release() const { this->d_resource->release(); }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename Resource>
+class cpu::memory::pmr_policy {
+private:
+    std::shared_ptr<Resource> d_resource{std::make_shared<Resource>()};
+
+public:
+    template <typename T>
+    using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+    template <typename T>
+    allocator_type<T> allocator() const { return allocator_type<T>(this->d_resource.get()); }
+    void release() const { this->d_resource->release(); }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename Fun>
+void cpu::memory::for_each_allocation_policy(Fun fun) {
+    fun("monotonic_arena", resource_policy<monotonic_arena>());
+    fun("pool_resource", resource_policy<pool_resource>());
+    fun("thread_local_resource", resource_policy<thread_local_resource>());
+    fun("pmr(pool_resource)", pmr_policy<pmr_resource<pool_resource>>());
+    fun("pmr::unsynchronized_pool", pmr_policy<std::pmr::unsynchronized_pool_resource>());
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
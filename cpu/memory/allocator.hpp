@@ -0,0 +1,129 @@
+// cpu/memory/allocator.hpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_ALLOCATOR
+#define INCLUDED_MEMORY_ALLOCATOR
+
+#include <memory_resource>
+#include <utility>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// Adapters for the resources of cpu/memory, i.e., classes with members
+//
+//     void* allocate(std::size_t size, std::size_t alignment);
+//     void  deallocate(void* ptr, std::size_t size, std::size_t alignment);
+//
+// - resource_allocator<T, Resource> is a standard allocator referring to a
+//   resource. The calls to the resource are not virtual, i.e., they can be
+//   inlined.
+// - pmr_resource<Resource> is a std::pmr::memory_resource holding a
+//   resource, e.g., to be used with a std::pmr::polymorphic_allocator.
+
+namespace cpu {
+    namespace memory {
+        template <typename T, typename Resource>
+        class resource_allocator;
+        template <typename T0, typename T1, typename Resource>
+        bool operator== (resource_allocator<T0, Resource> const&,
+                         resource_allocator<T1, Resource> const&);
+        template <typename T0, typename T1, typename Resource>
+        bool operator!= (resource_allocator<T0, Resource> const&,
+                         resource_allocator<T1, Resource> const&);
+
+        template <typename Resource>
+        class pmr_resource;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename Resource>
+class cpu::memory::resource_allocator {
+private:
+    Resource* d_resource;
+
+public:
+    using value_type = T;
+    template <typename U>
+    struct rebind { using other = resource_allocator<U, Resource>; };
+
+    explicit resource_allocator(Resource* resource): d_resource(resource) {}
+    template <typename U>
+    resource_allocator(resource_allocator<U, Resource> const& other)
+        : d_resource(other.resource()) {
+    }
+
+    Resource* resource() const { return this->d_resource; }
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(this->d_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* ptr, std::size_t n) {
+        this->d_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+};
+
+template <typename T0, typename T1, typename Resource>
+bool cpu::memory::operator== (resource_allocator<T0, Resource> const& a0,
+                              resource_allocator<T1, Resource> const& a1) {
+    return a0.resource() == a1.resource();
+}
+
+template <typename T0, typename T1, typename Resource>
+bool cpu::memory::operator!= (resource_allocator<T0, Resource> const& a0,
+                              resource_allocator<T1, Resource> const& a1) {
+    return !(a0 == a1);
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Resource>
+class cpu::memory::pmr_resource
+    : public std::pmr::memory_resource {
+private:
+    Resource d_resource;
+
+    void* do_allocate(std::size_t size, std::size_t alignment) override {
+        return this->d_resource.allocate(size, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t size, std::size_t alignment) override {
+        this->d_resource.deallocate(ptr, size, alignment);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    template <typename... Args>
+    explicit pmr_resource(Args&&... args): d_resource(std::forward<Args>(args)...) {}
+
+    Resource& resource() { return this->d_resource; }
+    void      release() { this->d_resource.release(); }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
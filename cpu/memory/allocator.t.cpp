@@ -0,0 +1,155 @@
+// cpu/memory/allocator.t.cpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "allocator.hpp"
+#include "cpu/memory/allocation_policy.hpp"
+#include <iostream>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct counting_resource {
+        int allocations{0};
+        int deallocations{0};
+        void* allocate(std::size_t size, std::size_t) {
+            ++this->allocations;
+            return ::operator new(size);
+        }
+        void deallocate(void* ptr, std::size_t, std::size_t) {
+            ++this->deallocations;
+            ::operator delete(ptr);
+        }
+        void release() {}
+    };
+
+    template <typename Policy>
+    bool use_containers(Policy policy) {
+        bool success(true);
+        {
+            std::list<int, typename Policy::template allocator_type<int>>
+                list(policy.template allocator<int>());
+            std::set<int, std::less<int>, typename Policy::template allocator_type<int>>
+                set(policy.template allocator<int>());
+            for (int i(0); i != 1000; ++i) {
+                list.push_back(i);
+                set.insert(999 - i);
+            }
+            std::shared_ptr<std::string> ptr(std::allocate_shared<std::string>(
+                policy.template allocator<std::string>(), "hello"));
+            success = list.size() == 1000u && set.size() == 1000u
+                && *set.begin() == 0 && list.back() == 999 && *ptr == "hello";
+        }
+        policy.release();
+        return success;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "resource_allocator", []{
+            counting_resource resource;
+            {
+                using allocator = CM::resource_allocator<int, counting_resource>;
+                std::vector<int, allocator> vector{allocator(&resource)};
+                std::list<int, allocator>   list{allocator(&resource)};
+                for (int i(0); i != 10; ++i) {
+                    vector.push_back(i);
+                    list.push_back(i);
+                }
+                CM::resource_allocator<double, counting_resource> other(list.get_allocator());
+                if (other != vector.get_allocator() || other.resource() != &resource) {
+                    return false;
+                }
+            }
+            return 10 < resource.allocations && resource.allocations == resource.deallocations;
+        }
+    },
+    { "pmr_resource", []{
+            CM::pmr_resource<counting_resource> resource;
+            {
+                std::pmr::vector<int> vector(&resource);
+                for (int i(0); i != 10; ++i) {
+                    vector.push_back(i);
+                }
+            }
+            return 0 < resource.resource().allocations
+                && resource.resource().allocations == resource.resource().deallocations
+                && resource.is_equal(resource);
+        }
+    },
+    { "allocation policies", []{
+            bool success(true);
+            int  count(0);
+            CM::for_each_allocation_policy([&](char const*, auto policy){
+                    ++count;
+                    success = success && use_containers(policy) && use_containers(policy);
+                });
+            return success && count == 5;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
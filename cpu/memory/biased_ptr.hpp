@@ -0,0 +1,282 @@
+// cpu/memory/biased_ptr.hpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_BIASED_PTR
+#define INCLUDED_MEMORY_BIASED_PTR
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// A shared pointer using biased reference counting: the object is owned by
+// the thread creating it which counts its references using a plain integer
+// while the other threads use an atomic count. The total number of
+// references is the sum of both counts:
+//
+// - When the owner's count drops to zero the owner merges the counts: the
+//   atomic count gets a merged flag and from then on all threads use the
+//   atomic count. The object is destroyed when the merged count is zero.
+// - References created by the owner may be released by other threads,
+//   i.e., the atomic count can become negative although the owner doesn't
+//   hold any reference anymore. The thread making the atomic count negative
+//   queues the object with the owner which merges the counts of the queued
+//   objects in biased_collect() or when the owner thread exits, i.e., the
+//   destruction of these objects is deferred. If the owner thread has
+//   already exited the releasing thread merges the counts itself.
+//
+// Each thread using biased_ptr allocates a small owner record which is
+// never released as objects may still refer to it.
+
+namespace cpu {
+    namespace memory {
+        template <typename T>
+        class biased_ptr;
+
+        template <typename T, typename... Args>
+        biased_ptr<T> make_biased(Args&&... args);
+
+        // merges the objects queued with the calling thread
+        void biased_collect();
+
+        namespace detail {
+            struct biased_block;
+            struct biased_owner;
+            biased_owner* biased_local_owner();
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// The atomic count holds the number of references times `one` and the
+// flags `merged` and `queued`. The counts and flags are changed together
+// to decide without a race which thread destroys the object: a queued
+// object is destroyed when the queue is processed, otherwise by the thread
+// observing a merged count of zero.
+
+struct cpu::memory::detail::biased_block {
+    static constexpr long merged{1};
+    static constexpr long queued{2};
+    static constexpr long one{4};
+    static long count(long value) { return value >> 2; }
+
+    biased_owner*     owner;
+    long              biased{1};        // used by the owner until merged
+    bool              is_merged{false}; // used by the owner
+    std::atomic<long> shared{0};
+    void            (*destroy)(biased_block*);
+
+    explicit biased_block(void (*d)(biased_block*))
+        : owner(biased_local_owner()), destroy(d) {
+    }
+
+    // returns the merged atomic value: once the merge is visible another
+    // thread may destroy the block, i.e., the block isn't touched afterwards
+    long p_merge() {
+        long const add(this->biased * one + merged);
+        this->biased    = 0;
+        this->is_merged = true;
+        return this->shared.fetch_add(add, std::memory_order_acq_rel) + add;
+    }
+
+    void increment() {
+        if (this->owner == biased_local_owner() && !this->is_merged) {
+            ++this->biased;
+        }
+        else {
+            this->shared.fetch_add(one, std::memory_order_relaxed);
+        }
+    }
+    void decrement();
+    // called for a queued block by the owner or after the owner exited
+    void process_queued() {
+        if (!this->is_merged) {
+            this->p_merge();
+        }
+        long old(this->shared.fetch_and(~queued, std::memory_order_acq_rel));
+        if (count(old) == 0) {
+            this->destroy(this);
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+struct cpu::memory::detail::biased_owner {
+    std::mutex                 lock;
+    bool                       alive{true};
+    std::vector<biased_block*> queue;
+    std::atomic<bool>          pending{false};
+
+    void enqueue(biased_block* block) {
+        std::lock_guard<std::mutex> kerberos(this->lock);
+        if (this->alive) {
+            this->queue.push_back(block);
+            this->pending.store(true, std::memory_order_release);
+        }
+        else {
+            block->process_queued();
+        }
+    }
+    void collect(bool exiting = false) {
+        std::vector<biased_block*> blocks;
+        {
+            std::lock_guard<std::mutex> kerberos(this->lock);
+            this->alive = !exiting;
+            this->pending.store(false, std::memory_order_relaxed);
+            blocks.swap(this->queue);
+            if (exiting) {
+                // later enqueue()s process the blocks themselves
+                for (biased_block* block: blocks) {
+                    block->process_queued();
+                }
+                return;
+            }
+        }
+        for (biased_block* block: blocks) {
+            block->process_queued();
+        }
+    }
+};
+
+namespace cpu {
+    namespace memory {
+        namespace detail {
+            inline thread_local biased_owner* t_biased_owner{nullptr};
+
+            struct biased_exit {
+                biased_owner* owner;
+                ~biased_exit() { this->owner->collect(true); }
+            };
+
+            inline biased_owner* biased_register_owner() {
+                static thread_local biased_exit exit{new biased_owner};
+                return t_biased_owner = exit.owner;
+            }
+            inline biased_owner* biased_local_owner() {
+                return t_biased_owner? t_biased_owner: biased_register_owner();
+            }
+        }
+    }
+}
+
+inline void
+cpu::memory::detail::biased_block::decrement() {
+    if (this->owner == biased_local_owner() && !this->is_merged) {
+        if (--this->biased == 0) {
+            long value(this->p_merge());
+            // the merge added the flag; a zero count without the queued flag
+            // can't change anymore as there is no reference left
+            if (count(value) == 0 && !(value & queued)) {
+                this->destroy(this);
+            }
+        }
+        return;
+    }
+    long old(this->shared.load(std::memory_order_relaxed));
+    long value;
+    do {
+        value = old - one;
+        if (!(old & merged) && count(value) < 0) {
+            value |= queued;
+        }
+    }
+    while (!this->shared.compare_exchange_weak(old, value, std::memory_order_acq_rel,
+                                               std::memory_order_relaxed));
+    if (old & merged) {
+        if (count(value) == 0 && !(value & queued)) {
+            this->destroy(this);
+        }
+    }
+    else if ((value & queued) && !(old & queued)) {
+        this->owner->enqueue(this);
+    }
+}
+
+inline void
+cpu::memory::biased_collect() {
+    detail::biased_owner* owner(detail::biased_local_owner());
+    if (owner->pending.load(std::memory_order_acquire)) {
+        owner->collect();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+class cpu::memory::biased_ptr {
+private:
+    struct rep
+        : detail::biased_block {
+        T value;
+        template <typename... Args>
+        explicit rep(Args&&... args)
+            : detail::biased_block([](detail::biased_block* b){ delete static_cast<rep*>(b); })
+            , value(std::forward<Args>(args)...) {
+        }
+    };
+    rep* d_rep;
+
+    explicit biased_ptr(rep* r): d_rep(r) {}
+    template <typename S, typename... Args>
+    friend biased_ptr<S> make_biased(Args&&...);
+
+public:
+    biased_ptr(): d_rep(nullptr) {}
+    biased_ptr(biased_ptr const& other): d_rep(other.d_rep) {
+        if (this->d_rep) {
+            this->d_rep->increment();
+        }
+    }
+    biased_ptr(biased_ptr&& other): d_rep(std::exchange(other.d_rep, nullptr)) {}
+    biased_ptr& operator=(biased_ptr other) { this->swap(other); return *this; }
+    ~biased_ptr() {
+        if (this->d_rep) {
+            this->d_rep->decrement();
+        }
+    }
+
+    void swap(biased_ptr& other) { std::swap(this->d_rep, other.d_rep); }
+    void reset() { biased_ptr().swap(*this); }
+
+    T*   get() const { return this->d_rep? &this->d_rep->value: nullptr; }
+    T&   operator*() const { return this->d_rep->value; }
+    T*   operator->() const { return &this->d_rep->value; }
+    explicit operator bool() const { return this->d_rep != nullptr; }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename... Args>
+cpu::memory::biased_ptr<T>
+cpu::memory::make_biased(Args&&... args) {
+    using rep = typename biased_ptr<T>::rep;
+    return biased_ptr<T>(new rep(std::forward<Args>(args)...));
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,201 @@
+// cpu/memory/biased_ptr.t.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "biased_ptr.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    std::atomic<int> live{0};
+
+    struct object {
+        int value;
+        explicit object(int value): value(value) { ++live; }
+        ~object() { --live; }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "owner only", []{
+            bool success(true);
+            {
+                auto p0(CM::make_biased<object>(17));
+                CM::biased_ptr<object> p1;
+                success = success && live == 1 && p0->value == 17 && !p1;
+                p1 = p0;
+                CM::biased_ptr<object> p2(std::move(p1));
+                success = success && !p1 && p2.get() == p0.get();
+                p0.reset();
+                success = success && live == 1;
+            }
+            return success && live == 0;
+        }
+    },
+    { "released by another thread", []{
+            // the other thread makes the shared count negative: the object is
+            // queued with the owner and only destroyed by biased_collect()
+            std::vector<CM::biased_ptr<object>> ptrs;
+            for (int i(0); i != 100; ++i) {
+                ptrs.push_back(CM::make_biased<object>(i));
+            }
+            std::thread([&]{ ptrs.clear(); }).join();
+            bool queued(live == 100);
+            CM::biased_collect();
+            return queued && live == 0;
+        }
+    },
+    { "copies shared with another thread", []{
+            auto ptr(CM::make_biased<object>(0));
+            std::vector<CM::biased_ptr<object>> copies(1000, ptr);
+            long sum(0);
+            std::thread t([copies, &sum]()mutable{
+                    for (int i(0); i != 100; ++i) {
+                        std::vector<CM::biased_ptr<object>>(copies).swap(copies);
+                    }
+                    for (auto const& p: copies) {
+                        sum += p->value + 1;
+                    }
+                });
+            for (int i(0); i != 100; ++i) {
+                std::vector<CM::biased_ptr<object>>(copies).swap(copies);
+            }
+            t.join();
+            copies.clear();
+            bool alive(live == 1);
+            ptr.reset();
+            CM::biased_collect();
+            return sum == 1000 && alive && live == 0;
+        }
+    },
+    { "merged by the owner", []{
+            // the owner releases its references first: the other thread
+            // destroys the object when releasing the last reference
+            auto ptr(CM::make_biased<object>(0));
+            std::atomic<int> state{0};
+            std::thread t([&]{
+                    CM::biased_ptr<object> copy(ptr); // uses the shared count
+                    state = 1;
+                    while (state != 2) {
+                        std::this_thread::yield();
+                    }
+                    copy.reset();
+                });
+            while (state != 1) {
+                std::this_thread::yield();
+            }
+            ptr.reset(); // merges the counts
+            bool alive(live == 1);
+            state = 2;
+            t.join();
+            return alive && live == 0;
+        }
+    },
+    { "concurrent release", []{
+            // the owner and other threads release their references at the
+            // same time: the owner's merge races with the other releases
+            bool success(true);
+            for (int round(0); round != 2000 && success; ++round) {
+                auto ptr(CM::make_biased<object>(round));
+                std::atomic<int>  ready{0};
+                std::atomic<bool> go{false};
+                std::vector<std::thread> threads;
+                for (int i(0); i != 3; ++i) {
+                    threads.emplace_back([&]{
+                            CM::biased_ptr<object> copy(ptr);
+                            ++ready;
+                            while (!go) {
+                            }
+                            copy.reset();
+                        });
+                }
+                while (ready != 3) {
+                    std::this_thread::yield();
+                }
+                go = true;
+                ptr.reset();
+                for (auto& thread: threads) {
+                    thread.join();
+                }
+                CM::biased_collect();
+                success = live == 0;
+            }
+            return success;
+        }
+    },
+    { "owner exits", []{
+            std::vector<CM::biased_ptr<object>> ptrs;
+            std::thread([&]{
+                    for (int i(0); i != 100; ++i) {
+                        ptrs.push_back(CM::make_biased<object>(i));
+                    }
+                }).join();
+            bool alive(live == 100);
+            ptrs.clear(); // the owner is gone: the counts are merged directly
+            return alive && live == 0;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,111 @@
+// cpu/memory/counted_ptr.hpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_COUNTED_PTR
+#define INCLUDED_MEMORY_COUNTED_PTR
+
+#include "cpu/memory/ref_count.hpp"
+#include <utility>
+
+// ----------------------------------------------------------------------------
+// A shared pointer with the reference count of type Count (see
+// ref_count.hpp) allocated together with the object by make_counted().
+// Unlike std::shared_ptr there is no type-erased deleter, no weak count,
+// and no aliasing, i.e., the object is always destroyed by the last
+// pointer:
+//
+// - local_ptr<T> uses an unsynchronized_count and can only be used by one
+//   thread at a time.
+// - shared_counted_ptr<T> uses an atomic_count.
+
+namespace cpu {
+    namespace memory {
+        template <typename T, typename Count>
+        class counted_ptr;
+
+        template <typename T>
+        using local_ptr = counted_ptr<T, unsynchronized_count>;
+        template <typename T>
+        using shared_counted_ptr = counted_ptr<T, atomic_count>;
+
+        template <typename T, typename Count, typename... Args>
+        counted_ptr<T, Count> make_counted(Args&&... args);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename Count>
+class cpu::memory::counted_ptr {
+private:
+    struct rep {
+        Count count;
+        T     value;
+        template <typename... Args>
+        explicit rep(Args&&... args): count(), value(std::forward<Args>(args)...) {}
+    };
+    rep* d_rep;
+
+    explicit counted_ptr(rep* r): d_rep(r) {}
+    template <typename S, typename C, typename... Args>
+    friend counted_ptr<S, C> make_counted(Args&&...);
+
+public:
+    counted_ptr(): d_rep(nullptr) {}
+    counted_ptr(counted_ptr const& other): d_rep(other.d_rep) {
+        if (this->d_rep) {
+            this->d_rep->count.increment();
+        }
+    }
+    counted_ptr(counted_ptr&& other): d_rep(std::exchange(other.d_rep, nullptr)) {}
+    counted_ptr& operator=(counted_ptr other) { this->swap(other); return *this; }
+    ~counted_ptr() {
+        if (this->d_rep && this->d_rep->count.decrement()) {
+            delete this->d_rep;
+        }
+    }
+
+    void swap(counted_ptr& other) { std::swap(this->d_rep, other.d_rep); }
+    void reset() { counted_ptr().swap(*this); }
+
+    T*   get() const { return this->d_rep? &this->d_rep->value: nullptr; }
+    T&   operator*() const { return this->d_rep->value; }
+    T*   operator->() const { return &this->d_rep->value; }
+    long use_count() const { return this->d_rep? this->d_rep->count.count(): 0; }
+    explicit operator bool() const { return this->d_rep != nullptr; }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename Count, typename... Args>
+cpu::memory::counted_ptr<T, Count>
+cpu::memory::make_counted(Args&&... args) {
+    using rep = typename counted_ptr<T, Count>::rep;
+    return counted_ptr<T, Count>(new rep(std::forward<Args>(args)...));
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,224 @@
+// cpu/memory/huge_page_allocator.hpp                                 -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_HUGE_PAGE_ALLOCATOR
+#define INCLUDED_MEMORY_HUGE_PAGE_ALLOCATOR
+
+#include <atomic>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// An allocator backing large buffers by huge pages to reduce the TLB
+// misses when accessing them. The mode determines how huge pages are used:
+//
+// - off:         the memory is obtained using operator new
+// - transparent: the memory is mapped aligned to the huge page size and
+//                madvise(MADV_HUGEPAGE) asks the kernel to use transparent
+//                huge pages
+// - hugetlb:     the memory is mapped with MAP_HUGETLB from the reserved
+//                huge pages (see /proc/sys/vm/nr_hugepages); if there are
+//                not enough reserved pages the transparent mode is used
+//
+// Allocations smaller than a huge page always use operator new, as do
+// systems other than Linux. An allocator uses the mode passed on
+// construction or the default mode at the time it was constructed. The
+// default mode is off and can be changed using set_default_huge_pages(),
+// e.g., cpu::tube::context sets it from the environment variable
+// CPUTUBE_HUGE_PAGES.
+
+namespace cpu {
+    namespace memory {
+        enum class huge_pages { off, transparent, hugetlb };
+        constexpr std::size_t huge_page_size{std::size_t(2u) << 20};
+
+        char const* to_string(huge_pages mode);
+        huge_pages  parse_huge_pages(std::string const& text);
+        huge_pages  default_huge_pages();
+        void        set_default_huge_pages(huge_pages mode);
+
+        void* allocate_huge(std::size_t bytes, huge_pages mode);
+        void  deallocate_huge(void* ptr, std::size_t bytes, huge_pages mode);
+
+        template <typename T>
+        class huge_page_allocator;
+        // a vector using huge pages as configured by the default mode, e.g.,
+        // for the benchmark data (see CPUTUBE_HUGE_PAGES)
+        template <typename T>
+        using huge_page_vector = std::vector<T, huge_page_allocator<T>>;
+
+        namespace detail {
+            inline std::atomic<huge_pages> default_huge_pages{huge_pages::off};
+
+            constexpr bool mapped(std::size_t bytes, huge_pages mode) {
+#if defined(__linux__)
+                return mode != huge_pages::off && huge_page_size <= bytes;
+#else
+                return (void)bytes, (void)mode, false;
+#endif
+            }
+            constexpr std::size_t round_up(std::size_t bytes) {
+                return (bytes + huge_page_size - 1u) & ~(huge_page_size - 1u);
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline char const*
+cpu::memory::to_string(huge_pages mode) {
+    switch (mode) {
+    case huge_pages::off:         return "off";
+    case huge_pages::transparent: return "transparent";
+    case huge_pages::hugetlb:     return "hugetlb";
+    }
+    return "unknown";
+}
+
+inline cpu::memory::huge_pages
+cpu::memory::parse_huge_pages(std::string const& text) {
+    if (text.empty() || text == "0" || text == "off") {
+        return huge_pages::off;
+    }
+    if (text == "1" || text == "transparent" || text == "thp") {
+        return huge_pages::transparent;
+    }
+    if (text == "hugetlb") {
+        return huge_pages::hugetlb;
+    }
+    throw std::invalid_argument("unknown huge page mode '" + text
+                                + "' (expected off, transparent, or hugetlb)");
+}
+
+inline cpu::memory::huge_pages
+cpu::memory::default_huge_pages() {
+    return detail::default_huge_pages.load(std::memory_order_relaxed);
+}
+
+inline void
+cpu::memory::set_default_huge_pages(huge_pages mode) {
+    detail::default_huge_pages.store(mode, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void*
+cpu::memory::allocate_huge(std::size_t bytes, huge_pages mode) {
+    if (!detail::mapped(bytes, mode)) {
+        return ::operator new(bytes);
+    }
+#if defined(__linux__)
+    std::size_t const size(detail::round_up(bytes));
+    int const         prot(PROT_READ | PROT_WRITE);
+    int const         flags(MAP_PRIVATE | MAP_ANONYMOUS);
+#if defined(MAP_HUGETLB)
+    if (mode == huge_pages::hugetlb) {
+        void* ptr(::mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0));
+        if (ptr != MAP_FAILED) {
+            return ptr;
+        }
+    }
+#endif
+    // over-allocate to trim the mapping to a huge page boundary
+    void* map(::mmap(nullptr, size + huge_page_size, prot, flags, -1, 0));
+    if (map == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    char*             begin(static_cast<char*>(map));
+    std::uintptr_t    address(reinterpret_cast<std::uintptr_t>(begin));
+    std::size_t const head((huge_page_size - address % huge_page_size) % huge_page_size);
+    if (head) {
+        ::munmap(begin, head);
+    }
+    ::munmap(begin + head + size, huge_page_size - head);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(begin + head, size, MADV_HUGEPAGE);
+#endif
+    return begin + head;
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+inline void
+cpu::memory::deallocate_huge(void* ptr, std::size_t bytes, huge_pages mode) {
+    if (!detail::mapped(bytes, mode)) {
+        ::operator delete(ptr);
+    }
+#if defined(__linux__)
+    else {
+        ::munmap(ptr, detail::round_up(bytes));
+    }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+class cpu::memory::huge_page_allocator {
+private:
+    huge_pages d_mode;
+
+    template <typename> friend class huge_page_allocator;
+
+public:
+    using value_type = T;
+
+    huge_page_allocator(): d_mode(cpu::memory::default_huge_pages()) {}
+    explicit huge_page_allocator(huge_pages mode): d_mode(mode) {}
+    template <typename S>
+    huge_page_allocator(huge_page_allocator<S> const& other): d_mode(other.d_mode) {}
+
+    huge_pages mode() const { return this->d_mode; }
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(cpu::memory::allocate_huge(n * sizeof(T), this->d_mode));
+    }
+    void deallocate(T* ptr, std::size_t n) {
+        cpu::memory::deallocate_huge(ptr, n * sizeof(T), this->d_mode);
+    }
+
+    template <typename S>
+    bool operator== (huge_page_allocator<S> const& other) const {
+        return this->d_mode == other.d_mode;
+    }
+    template <typename S>
+    bool operator!= (huge_page_allocator<S> const& other) const {
+        return !(*this == other);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,146 @@
+// cpu/memory/huge_page_allocator.t.cpp                               -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "huge_page_allocator.hpp"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    bool huge_aligned(void const* ptr) {
+        return reinterpret_cast<std::uintptr_t>(ptr) % CM::huge_page_size == 0u;
+    }
+
+    bool use(CM::huge_pages mode, std::size_t size) {
+        CM::huge_page_allocator<int> alloc(mode);
+        int* ptr(alloc.allocate(size));
+        std::iota(ptr, ptr + size, 0);
+        bool success(ptr[size - 1] == int(size - 1));
+#if defined(__linux__)
+        success = success
+            && (mode == CM::huge_pages::off || size * sizeof(int) < CM::huge_page_size
+                || huge_aligned(ptr));
+#endif
+        alloc.deallocate(ptr, size);
+        return success;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "parse", []{
+            bool success(CM::parse_huge_pages("") == CM::huge_pages::off
+                         && CM::parse_huge_pages("off") == CM::huge_pages::off
+                         && CM::parse_huge_pages("thp") == CM::huge_pages::transparent
+                         && CM::parse_huge_pages("1") == CM::huge_pages::transparent
+                         && CM::parse_huge_pages("hugetlb") == CM::huge_pages::hugetlb);
+            for (auto mode: { CM::huge_pages::off, CM::huge_pages::transparent, CM::huge_pages::hugetlb }) {
+                success = success && CM::parse_huge_pages(CM::to_string(mode)) == mode;
+            }
+            try {
+                CM::parse_huge_pages("gigantic");
+                return false;
+            }
+            catch (std::invalid_argument const&) {
+                return success;
+            }
+        }
+    },
+    { "small allocations", []{
+            return use(CM::huge_pages::off, 100u)
+                && use(CM::huge_pages::transparent, 100u)
+                && use(CM::huge_pages::hugetlb, 100u);
+        }
+    },
+    { "large allocations", []{
+            std::size_t const size(3u * CM::huge_page_size / sizeof(int) + 17u);
+            return use(CM::huge_pages::off, size)
+                && use(CM::huge_pages::transparent, size)
+                && use(CM::huge_pages::hugetlb, size); // falls back without reserved pages
+        }
+    },
+    { "default mode", []{
+            bool success(CM::default_huge_pages() == CM::huge_pages::off
+                         && CM::huge_page_allocator<int>().mode() == CM::huge_pages::off);
+            CM::set_default_huge_pages(CM::huge_pages::transparent);
+            CM::huge_page_allocator<int>    alloc;
+            CM::huge_page_allocator<double> copy(alloc);
+            CM::set_default_huge_pages(CM::huge_pages::off);
+            return success
+                && alloc.mode() == CM::huge_pages::transparent
+                && copy == alloc
+                && CM::huge_page_allocator<int>() != alloc;
+        }
+    },
+    { "vector", []{
+            CM::huge_page_vector<double>
+                values(CM::huge_page_size, 1.0, CM::huge_page_allocator<double>(CM::huge_pages::transparent));
+            values.push_back(2.0); // reallocates
+            return std::accumulate(values.begin(), values.end(), 0.0) == double(CM::huge_page_size) + 2.0;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
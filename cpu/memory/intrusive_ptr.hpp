@@ -0,0 +1,120 @@
+// cpu/memory/intrusive_ptr.hpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_INTRUSIVE_PTR
+#define INCLUDED_MEMORY_INTRUSIVE_PTR
+
+#include "cpu/memory/ref_count.hpp"
+#include <utility>
+
+// ----------------------------------------------------------------------------
+// A pointer to an object holding its own reference count: the count is
+// manipulated using the functions intrusive_ptr_add_ref(T*) and
+// intrusive_ptr_release(T*) which are found using argument dependent look-
+// up. Deriving from ref_counted<T, Count> provides these functions for a
+// class T with a reference count of type Count (see ref_count.hpp), e.g.:
+//
+//     struct node: cpu::memory::ref_counted<node, cpu::memory::atomic_count> { ... };
+//     auto ptr = cpu::memory::make_intrusive<node>(args...);
+//
+// Objects start with a count of 1 which is adopted by the first pointer.
+
+namespace cpu {
+    namespace memory {
+        template <typename T>
+        class intrusive_ptr;
+        template <typename T, typename Count>
+        class ref_counted;
+
+        template <typename T, typename... Args>
+        intrusive_ptr<T> make_intrusive(Args&&... args);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename Count>
+class cpu::memory::ref_counted {
+private:
+    Count d_count;
+
+    friend void intrusive_ptr_add_ref(ref_counted* ptr) { ptr->d_count.increment(); }
+    friend void intrusive_ptr_release(ref_counted* ptr) {
+        if (ptr->d_count.decrement()) {
+            delete static_cast<T*>(ptr);
+        }
+    }
+
+protected:
+    ref_counted() = default;
+    ref_counted(ref_counted const&): d_count() {}
+    void operator=(ref_counted const&) {}
+    ~ref_counted() = default;
+
+public:
+    long use_count() const { return this->d_count.count(); }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+class cpu::memory::intrusive_ptr {
+private:
+    T* d_ptr;
+
+public:
+    struct adopt_t {};
+    static constexpr adopt_t adopt{};
+
+    intrusive_ptr(): d_ptr(nullptr) {}
+    // takes over the reference held by the caller
+    intrusive_ptr(T* ptr, adopt_t): d_ptr(ptr) {}
+    // adds a reference
+    explicit intrusive_ptr(T* ptr): d_ptr(ptr) { if (ptr) { intrusive_ptr_add_ref(ptr); } }
+    intrusive_ptr(intrusive_ptr const& other): intrusive_ptr(other.d_ptr) {}
+    intrusive_ptr(intrusive_ptr&& other): d_ptr(std::exchange(other.d_ptr, nullptr)) {}
+    intrusive_ptr& operator=(intrusive_ptr other) { this->swap(other); return *this; }
+    ~intrusive_ptr() { if (this->d_ptr) { intrusive_ptr_release(this->d_ptr); } }
+
+    void swap(intrusive_ptr& other) { std::swap(this->d_ptr, other.d_ptr); }
+    void reset() { intrusive_ptr().swap(*this); }
+
+    T*   get() const { return this->d_ptr; }
+    T&   operator*() const { return *this->d_ptr; }
+    T*   operator->() const { return this->d_ptr; }
+    explicit operator bool() const { return this->d_ptr != nullptr; }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename T, typename... Args>
+cpu::memory::intrusive_ptr<T>
+cpu::memory::make_intrusive(Args&&... args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...), intrusive_ptr<T>::adopt);
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
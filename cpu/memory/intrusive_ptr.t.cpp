@@ -0,0 +1,130 @@
+// cpu/memory/intrusive_ptr.t.cpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "intrusive_ptr.hpp"
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <cstdlib>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Count>
+    struct object
+        : CM::ref_counted<object<Count>, Count> {
+        int& live;
+        int  value;
+        object(int& live, int value): live(live), value(value) { ++this->live; }
+        ~object() { --this->live; }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "make and copy", []{
+            int live(0);
+            bool success(true);
+            {
+                auto p0(CM::make_intrusive<object<CM::unsynchronized_count>>(live, 17));
+                success = success && live == 1 && p0->value == 17 && p0->use_count() == 1;
+                auto p1(p0);
+                success = success && p0.get() == p1.get() && p0->use_count() == 2;
+                auto p2(std::move(p1));
+                success = success && !p1 && p2->use_count() == 2;
+                p0.reset();
+                success = success && !p0 && live == 1 && p2->use_count() == 1;
+            }
+            return success && live == 0;
+        }
+    },
+    { "adopt and add reference", []{
+            int live(0);
+            using type = object<CM::unsynchronized_count>;
+            type* raw(new type(live, 1));
+            bool success(true);
+            {
+                CM::intrusive_ptr<type> p0(raw, CM::intrusive_ptr<type>::adopt);
+                CM::intrusive_ptr<type> p1(raw);
+                success = raw->use_count() == 2;
+            }
+            return success && live == 0;
+        }
+    },
+    { "atomic count shared between threads", []{
+            int live(0);
+            {
+                auto ptr(CM::make_intrusive<object<CM::atomic_count>>(live, 0));
+                auto copy = [ptr]{
+                    for (int i(0); i != 100000; ++i) {
+                        CM::intrusive_ptr<object<CM::atomic_count>> tmp(ptr);
+                    }
+                };
+                std::thread t0(copy), t1(copy);
+                t0.join();
+                t1.join();
+                if (ptr->use_count() != 2) { // ptr and the copy in the lambda
+                    return false;
+                }
+            }
+            return live == 0;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
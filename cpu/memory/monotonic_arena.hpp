@@ -0,0 +1,125 @@
+// cpu/memory/monotonic_arena.hpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_MONOTONIC_ARENA
+#define INCLUDED_MEMORY_MONOTONIC_ARENA
+
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// A bump allocator: the memory is carved from chunks obtained with operator
+// new whose sizes grow geometrically. deallocate() does nothing, i.e., the
+// memory is only reclaimed by release() or by destroying the arena.
+// release() keeps the most recent (and largest) chunk so an arena which is
+// repeatedly filled and released stops allocating after the first round.
+
+namespace cpu {
+    namespace memory {
+        class monotonic_arena;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::memory::monotonic_arena {
+private:
+    struct alignas(std::max_align_t) chunk {
+        chunk*      next;
+        std::size_t size;
+        char*       begin() { return reinterpret_cast<char*>(this + 1); }
+        char*       end()   { return reinterpret_cast<char*>(this) + this->size; }
+    };
+
+    std::size_t d_initial_size;
+    std::size_t d_next_size;
+    chunk*      d_chunks{nullptr};
+    char*       d_current{nullptr};
+    char*       d_end{nullptr};
+    std::size_t d_allocated{0u};
+
+    static char* p_align(char* ptr, std::size_t alignment) {
+        std::uintptr_t value(reinterpret_cast<std::uintptr_t>(ptr));
+        return ptr + ((alignment - value % alignment) % alignment);
+    }
+    char* p_grow(std::size_t size, std::size_t alignment) {
+        std::size_t chunk_size(std::max(this->d_next_size, sizeof(chunk) + size + alignment));
+        chunk*      c(new(::operator new(chunk_size)) chunk{this->d_chunks, chunk_size});
+        this->d_chunks     = c;
+        this->d_next_size  = 2u * chunk_size;
+        this->d_allocated += chunk_size;
+        this->d_end        = c->end();
+        return p_align(c->begin(), alignment);
+    }
+
+public:
+    static constexpr std::size_t default_size{64u * 1024u};
+
+    explicit monotonic_arena(std::size_t initial_size = default_size)
+        : d_initial_size(std::max(initial_size, 2u * sizeof(chunk)))
+        , d_next_size(this->d_initial_size) {
+    }
+    monotonic_arena(monotonic_arena const&) = delete;
+    void operator=(monotonic_arena const&) = delete;
+    ~monotonic_arena() {
+        this->release();
+        if (this->d_chunks) {
+            ::operator delete(this->d_chunks);
+        }
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        char* rc(this->d_current? p_align(this->d_current, alignment): nullptr);
+        if (!rc || this->d_end < rc || std::size_t(this->d_end - rc) < size) {
+            rc = this->p_grow(size, alignment);
+        }
+        this->d_current = rc + size;
+        return rc;
+    }
+    void deallocate(void*, std::size_t, std::size_t = alignof(std::max_align_t)) {}
+
+    // Releases all chunks but the most recent one which is reused.
+    void release() {
+        if (this->d_chunks) {
+            for (chunk* c(this->d_chunks->next); c; ) {
+                chunk* next(c->next);
+                this->d_allocated -= c->size;
+                ::operator delete(c);
+                c = next;
+            }
+            this->d_chunks->next = nullptr;
+            this->d_current      = this->d_chunks->begin();
+        }
+    }
+
+    // the number of bytes currently obtained from operator new
+    std::size_t allocated() const { return this->d_allocated; }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,138 @@
+// cpu/memory/monotonic_arena.t.cpp                                   -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "monotonic_arena.hpp"
+#include <iostream>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "allocate", []{
+            CM::monotonic_arena arena(1024u);
+            char* p0(static_cast<char*>(arena.allocate(10u, 1u)));
+            char* p1(static_cast<char*>(arena.allocate(10u, 1u)));
+            std::memset(p0, 'a', 10u);
+            std::memset(p1, 'b', 10u);
+            return p1 == p0 + 10 && p0[9] == 'a' && arena.allocated() == 1024u;
+        }
+    },
+    { "alignment", []{
+            CM::monotonic_arena arena(1024u);
+            bool success(true);
+            for (std::size_t alignment(1u); alignment <= 64u; alignment *= 2u) {
+                arena.allocate(1u, 1u);
+                void* ptr(arena.allocate(8u, alignment));
+                success = success && reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0u;
+            }
+            return success;
+        }
+    },
+    { "over-aligned near the end", []{
+            // determine the usable size of the first chunk
+            std::size_t usable(0u);
+            {
+                CM::monotonic_arena arena(1024u);
+                arena.allocate(1u, 1u);
+                for (usable = 1u; arena.allocated() == 1024u; ++usable) {
+                    arena.allocate(1u, 1u);
+                }
+                --usable; // the last allocation used a new chunk
+            }
+            bool success(true);
+            for (std::size_t fill(usable - 80u); fill <= usable; ++fill) {
+                CM::monotonic_arena arena(1024u);
+                char* begin(static_cast<char*>(arena.allocate(fill, 1u)));
+                char* ptr(static_cast<char*>(arena.allocate(8u, 64u)));
+                bool  same_chunk(begin + fill <= ptr && ptr + 8 <= begin + usable);
+                success = success
+                    && reinterpret_cast<std::uintptr_t>(ptr) % 64u == 0u
+                    && (same_chunk || 1024u < arena.allocated());
+                std::memset(ptr, 0, 8u);
+            }
+            return success;
+        }
+    },
+    { "growth", []{
+            CM::monotonic_arena arena(1024u);
+            for (int i(0); i != 100; ++i) {
+                std::memset(arena.allocate(100u), i, 100u);
+            }
+            void* large(arena.allocate(1u << 20));
+            std::memset(large, 0, 1u << 20);
+            return (1u << 20) + 100u * 100u <= arena.allocated();
+        }
+    },
+    { "release keeps the last chunk", []{
+            CM::monotonic_arena arena(1024u);
+            for (int i(0); i != 100; ++i) {
+                arena.allocate(100u);
+            }
+            arena.release();
+            std::size_t allocated(arena.allocated());
+            for (int i(0); i != 20; ++i) {
+                arena.allocate(100u);
+            }
+            return allocated < 100u * 100u * 2u && arena.allocated() == allocated;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
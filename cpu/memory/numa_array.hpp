@@ -0,0 +1,257 @@
+// cpu/memory/numa_array.hpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_NUMA_ARRAY
+#define INCLUDED_MEMORY_NUMA_ARRAY
+
+#include "cpu/memory/huge_page_allocator.hpp"
+#include "cpu/tube/numa.hpp"
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// A fixed size array for benchmark data whose pages are placed on the NUMA
+// nodes according to a placement. The pages are placed by the first touch,
+// i.e., the elements are initialized from threads pinned to the nodes:
+//
+// - local:       the constructing thread initializes all elements, i.e., all
+//                pages end up on the node of this thread
+// - interleaved: the pages are assigned to the nodes round-robin; using
+//                huge pages (see CPUTUBE_HUGE_PAGES) the unit is a huge page
+// - partitioned: the elements are split into contiguous chunks for the
+//                workers which are initialized by the worker threads using
+//                the worker layout of cpu::tube::numa_topology, i.e., a
+//                parallel algorithm using the same layout accesses local
+//                pages only
+//
+// The memory is mapped freshly (using huge pages if the default mode and
+// the size call for them) to make sure the pages weren't touched before.
+// A copy uses the placement of the original. The elements have to be
+// trivially destructible.
+
+namespace cpu {
+    namespace memory {
+        enum class numa_placement { local, interleaved, partitioned };
+        char const* to_string(numa_placement placement);
+
+        template <typename T>
+        class numa_array;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline char const*
+cpu::memory::to_string(numa_placement placement) {
+    switch (placement) {
+    case numa_placement::local:       return "local";
+    case numa_placement::interleaved: return "interleaved";
+    case numa_placement::partitioned: return "partitioned";
+    }
+    return "unknown";
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+class cpu::memory::numa_array {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "the elements of a numa_array are not destroyed");
+private:
+    T*             d_data;
+    std::size_t    d_size;
+    numa_placement d_placement;
+    int            d_workers;
+    huge_pages     d_mode;
+
+    static std::size_t page_size() {
+#if defined(__linux__)
+        return std::size_t(::sysconf(_SC_PAGESIZE));
+#else
+        return 4096u;
+#endif
+    }
+    std::size_t bytes() const {
+        std::size_t const page(page_size());
+        return (this->d_size * sizeof(T) + page - 1u) / page * page;
+    }
+    void* allocate() const;
+    void  deallocate() const;
+    template <typename Init>
+    void  initialize(std::size_t begin, std::size_t end, Init& init) {
+        for (; begin < end; ++begin) {
+            new(this->d_data + begin) T(init(begin));
+        }
+    }
+    template <typename Init>
+    void  place(Init init);
+
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = T const*;
+
+    // init(i) yields the initial value of the element i
+    template <typename Init>
+    numa_array(std::size_t size, numa_placement placement, Init init,
+               int workers = cpu::tube::numa_topology::system().cpus());
+    numa_array(numa_array const& other);
+    void operator=(numa_array const&) = delete;
+    ~numa_array() { this->deallocate(); }
+
+    numa_placement placement() const { return this->d_placement; }
+    int            workers() const   { return this->d_workers; }
+    std::size_t    size() const      { return this->d_size; }
+
+    T*       data()        { return this->d_data; }
+    T const* data() const  { return this->d_data; }
+    T*       begin()       { return this->d_data; }
+    T const* begin() const { return this->d_data; }
+    T*       end()         { return this->d_data + this->d_size; }
+    T const* end() const   { return this->d_data + this->d_size; }
+    T&       operator[](std::size_t index)       { return this->d_data[index]; }
+    T const& operator[](std::size_t index) const { return this->d_data[index]; }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+    template <typename Init>
+cpu::memory::numa_array<T>::numa_array(std::size_t size, numa_placement placement,
+                                       Init init, int workers)
+    : d_data(nullptr)
+    , d_size(size)
+    , d_placement(placement)
+    , d_workers(0 < workers? workers: 1)
+    , d_mode(cpu::memory::default_huge_pages())
+{
+    this->d_data = static_cast<T*>(this->allocate());
+    this->place(init);
+}
+
+template <typename T>
+cpu::memory::numa_array<T>::numa_array(numa_array const& other)
+    : d_data(nullptr)
+    , d_size(other.d_size)
+    , d_placement(other.d_placement)
+    , d_workers(other.d_workers)
+    , d_mode(other.d_mode)
+{
+    this->d_data = static_cast<T*>(this->allocate());
+    T const* data(other.d_data);
+    this->place([data](std::size_t index){ return data[index]; });
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+void* cpu::memory::numa_array<T>::allocate() const {
+    if (this->d_size == 0u) {
+        return nullptr;
+    }
+    if (detail::mapped(this->bytes(), this->d_mode)) {
+        return cpu::memory::allocate_huge(this->bytes(), this->d_mode);
+    }
+#if defined(__linux__)
+    void* map(::mmap(nullptr, this->bytes(), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (map == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    return map;
+#else
+    return ::operator new(this->bytes());
+#endif
+}
+
+template <typename T>
+void cpu::memory::numa_array<T>::deallocate() const {
+    if (this->d_size == 0u) {
+        return;
+    }
+    if (detail::mapped(this->bytes(), this->d_mode)) {
+        cpu::memory::deallocate_huge(this->d_data, this->bytes(), this->d_mode);
+        return;
+    }
+#if defined(__linux__)
+    ::munmap(this->d_data, this->bytes());
+#else
+    ::operator delete(this->d_data);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T>
+    template <typename Init>
+void cpu::memory::numa_array<T>::place(Init init) {
+    auto const& topology(cpu::tube::numa_topology::system());
+    std::size_t const size(this->d_size);
+    switch (this->d_placement) {
+    case numa_placement::local:
+        this->initialize(0u, size, init);
+        break;
+    case numa_placement::partitioned: {
+        int const workers(this->d_workers);
+        cpu::tube::run_workers(topology, workers, [this, &init, size, workers](int worker){
+                this->initialize(size * worker / workers, size * (worker + 1) / workers, init);
+            });
+        } break;
+    case numa_placement::interleaved: {
+        // the element i is on the page containing its first byte
+        std::size_t const unit(detail::mapped(this->bytes(), this->d_mode)
+                               ? huge_page_size: page_size());
+        std::size_t const pages((size * sizeof(T) + unit - 1u) / unit);
+        auto first = [unit, size](std::size_t page){
+            return std::min(size, (page * unit + sizeof(T) - 1u) / sizeof(T));
+        };
+        std::vector<std::thread> threads;
+        int const                nodes(topology.size());
+        for (int node(0); node != nodes; ++node) {
+            threads.emplace_back([this, &topology, &init, &first, node, nodes, pages](){
+                    cpu::tube::pin_thread(topology.nodes()[node].cpus);
+                    for (std::size_t page(node); page < pages; page += nodes) {
+                        this->initialize(first(page), first(page + 1u), init);
+                    }
+                });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        } break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
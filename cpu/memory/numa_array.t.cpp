@@ -0,0 +1,151 @@
+// cpu/memory/numa_array.t.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "numa_array.hpp"
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <cstdlib>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    CM::numa_placement const placements[] = {
+        CM::numa_placement::local,
+        CM::numa_placement::interleaved,
+        CM::numa_placement::partitioned
+    };
+
+    template <typename T>
+    bool check(CM::numa_array<T> const& array, std::size_t size) {
+        if (array.size() != size || std::size_t(array.end() - array.begin()) != size) {
+            return false;
+        }
+        for (std::size_t i(0); i != size; ++i) {
+            if (array[i] != T(3 * i + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool place(CM::huge_pages mode, std::size_t size) {
+        CM::set_default_huge_pages(mode);
+        bool success(true);
+        for (auto placement: placements) {
+            CM::numa_array<std::int64_t> array(size, placement,
+                                               [](std::size_t i){ return std::int64_t(3 * i + 1); },
+                                               3);
+            success = success
+                && array.placement() == placement
+                && array.workers() == 3
+                && check(array, size);
+        }
+        CM::set_default_huge_pages(CM::huge_pages::off);
+        return success;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "names", []{
+            return CM::to_string(CM::numa_placement::local) == std::string("local")
+                && CM::to_string(CM::numa_placement::interleaved) == std::string("interleaved")
+                && CM::to_string(CM::numa_placement::partitioned) == std::string("partitioned");
+        }
+    },
+    { "empty", []{
+            CM::numa_array<int> array(0u, CM::numa_placement::partitioned,
+                                      [](std::size_t){ return 0; });
+            CM::numa_array<int> copy(array);
+            return array.size() == 0u && array.begin() == array.end() && copy.size() == 0u;
+        }
+    },
+    { "small", []{
+            return place(CM::huge_pages::off, 5u)
+                && place(CM::huge_pages::transparent, 1000u);
+        }
+    },
+    { "large", []{
+            std::size_t const size(2u * CM::huge_page_size / sizeof(std::int64_t) + 17u);
+            return place(CM::huge_pages::off, size)
+                && place(CM::huge_pages::transparent, size);
+        }
+    },
+    { "default workers", []{
+            CM::numa_array<int> array(10u, CM::numa_placement::partitioned,
+                                      [](std::size_t i){ return int(3 * i + 1); });
+            return array.workers() == cpu::tube::numa_topology::system().cpus()
+                && check(array, 10u);
+        }
+    },
+    { "copy", []{
+            CM::numa_array<double> array(100000u, CM::numa_placement::interleaved,
+                                         [](std::size_t i){ return double(3 * i + 1); }, 2);
+            CM::numa_array<double> copy(array);
+            copy[0] = 0.0;
+            return copy.placement() == CM::numa_placement::interleaved
+                && copy.workers() == 2
+                && copy.data() != array.data()
+                && check(array, 100000u)
+                && copy[1] == 4.0;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
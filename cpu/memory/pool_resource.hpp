@@ -0,0 +1,152 @@
+// cpu/memory/pool_resource.hpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_POOL_RESOURCE
+#define INCLUDED_MEMORY_POOL_RESOURCE
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// A single-threaded size-class pool: requests of up to max_size bytes are
+// rounded up to a multiple of granularity and served from a free list per
+// size class. Blocks not on a free list are carved from chunks obtained with
+// operator new. Larger requests and over-aligned requests are forwarded to
+// operator new. The memory of the chunks is only returned by release() or
+// by destroying the pool.
+
+namespace cpu {
+    namespace memory {
+        class pool_resource;
+
+        namespace detail {
+            struct free_block {
+                free_block* next;
+            };
+
+            constexpr std::size_t granularity{16u};
+            constexpr std::size_t max_size{512u};
+            constexpr std::size_t size_classes{max_size / granularity};
+
+            constexpr bool pooled(std::size_t size, std::size_t alignment) {
+                return size <= max_size && alignment <= alignof(std::max_align_t);
+            }
+            constexpr std::size_t size_class(std::size_t size) {
+                return (size + (size == 0u) + granularity - 1u) / granularity - 1u;
+            }
+            constexpr std::size_t class_size(std::size_t size_class) {
+                return (size_class + 1u) * granularity;
+            }
+
+            inline void* allocate_large(std::size_t size, std::size_t alignment) {
+                return alignment <= alignof(std::max_align_t)
+                    ? ::operator new(size)
+                    : ::operator new(size, std::align_val_t(alignment));
+            }
+            inline void deallocate_large(void* ptr, std::size_t alignment) {
+                if (alignment <= alignof(std::max_align_t)) {
+                    ::operator delete(ptr);
+                }
+                else {
+                    ::operator delete(ptr, std::align_val_t(alignment));
+                }
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::memory::pool_resource {
+private:
+    struct alignas(std::max_align_t) chunk {
+        chunk* next;
+    };
+
+    std::size_t         d_chunk_size;
+    chunk*              d_chunks{nullptr};
+    char*               d_current{nullptr};
+    char*               d_end{nullptr};
+    detail::free_block* d_free[detail::size_classes]{};
+
+    void* p_carve(std::size_t size) {
+        if (std::size_t(this->d_end - this->d_current) < size) {
+            this->d_chunks  = new(::operator new(sizeof(chunk) + this->d_chunk_size)) chunk{this->d_chunks};
+            this->d_current = reinterpret_cast<char*>(this->d_chunks + 1);
+            this->d_end     = this->d_current + this->d_chunk_size;
+        }
+        void* rc(this->d_current);
+        this->d_current += size;
+        return rc;
+    }
+
+public:
+    static constexpr std::size_t default_chunk_size{64u * 1024u};
+
+    explicit pool_resource(std::size_t chunk_size = default_chunk_size)
+        : d_chunk_size(chunk_size < detail::max_size? detail::max_size: chunk_size) {
+    }
+    pool_resource(pool_resource const&) = delete;
+    void operator=(pool_resource const&) = delete;
+    ~pool_resource() { this->release(); }
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!detail::pooled(size, alignment)) {
+            return detail::allocate_large(size, alignment);
+        }
+        std::size_t c(detail::size_class(size));
+        if (detail::free_block* block = this->d_free[c]) {
+            this->d_free[c] = block->next;
+            return block;
+        }
+        return this->p_carve(detail::class_size(c));
+    }
+    void deallocate(void* ptr, std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!detail::pooled(size, alignment)) {
+            detail::deallocate_large(ptr, alignment);
+        }
+        else {
+            std::size_t c(detail::size_class(size));
+            this->d_free[c] = new(ptr) detail::free_block{this->d_free[c]};
+        }
+    }
+
+    // Returns all chunks; the pooled blocks must not be used afterwards.
+    void release() {
+        while (this->d_chunks) {
+            chunk* next(this->d_chunks->next);
+            ::operator delete(this->d_chunks);
+            this->d_chunks = next;
+        }
+        this->d_current = this->d_end = nullptr;
+        std::fill(std::begin(this->d_free), std::end(this->d_free), nullptr);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,136 @@
+// cpu/memory/pool_resource.t.cpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "pool_resource.hpp"
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "size classes", []{
+            return CM::detail::size_class(0u) == 0u
+                && CM::detail::size_class(1u) == 0u
+                && CM::detail::size_class(16u) == 0u
+                && CM::detail::size_class(17u) == 1u
+                && CM::detail::size_class(512u) == CM::detail::size_classes - 1u
+                && CM::detail::class_size(CM::detail::size_class(100u)) == 112u
+                && CM::detail::pooled(512u, 8u)
+                && !CM::detail::pooled(513u, 8u)
+                && !CM::detail::pooled(8u, 2u * alignof(std::max_align_t));
+        }
+    },
+    { "distinct aligned blocks", []{
+            CM::pool_resource pool(4096u);
+            std::set<void*>   blocks;
+            bool              success(true);
+            for (std::size_t size(1u); size < 1000u; size += 7u) {
+                void* ptr(pool.allocate(size));
+                std::memset(ptr, 0xff, size);
+                success = success && blocks.insert(ptr).second
+                    && reinterpret_cast<std::uintptr_t>(ptr) % alignof(std::max_align_t) == 0u;
+            }
+            return success;
+        }
+    },
+    { "reuse", []{
+            CM::pool_resource pool;
+            void* p0(pool.allocate(40u));
+            void* p1(pool.allocate(40u));
+            pool.deallocate(p0, 40u);
+            pool.deallocate(p1, 40u);
+            void* p2(pool.allocate(33u));
+            void* p3(pool.allocate(48u));
+            void* p4(pool.allocate(20u));
+            bool  success(p2 == p1 && p3 == p0 && p4 != p0 && p4 != p1);
+            pool.deallocate(p2, 33u);
+            pool.deallocate(p3, 48u);
+            pool.deallocate(p4, 20u);
+            return success;
+        }
+    },
+    { "large", []{
+            CM::pool_resource pool;
+            void* ptr(pool.allocate(4096u));
+            std::memset(ptr, 0, 4096u);
+            pool.deallocate(ptr, 4096u);
+            void* aligned(pool.allocate(64u, 256u));
+            bool  success(reinterpret_cast<std::uintptr_t>(aligned) % 256u == 0u);
+            pool.deallocate(aligned, 64u, 256u);
+            return success;
+        }
+    },
+    { "release", []{
+            CM::pool_resource pool;
+            std::vector<void*> blocks;
+            for (int i(0); i != 10000; ++i) {
+                blocks.push_back(pool.allocate(64u));
+            }
+            pool.release();
+            void* ptr(pool.allocate(64u));
+            std::memset(ptr, 0, 64u);
+            return ptr != nullptr;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
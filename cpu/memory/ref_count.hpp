@@ -0,0 +1,76 @@
+// cpu/memory/ref_count.hpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_REF_COUNT
+#define INCLUDED_MEMORY_REF_COUNT
+
+#include <atomic>
+
+// ----------------------------------------------------------------------------
+// The reference counts used by the smart pointers of cpu/memory: a count
+// starts at 1, increment() adds a reference, and decrement() removes one,
+// returning true when the last reference was removed.
+//
+// - unsynchronized_count uses a plain integer, i.e., all references to an
+//   object need to be used by the same thread.
+// - atomic_count uses atomic operations: increments are relaxed as the new
+//   reference is created from an existing one; the decrement which may
+//   destroy the object is acquire/release to order the other threads'
+//   accesses to the object before the destruction.
+
+namespace cpu {
+    namespace memory {
+        class unsynchronized_count;
+        class atomic_count;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::memory::unsynchronized_count {
+private:
+    long d_count{1};
+
+public:
+    void increment() { ++this->d_count; }
+    bool decrement() { return --this->d_count == 0; }
+    long count() const { return this->d_count; }
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::memory::atomic_count {
+private:
+    std::atomic<long> d_count{1};
+
+public:
+    void increment() { this->d_count.fetch_add(1, std::memory_order_relaxed); }
+    bool decrement() { return this->d_count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    long count() const { return this->d_count.load(std::memory_order_relaxed); }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,118 @@
+// cpu/memory/thread_local_resource.hpp                               -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_MEMORY_THREAD_LOCAL_RESOURCE
+#define INCLUDED_MEMORY_THREAD_LOCAL_RESOURCE
+
+#include "cpu/memory/pool_resource.hpp"
+#include <new>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// A resource caching released blocks in per-thread free lists, using the
+// size classes of pool_resource: blocks which aren't in the calling
+// thread's cache are allocated individually with operator new. Released
+// blocks are put into the cache of the releasing thread unless it already
+// holds max_cached blocks of the size class. Thus, blocks can be released
+// by any thread. The cache of a thread is freed when the thread exits or
+// when it calls release(). All thread_local_resource objects share the
+// caches, i.e., the objects have no state.
+
+namespace cpu {
+    namespace memory {
+        class thread_local_resource;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::memory::thread_local_resource {
+private:
+    struct cache {
+        detail::free_block* d_free[detail::size_classes]{};
+        std::size_t         d_count[detail::size_classes]{};
+
+        cache() = default;
+        cache(cache const&) = delete;
+        void operator=(cache const&) = delete;
+        ~cache() { this->release(); }
+
+        void release() {
+            for (std::size_t c(0u); c != detail::size_classes; ++c) {
+                while (detail::free_block* block = this->d_free[c]) {
+                    this->d_free[c] = block->next;
+                    ::operator delete(block);
+                }
+                this->d_count[c] = 0u;
+            }
+        }
+    };
+
+    static cache& p_cache() {
+        static thread_local cache rc;
+        return rc;
+    }
+
+public:
+    static constexpr std::size_t max_cached{4096u};
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!detail::pooled(size, alignment)) {
+            return detail::allocate_large(size, alignment);
+        }
+        std::size_t c(detail::size_class(size));
+        cache&      local(p_cache());
+        if (detail::free_block* block = local.d_free[c]) {
+            local.d_free[c] = block->next;
+            --local.d_count[c];
+            return block;
+        }
+        return ::operator new(detail::class_size(c));
+    }
+    void deallocate(void* ptr, std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!detail::pooled(size, alignment)) {
+            detail::deallocate_large(ptr, alignment);
+            return;
+        }
+        std::size_t c(detail::size_class(size));
+        cache&      local(p_cache());
+        if (local.d_count[c] == max_cached) {
+            ::operator delete(ptr);
+        }
+        else {
+            local.d_free[c] = new(ptr) detail::free_block{local.d_free[c]};
+            ++local.d_count[c];
+        }
+    }
+
+    // Frees the blocks cached by the calling thread.
+    void release() { p_cache().release(); }
+    // The number of blocks of the size class for size cached by the calling thread.
+    std::size_t cached(std::size_t size) const { return p_cache().d_count[detail::size_class(size)]; }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,115 @@
+// cpu/memory/thread_local_resource.t.cpp                             -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "thread_local_resource.hpp"
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+namespace CM = cpu::memory;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "reuse", []{
+            CM::thread_local_resource resource;
+            resource.release();
+            void* p0(resource.allocate(24u));
+            std::memset(p0, 0, 24u);
+            resource.deallocate(p0, 24u);
+            bool  cached(resource.cached(24u) == 1u);
+            void* p1(CM::thread_local_resource().allocate(32u));
+            bool  success(cached && p1 == p0 && resource.cached(24u) == 0u);
+            resource.deallocate(p1, 32u);
+            resource.release();
+            return success && resource.cached(24u) == 0u;
+        }
+    },
+    { "cache limit", []{
+            CM::thread_local_resource resource;
+            std::vector<void*> blocks;
+            for (std::size_t i(0u); i != 2u * CM::thread_local_resource::max_cached; ++i) {
+                blocks.push_back(resource.allocate(100u));
+            }
+            for (void* ptr: blocks) {
+                resource.deallocate(ptr, 100u);
+            }
+            bool success(resource.cached(100u) == CM::thread_local_resource::max_cached);
+            resource.release();
+            return success;
+        }
+    },
+    { "cross thread release", []{
+            CM::thread_local_resource resource;
+            std::vector<void*> blocks;
+            for (int i(0); i != 100; ++i) {
+                blocks.push_back(resource.allocate(64u));
+            }
+            std::size_t cached(0u);
+            std::thread([&]{
+                    for (void* ptr: blocks) {
+                        resource.deallocate(ptr, 64u);
+                    }
+                    cached = resource.cached(64u);
+                }).join();
+            return cached == 100u && resource.cached(64u) == 0u;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,244 @@
+// cpu/test/false-sharing.cpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/padded.hpp"
+#include "cpu/tube/threads.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+// Measuring the effect of false sharing, i.e., of threads writing to
+// different objects on the same cache line. Each scenario is run with the
+// objects packed densely and with the objects padded to the destructive
+// interference size using cpu::tube::padded<T>:
+//
+// - counters:  each thread increments its own atomic counter
+// - spsc ring: a producer and a consumer thread pass values through a ring
+//              buffer whose indices are either on the same or on separate
+//              cache lines
+// - reduce:    the threads accumulate slices of a sequence into per-thread
+//              partial sums which are updated for each element; the
+//              variant accumulating into a local variable is the reference
+
+namespace {
+    template <typename T>
+    T& value(T& object) { return object; }
+    template <typename T, std::size_t Align>
+    T& value(CT::padded<T, Align>& object) { return object.value; }
+
+    // called while waiting for a condition: yields every 64 calls
+    struct backoff {
+        int count{0};
+        void operator()() {
+            if (++this->count % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Counter>
+    struct counters {
+        std::string label;
+        std::string name() const { return "counters (" + this->label + ")"; }
+        long run(int size, int threads) const {
+            std::vector<Counter> counts(threads);
+            CT::run_threads(threads, [&](int t){
+                    std::atomic<long>& count(value(counts[t]));
+                    for (int i(0); i != size; ++i) {
+                        count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            long total(0);
+            for (auto& count: counts) {
+                total += value(count).load();
+            }
+            return total;
+        }
+    };
+
+    // ------------------------------------------------------------------------
+
+    struct shared_indices {
+        std::atomic<std::size_t> head{0u}; // written by the consumer
+        std::atomic<std::size_t> tail{0u}; // written by the producer
+    };
+
+    struct separate_indices {
+        CT::padded<std::atomic<std::size_t>> head{0u};
+        CT::padded<std::atomic<std::size_t>> tail{0u};
+    };
+
+    // The number of threads is ignored: there is one producer and one
+    // consumer.
+    template <typename Indices>
+    struct spsc_ring {
+        static constexpr std::size_t capacity{1024u};
+        std::string label;
+        std::string name() const { return "spsc ring (" + this->label + ")"; }
+        long run(int size, int) const {
+            std::vector<long> buffer(capacity);
+            Indices           indices;
+            long              sum(0);
+            CT::run_threads(2, [&](int t){
+                    backoff wait;
+                    if (t == 0) {
+                        for (std::size_t tail(0u); tail != std::size_t(size); ++tail) {
+                            while (tail - value(indices.head).load(std::memory_order_acquire) == capacity) {
+                                wait();
+                            }
+                            buffer[tail % capacity] = long(tail);
+                            value(indices.tail).store(tail + 1u, std::memory_order_release);
+                        }
+                    }
+                    else {
+                        for (std::size_t head(0u); head != std::size_t(size); ++head) {
+                            while (head == value(indices.tail).load(std::memory_order_acquire)) {
+                                wait();
+                            }
+                            sum += buffer[head % capacity];
+                            value(indices.head).store(head + 1u, std::memory_order_release);
+                        }
+                    }
+                });
+            return sum;
+        }
+    };
+
+    // ------------------------------------------------------------------------
+
+    template <typename Partial>
+    struct reduce_partials {
+        std::string label;
+        std::string name() const { return "reduce (" + this->label + ")"; }
+        long run(std::vector<int> const& values, int threads) const {
+            std::vector<Partial> partials(threads);
+            std::size_t const    size(values.size());
+            CT::run_threads(threads, [&](int t){
+                    std::atomic<long>& partial(value(partials[t]));
+                    for (std::size_t i(size * t / threads), end(size * (t + 1) / threads);
+                         i != end; ++i) {
+                        partial.store(partial.load(std::memory_order_relaxed) + values[i],
+                                      std::memory_order_relaxed);
+                    }
+                });
+            long total(0);
+            for (auto& partial: partials) {
+                total += value(partial).load();
+            }
+            return total;
+        }
+    };
+
+    struct reduce_local {
+        std::string name() const { return "reduce (local variable)"; }
+        long run(std::vector<int> const& values, int threads) const {
+            std::vector<CT::padded<long>> partials(threads);
+            std::size_t const             size(values.size());
+            CT::run_threads(threads, [&](int t){
+                    partials[t].value = std::accumulate(values.begin() + size * t / threads,
+                                                        values.begin() + size * (t + 1) / threads,
+                                                        0l);
+                });
+            long total(0);
+            for (auto const& partial: partials) {
+                total += partial.value;
+            }
+            return total;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Input, typename Algo>
+    void measure(cpu::tube::context& context,
+                 Input const&        input,
+                 int                 size,
+                 int                 threads,
+                 Algo                algo)
+    {
+        std::ostringstream out;
+        out << std::left << std::setw(40) << algo.name()
+            << " [" << size << "/" << threads << "]";
+        std::string name(out.str());
+        auto timer = context.start();
+        long result = algo.run(input, threads);
+        auto time = timer.measure();
+        context.report(name, time, result);
+    }
+}
+
+static void run_tests(cpu::tube::context& context, int size)
+{
+    using dense  = std::atomic<long>;
+    using padded = CT::padded<std::atomic<long>>;
+
+    std::vector<int> values(size);
+    std::iota(values.begin(), values.end(), 0);
+
+    for (int threads: CT::thread_counts()) {
+        measure(context, size, size, threads, counters<dense>{"dense"});
+        measure(context, size, size, threads, counters<padded>{"padded"});
+        measure(context, values, size, threads, reduce_partials<dense>{"dense"});
+        measure(context, values, size, threads, reduce_partials<padded>{"padded"});
+        measure(context, values, size, threads, reduce_local());
+    }
+    measure(context, size, size, 2, spsc_ring<shared_indices>{"shared line"});
+    measure(context, size, size, 2, spsc_ring<separate_indices>{"separate lines"});
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    int size(ac == 1? 0: atoi(av[1]));
+    if (size) {
+        run_tests(context, size);
+    }
+    else {
+        for (int i(1000); i <= 1000000; i *= 10) {
+            for (int j(1); j < 10; j *= 2) {
+                run_tests(context, i * j);
+            }
+        }
+    }
+}
@@ -23,15 +23,21 @@
 //  OTHER DEALINGS IN THE SOFTWARE. 
 // ----------------------------------------------------------------------------
 
+#include "cpu/tube/allocation.hpp"
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/inplace_string.hpp"
 #include "cpu/tube/protect.hpp"
+#include "cpu/format/compiled_format.hpp"
+#include "cpu/format/format_int.hpp"
 #include <algorithm>
+#include <charconv>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <locale>
 #include <random>
 #include <stdexcept>
+#include <string.h>
 #include <vector>
 #include <stdio.h>
 #include <stdlib.h>
@@ -45,6 +51,9 @@
 // I don't know much about IPv6 so this just uses an IPv4 tuple of four 8 bit
 // values and a 16 bit port. The message will be represented by an unsigned
 // integer.
+//
+// Each result is reported with the number of allocations per message which
+// are counted by the global operator new of cpu/tube/allocation.hpp.
 
 namespace {
     // Auxiliary class address to represent and IPv4 address
@@ -82,6 +91,23 @@ namespace {
         using membuf::end;
     };
 }
+
+// The longest address is "255.255.255.255:65535".
+template <>
+struct cpu::format::formatter<address> {
+    static constexpr std::size_t max_size = 4u * 3u + 3u + 1u + 5u;
+    static char* format(char* to, address addr) {
+        to = format_int(to, addr.ip[0]);
+        *to++ = '.';
+        to = format_int(to, addr.ip[1]);
+        *to++ = '.';
+        to = format_int(to, addr.ip[2]);
+        *to++ = '.';
+        to = format_int(to, addr.ip[3]);
+        *to++ = ':';
+        return format_int(to, addr.port);
+    }
+};
  
 namespace
 {
@@ -164,8 +190,111 @@ namespace
             }
         }
     };
+
+    // Build the message directly in a buffer using `put(to, value)` to
+    // format the integers.
+    template <std::size_t N>
+    char* append(char* to, char const (&literal)[N]) {
+        memcpy(to, literal, N - 1u);
+        return to + (N - 1u);
+    }
+    template <typename Put>
+    char* format_message(char* to, address addr, int message, Put put) {
+        to = append(to, "Connection was aborted to ");
+        to = put(to, int(addr.ip[0]));
+        *to++ = '.';
+        to = put(to, int(addr.ip[1]));
+        *to++ = '.';
+        to = put(to, int(addr.ip[2]));
+        *to++ = '.';
+        to = put(to, int(addr.ip[3]));
+        *to++ = ':';
+        to = put(to, int(addr.port));
+        to = append(to, ", cannot send message ");
+        to = put(to, message);
+        *to++ = '\n';
+        return to;
+    }
+
+    struct format_to_chars
+    {
+        template <typename Fun>
+        void process(address addr, std::vector<int> const& messages, Fun fun) {
+            for (int message: messages) {
+                char buffer[256];
+                char* end(format_message(buffer, addr, message,
+                                         [&buffer](char* to, int value){
+                                             return std::to_chars(to, std::end(buffer), value).ptr;
+                                         }));
+                fun(buffer, end);
+            }
+        }
+    };
+
+    struct format_format_int
+    {
+        template <typename Fun>
+        void process(address addr, std::vector<int> const& messages, Fun fun) {
+            for (int message: messages) {
+                char buffer[256];
+                char* end(format_message(buffer, addr, message,
+                                         [](char* to, int value){
+                                             return cpu::format::format_int(to, value);
+                                         }));
+                fun(buffer, end);
+            }
+        }
+    };
+
+    constexpr char message_format[]
+        = "Connection was aborted to {}, cannot send message {}\n";
+    using compiled_message = cpu::format::compiled_format<message_format, address, int>;
+
+    struct format_compiled
+    {
+        template <typename Fun>
+        void process(address addr, std::vector<int> const& messages, Fun fun) {
+            for (int message: messages) {
+                char buffer[compiled_message::max_size];
+                fun(buffer, compiled_message::format(buffer, addr, message));
+            }
+        }
+    };
+
+    // Build the message with an inplace_string with a buffer of N
+    // characters: the message doesn't fit into 32 characters, i.e., with
+    // N == 32 the string is moved to the heap.
+    template <std::size_t N>
+    struct format_inplace_string
+    {
+        template <typename Fun>
+        void process(address addr, std::vector<int> const& messages, Fun fun) {
+            for (int message: messages) {
+                cpu::tube::inplace_string<N> out;
+                out << "Connection was aborted to " << addr << ", "
+                    << "cannot send message " << message << '\n';
+                fun(out.begin(), out.end());
+            }
+        }
+    };
+
+    template <std::size_t N>
+    struct format_inplace_string_hoisted
+    {
+        template <typename Fun>
+        void process(address addr, std::vector<int> const& messages, Fun fun) {
+            cpu::tube::inplace_string<N> out;
+            for (int message: messages) {
+                out.clear();
+                out << "Connection was aborted to " << addr << ", "
+                    << "cannot send message " << message << '\n';
+                fun(out.begin(), out.end());
+            }
+        }
+    };
 }
 
+
 // ----------------------------------------------------------------------------
 
 template <typename Formatter>
@@ -173,6 +302,7 @@ static void
 measure(cpu::tube::context& context, char const* name, address addr,
         std::vector<int> const& values)
 {
+    cpu::tube::allocation_count before(cpu::tube::allocation_counts());
     auto timer = context.start();
     {
         Formatter formatter;
@@ -198,7 +328,10 @@ measure(cpu::tube::context& context, char const* name, address addr,
             }
         }
     }
-    context.report(name, timer);
+    auto duration = timer.measure();
+    double messages(10000.0 * values.size());
+    context.report(name, duration,
+                   (cpu::tube::allocation_counts() - before).allocations / messages);
 }
 
 // ----------------------------------------------------------------------------
@@ -206,6 +339,7 @@ measure(cpu::tube::context& context, char const* name, address addr,
 int main(int ac, char* av[])
 {
     cpu::tube::context context(ac, av, "<unknown>", "<unknown>", "<unknown>");
+    cpu::tube::count_allocations(true);
     std::vector<int>   values;
     std::minstd_rand   rand;
     rand.seed(17);
@@ -218,4 +352,11 @@ int main(int ac, char* av[])
     measure<format_memstream>(            context, "memstream              ", addr, values);
     measure<format_memstream_hoisted>(    context, "memstream (hoisted)    ", addr, values);
     measure<format_snprintf>(             context, "snprintf               ", addr, values);
+    measure<format_to_chars>(             context, "to_chars               ", addr, values);
+    measure<format_format_int>(           context, "format_int             ", addr, values);
+    measure<format_compiled>(             context, "format_compiled        ", addr, values);
+    measure<format_inplace_string<128>>(  context, "inplace_string<128>    ", addr, values);
+    measure<format_inplace_string_hoisted<128>>(context, "inplace_string<128> (h)", addr, values);
+    measure<format_inplace_string<32>>(   context, "inplace_string<32>     ", addr, values);
+    measure<format_inplace_string_hoisted<32>>(context, "inplace_string<32> (h) ", addr, values);
 }
@@ -1,12 +1,16 @@
 #include "cpu/tube/context.hpp"
+#include "cpu/test/stream-filters.hpp"
 #include <algorithm>
 #include <fstream>
 #include <iterator>
 #include <numeric>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <vector>
 
@@ -43,6 +47,14 @@ namespace
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+    using test::use_regex_dfa;
+    using test::use_char_filter;
+}
+
+// ----------------------------------------------------------------------------
+
 namespace
 {
     struct use_remove_if_str_find
@@ -314,10 +326,26 @@ namespace test
 int main(int ac, char* av[])
 {
     cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    std::string const digits("0123456789");
+
+    std::string path;
+    if (test::stream_requested(ac, av, path)) {
+        test::measure_stream(context, "use_remove_if_table", path, use_remove_if_table());
+        test::measure_stream(context, "regex_dfa", path, use_regex_dfa<false>(digits));
+        test::measure_stream(context, "regex_dfa (interleaved)", path, use_regex_dfa<true>(digits));
+        test::measure_stream(context, "char_filter (scalar)", path, use_char_filter<&cpu::algorithm::char_filter::filter_scalar>(digits));
+        test::measure_stream(context, "char_filter (sse4.2)", path, use_char_filter<&cpu::algorithm::char_filter::filter_sse42>(digits));
+        test::measure_stream(context, "char_filter (avx2)", path, use_char_filter<&cpu::algorithm::char_filter::filter_avx2>(digits));
+        return 0;
+    }
 
     std::ifstream in("cpu/test/input.txt");
     std::string text((std::istreambuf_iterator<char>(in)),
                       std::istreambuf_iterator<char>());
+    if (text.empty()) {
+        // the input file isn't available: use synthesised text
+        text = cpu::tube::generate_text(1u << 22);
+    }
 
     test::measure(context, "use_remove_if_str_find", text, use_remove_if_str_find());
     test::measure(context, "use_remove_if_find", text, use_remove_if_find());
@@ -334,6 +362,11 @@ int main(int ac, char* av[])
     test::measure(context, "use_sort", text, use_sort());
     test::measure(context, "use_copy_if", text, use_copy_if());
     test::measure(context, "use_recursive", text, use_recursive());
+    test::measure(context, "char_filter (scalar)", text, use_char_filter<&cpu::algorithm::char_filter::filter_scalar>(digits));
+    test::measure(context, "char_filter (sse4.2)", text, use_char_filter<&cpu::algorithm::char_filter::filter_sse42>(digits));
+    test::measure(context, "char_filter (avx2)", text, use_char_filter<&cpu::algorithm::char_filter::filter_avx2>(digits));
     test::measure(context, "regex_build",    text, use_regex_build());
     test::measure(context, "regex_prebuild", text, use_regex_prebuild());
+    test::measure(context, "regex_dfa", text, use_regex_dfa<false>(digits));
+    test::measure(context, "regex_dfa (interleaved)", text, use_regex_dfa<true>(digits));
 }
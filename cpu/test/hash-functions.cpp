@@ -0,0 +1,242 @@
+// cpu/test/hash-functions.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/keys.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/data-structures/hash.hpp"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <stdlib.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+// The hash functions are compared in two ways:
+// - The throughput in bytes per cycle for strings of different lengths. The
+//   cycles are determined using the time stamp counter, i.e., they are
+//   reference cycles rather than core cycles.
+// - The quality on the keys used by search-short-string and unique-strings:
+//   the number of full 64 bit collisions, the number of keys sharing a bucket
+//   when the bits used by data_structures::hash_set select one of n buckets
+//   (compared with the expected number for a random function), and the
+//   avalanche behaviour, i.e., the probability that an output bit changes
+//   when one input bit is flipped (ideally 0.5 for each output bit).
+
+namespace {
+    struct std_hash {
+        static constexpr char const* name = "std::hash<std::string_view>";
+        static std::uint64_t bytes(void const* data, std::size_t size) {
+            return std::hash<std::string_view>()(
+                std::string_view(static_cast<char const*>(data), size));
+        }
+    };
+    template <typename Hash>
+    struct named: Hash {
+        static char const* const name;
+    };
+    template <> char const* const named<DS::fnv1a_hash>::name = "data_structures::fnv1a_hash";
+    template <> char const* const named<DS::wy_hash>::name    = "data_structures::wy_hash";
+    template <> char const* const named<DS::xxh3_hash>::name  = "data_structures::xxh3_hash";
+    template <> char const* const named<DS::aes_hash>::name   = "data_structures::aes_hash";
+
+    std::uint64_t cycles() {
+#if defined(__x86_64__)
+        return __rdtsc();
+#else
+        return 0u;
+#endif
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Hash>
+    void measure_throughput(cpu::tube::context& context,
+                            std::string const&  buffer,
+                            std::size_t         length)
+    {
+        std::size_t const count(std::max(std::size_t(16u), (std::size_t(1u) << 18) / length));
+        std::size_t const repetitions(std::max(std::size_t(1u), (std::size_t(1u) << 24) / (count * length)));
+        std::uint64_t result(0u);
+
+        auto timer = context.start();
+        std::uint64_t start(cycles());
+        for (std::size_t r(0u); r != repetitions; ++r) {
+            for (std::size_t i(0u); i != count; ++i) {
+                result += Hash::bytes(buffer.data() + i * length + r % 8u, length);
+            }
+            cpu::tube::prevent_optimize_away(result);
+        }
+        std::uint64_t end(cycles());
+        auto time = timer.measure();
+
+        double bytes(double(count) * repetitions * length);
+        std::ostringstream out;
+        out << std::left << std::setw(40) << Hash::name << " bytes/cycle [" << length << "]";
+        context.report(out.str(), time, end == start? 0.0: bytes / (end - start));
+    }
+
+    template <typename... Hash>
+    void run_throughput(cpu::tube::context& context) {
+        std::mt19937 gen(4711);
+        std::uniform_int_distribution<int> rand(0, 255);
+        std::string buffer((std::size_t(1u) << 18) + 16u * 16384u + 8u, '\0');
+        std::generate(buffer.begin(), buffer.end(), [&]{ return char(rand(gen)); });
+
+        for (std::size_t length: { 1u, 2u, 4u, 8u, 12u, 16u, 24u, 32u, 48u, 64u,
+                                   96u, 128u, 256u, 512u, 1024u, 4096u, 16384u }) {
+            (measure_throughput<Hash>(context, buffer, length), ...);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    // The keys of unique-strings: a path prefix and a number.
+    std::vector<std::string> make_paths(std::size_t size, std::string const& base) {
+        std::vector<std::string> rc;
+        for (std::size_t i(0); i != size; ++i) {
+            rc.push_back(base + std::to_string(i));
+        }
+        return rc;
+    }
+
+    template <typename Hash>
+    void measure_quality(cpu::tube::context&             context,
+                         char const*                     keyname,
+                         std::vector<std::string> const& keys)
+    {
+        auto timer = context.start();
+        std::vector<std::uint64_t> hashes;
+        hashes.reserve(keys.size());
+        for (std::string const& key: keys) {
+            hashes.push_back(Hash::bytes(key.data(), key.size()));
+        }
+        auto time = timer.measure();
+
+        std::vector<std::uint64_t> sorted(hashes);
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t collisions(sorted.end() - std::unique(sorted.begin(), sorted.end()));
+
+        // hash_set uses the bits from 10 upwards to determine the bucket
+        std::size_t buckets(1u);
+        while (buckets < keys.size()) {
+            buckets *= 2u;
+        }
+        std::vector<bool> used(buckets);
+        std::size_t       occupied(0u);
+        for (std::uint64_t hash: hashes) {
+            std::size_t bucket((hash >> 10) & (buckets - 1u));
+            occupied += !used[bucket];
+            used[bucket] = true;
+        }
+        double n(keys.size()), m(buckets);
+        double expected(n - m * (1.0 - std::pow(1.0 - 1.0 / m, n)));
+
+        // flip each bit of the first 1000 keys
+        std::vector<std::size_t> flips(64u);
+        std::size_t              trials(0u);
+        for (std::size_t k(0u); k != std::min(keys.size(), std::size_t(1000u)); ++k) {
+            std::string key(keys[k]);
+            std::uint64_t hash(hashes[k]);
+            for (std::size_t bit(0u); bit != 8u * key.size(); ++bit, ++trials) {
+                key[bit / 8u] ^= char(1u << (bit % 8u));
+                std::uint64_t diff(hash ^ Hash::bytes(key.data(), key.size()));
+                key[bit / 8u] ^= char(1u << (bit % 8u));
+                for (std::size_t out(0u); out != 64u; ++out) {
+                    flips[out] += (diff >> out) & 1u;
+                }
+            }
+        }
+        double mean(0.0), bias(0.0);
+        for (std::size_t count: flips) {
+            double p(double(count) / trials);
+            mean += p / 64.0;
+            bias = std::max(bias, std::abs(p - 0.5));
+        }
+
+        std::ostringstream name;
+        name << std::left << std::setw(40) << Hash::name << " quality " << keyname
+             << " [" << keys.size() << "]";
+        std::ostringstream result;
+        result << "collisions=" << collisions
+               << " shared-buckets=" << (keys.size() - occupied)
+               << " expected=" << std::fixed << std::setprecision(0) << expected
+               << " avalanche=" << std::setprecision(4) << mean
+               << " worst-bias=" << bias;
+        context.report(name.str(), time, result.str());
+    }
+
+    template <typename... Hash>
+    void run_quality(cpu::tube::context& context, std::size_t size) {
+        std::vector<std::pair<char const*, std::vector<std::string>>> const keys{
+            { "codes",        cpu::tube::make_country_codes(size) },
+            { "short-paths",  make_paths(size, "/usr/local/include/") },
+            { "medium-paths", make_paths(size, "/some/medium/sized/path/as/a/prefix/"
+                                               "to/the/actual/interesting/names/") },
+            { "numbers",      make_paths(size, "") }
+        };
+        for (auto const& k: keys) {
+            (measure_quality<Hash>(context, k.first, k.second), ...);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    int size(ac == 1? 0: atoi(av[1]));
+    if (!DS::aes_hash::uses_aes()) {
+        std::cout << "AES-NI not available: aes_hash uses wy_hash\n";
+    }
+
+    run_throughput<std_hash,
+                   named<DS::fnv1a_hash>,
+                   named<DS::wy_hash>,
+                   named<DS::xxh3_hash>,
+                   named<DS::aes_hash>>(context);
+    run_quality<std_hash,
+                named<DS::fnv1a_hash>,
+                named<DS::wy_hash>,
+                named<DS::xxh3_hash>,
+                named<DS::aes_hash>>(context, size? size: 1u << 20);
+}
@@ -0,0 +1,277 @@
+// cpu/test/memory-hierarchy.cpp                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/processor.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/tube/threads.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+// Characterising the memory hierarchy:
+//
+// - The STREAM kernels copy (c = a), scale (b = s * c), add (c = a + b),
+//   and triad (a = b + s * c) on arrays of doubles which are much bigger
+//   than the caches, run with 1, 2, 4, ... threads. Each thread works on
+//   its own slice which it also initialised, i.e., first touch places the
+//   pages close to the thread. As for STREAM the best of a few repetitions
+//   is reported as bandwidth.
+// - Copy and triad are also run using non-temporal stores (if AVX is
+//   available) which bypass the caches and avoid reading the destination
+//   before writing it.
+// - The latency of dependent loads is measured by chasing pointers through
+//   a random cyclic permutation of cache lines for working sets from 4KB up
+//   to 4GB (limited to a quarter of the physical memory), i.e., the
+//   plateaus of the caches and the DRAM become visible.
+//
+// The results are saved as cpu::tube::memory_profile which other benchmarks
+// can use to relate their throughput to the achievable bandwidth.
+//
+// usage: memory-hierarchy [max-working-set-MB [stream-array-MB]]
+
+namespace {
+    constexpr std::size_t line{64u};
+    constexpr int         repetitions{5};
+
+    template <typename T>
+    struct aligned_array {
+        T*          data;
+        std::size_t size;
+        explicit aligned_array(std::size_t size)
+            : data(static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(line))))
+            , size(size) {
+        }
+        aligned_array(aligned_array const&) = delete;
+        void operator=(aligned_array const&) = delete;
+        ~aligned_array() { ::operator delete(this->data, std::align_val_t(line)); }
+    };
+
+    std::size_t physical_memory() {
+        return std::size_t(::sysconf(_SC_PHYS_PAGES)) * std::size_t(::sysconf(_SC_PAGESIZE));
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct stream_arrays {
+        aligned_array<double> a, b, c;
+        explicit stream_arrays(std::size_t size): a(size), b(size), c(size) {}
+    };
+
+    // The kernels process [begin, end) where begin and end are multiples of
+    // the number of doubles in a cache line.
+    using kernel = void (*)(stream_arrays&, std::size_t, std::size_t);
+    constexpr double scalar{3.0};
+
+    void copy(stream_arrays& s, std::size_t begin, std::size_t end) {
+        for (std::size_t i(begin); i != end; ++i) {
+            s.c.data[i] = s.a.data[i];
+        }
+    }
+    void scale(stream_arrays& s, std::size_t begin, std::size_t end) {
+        for (std::size_t i(begin); i != end; ++i) {
+            s.b.data[i] = scalar * s.c.data[i];
+        }
+    }
+    void add(stream_arrays& s, std::size_t begin, std::size_t end) {
+        for (std::size_t i(begin); i != end; ++i) {
+            s.c.data[i] = s.a.data[i] + s.b.data[i];
+        }
+    }
+    void triad(stream_arrays& s, std::size_t begin, std::size_t end) {
+        for (std::size_t i(begin); i != end; ++i) {
+            s.a.data[i] = s.b.data[i] + scalar * s.c.data[i];
+        }
+    }
+
+#if defined(__AVX__)
+    void nt_copy(stream_arrays& s, std::size_t begin, std::size_t end) {
+        for (std::size_t i(begin); i != end; i += 4u) {
+            _mm256_stream_pd(s.c.data + i, _mm256_load_pd(s.a.data + i));
+        }
+        _mm_sfence();
+    }
+    void nt_triad(stream_arrays& s, std::size_t begin, std::size_t end) {
+        __m256d const factor(_mm256_set1_pd(scalar));
+        for (std::size_t i(begin); i != end; i += 4u) {
+            _mm256_stream_pd(s.a.data + i,
+                             _mm256_add_pd(_mm256_load_pd(s.b.data + i),
+                                           _mm256_mul_pd(factor, _mm256_load_pd(s.c.data + i))));
+        }
+        _mm_sfence();
+    }
+#endif
+
+    std::size_t slice(std::size_t size, int t, int threads) {
+        constexpr std::size_t per_line(line / sizeof(double));
+        return (size * t / threads) / per_line * per_line;
+    }
+
+    // returns the best bandwidth in GB/s
+    double measure_stream(CT::context& context, stream_arrays& arrays, int threads,
+                          char const* name, kernel fun, int streams) {
+        std::size_t const size(arrays.a.size);
+        unsigned long     best(~0ul);
+        for (int r(0); r != repetitions; ++r) {
+            context.start();
+            CT::duration time(CT::run_threads(threads, [&](int t){
+                        fun(arrays, slice(size, t, threads), slice(size, t + 1, threads));
+                    }));
+            best = std::min(best, std::max(1ul, time.microseconds()));
+        }
+        double bandwidth(double(streams) * size * sizeof(double) / best / 1e3);
+        std::ostringstream out;
+        out << std::left << std::setw(20) << name << " [" << threads << "]";
+        std::ostringstream value;
+        value.precision(3);
+        value << bandwidth << "GB/s";
+        context.report(out.str(), CT::duration(std::chrono::microseconds(best)), value.str());
+        return bandwidth;
+    }
+
+    void run_stream(CT::context& context, std::size_t size, CT::memory_profile& profile) {
+        for (int threads: CT::thread_counts()) {
+            stream_arrays arrays(size);
+            CT::run_threads(threads, [&](int t){ // first touch by the thread using the slice
+                    for (std::size_t i(slice(size, t, threads)), end(slice(size, t + 1, threads));
+                         i != end; ++i) {
+                        arrays.a.data[i] = 1.0;
+                        arrays.b.data[i] = 2.0;
+                        arrays.c.data[i] = 0.0;
+                    }
+                });
+            auto best = [](double& to, double value){ to = std::max(to, value); };
+            best(profile.copy,  measure_stream(context, arrays, threads, "stream copy", copy, 2));
+            best(profile.scale, measure_stream(context, arrays, threads, "stream scale", scale, 2));
+            best(profile.add,   measure_stream(context, arrays, threads, "stream add", add, 3));
+            best(profile.triad, measure_stream(context, arrays, threads, "stream triad", triad, 3));
+#if defined(__AVX__)
+            best(profile.nt_copy,  measure_stream(context, arrays, threads, "stream nt copy", nt_copy, 2));
+            best(profile.nt_triad, measure_stream(context, arrays, threads, "stream nt triad", nt_triad, 3));
+#else
+            context.stub("stream nt copy");
+            context.stub("stream nt triad");
+#endif
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct alignas(line) node {
+        node* next;
+    };
+
+    // returns the ns per load
+    double measure_latency(CT::context& context, std::size_t bytes, std::mt19937_64& gen) {
+        std::size_t const          count(bytes / sizeof(node));
+        aligned_array<node>        nodes(count);
+        std::vector<std::uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::shuffle(order.begin() + 1, order.end(), gen);
+        for (std::size_t i(0u); i != count; ++i) {
+            nodes.data[order[i]].next = nodes.data + order[(i + 1u) % count];
+        }
+
+        std::size_t const loads(std::max(std::size_t(1u) << 22, 4u * count));
+        node const*       current(nodes.data);
+        for (std::size_t i(0u); i != count; ++i) { // warm up
+            current = current->next;
+        }
+        auto timer = context.start();
+        for (std::size_t i(0u); i != loads; ++i) {
+            current = current->next;
+        }
+        CT::duration time(timer.measure());
+        CT::escape(&current);
+
+        double latency(time.microseconds() * 1e3 / loads);
+        std::ostringstream out;
+        out << std::left << std::setw(20) << "pointer chase" << " [" << bytes << "]";
+        std::ostringstream value;
+        value.precision(3);
+        value << latency << "ns";
+        context.report(out.str(), time, value.str());
+        return latency;
+    }
+
+    void run_latency(CT::context& context, std::size_t max, CT::memory_profile& profile) {
+        std::mt19937_64 gen(17);
+        for (std::size_t bytes(4096u); bytes <= max; bytes *= 2u) {
+            profile.latency.emplace_back(bytes, measure_latency(context, bytes, gen));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    CT::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    std::size_t const mb(std::size_t(1u) << 20);
+    std::size_t max(std::min(std::size_t(4096u) * mb, physical_memory() / 4u));
+    std::size_t stream(128u * mb);
+    if (1 < ac) {
+        max = std::size_t(atol(av[1])) * mb;
+    }
+    if (2 < ac) {
+        stream = std::size_t(atol(av[2])) * mb;
+    }
+
+    CT::memory_profile profile;
+    run_stream(context, stream / sizeof(double), profile);
+    run_latency(context, max, profile);
+
+    ::mkdir("results", 0777);
+    std::string path(CT::memory_profile::path());
+    if (profile.save(path)) {
+        std::cout << "memory profile (" << path << "): " << profile << "\n";
+    }
+    else {
+        std::cout << "failed to save the memory profile to " << path << "\n";
+    }
+}
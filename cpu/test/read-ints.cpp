@@ -0,0 +1,334 @@
+// cpu/test/read-ints.cpp                                             -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/format/parse_number.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/lexical_cast.hpp>
+
+// ----------------------------------------------------------------------------
+// The counterpart of write-ints: whitespace separated numbers are parsed and
+// summed. The text uses the values written by write-ints, i.e., 1000 values
+// obtained from rand() per line, as well as full range 64 bit integers and
+// doubles formatted with a fixed number of decimals and with all significant
+// digits. Alternatively, the name of a file with integers (or doubles when
+// "double" is given as second argument) can be passed which is mapped into
+// memory and parsed.
+//
+// Some of the functions require a null-terminated string: the text is
+// always followed by a null character.
+
+namespace
+{
+    bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+    char const* skip_space(char const* it, char const* end) {
+        while (it != end && is_space(*it)) {
+            ++it;
+        }
+        return it;
+    }
+
+    template <typename T>
+    using sum_type = std::conditional_t<std::is_floating_point_v<T>, double, std::uint64_t>;
+
+    struct membuf
+        : std::streambuf
+    {
+        membuf(char const* begin, char const* end) {
+            this->setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+        }
+    };
+
+    struct istream_read
+    {
+        template <typename T>
+        static sum_type<T> sum(char const* begin, char const* end) {
+            membuf       sbuf(begin, end);
+            std::istream in(&sbuf);
+            sum_type<T>  rc{};
+            for (T value; in >> value; ) {
+                rc += value;
+            }
+            return rc;
+        }
+    };
+
+    struct strto_read
+    {
+        template <typename T>
+        static T convert(char const* it, char** next) {
+            if constexpr (std::is_floating_point_v<T>) {
+                return strtod(it, next);
+            }
+            else if constexpr (std::is_signed_v<T>) {
+                return T(strtol(it, next, 10));
+            }
+            else {
+                return T(strtoul(it, next, 10));
+            }
+        }
+        template <typename T>
+        static sum_type<T> sum(char const* begin, char const* end) {
+            sum_type<T> rc{};
+            for (char const* it(skip_space(begin, end)); it != end; it = skip_space(it, end)) {
+                char* next;
+                rc += convert<T>(it, &next);
+                if (next == it) {
+                    break;
+                }
+                it = next;
+            }
+            return rc;
+        }
+    };
+
+    struct lexical_cast_read
+    {
+        template <typename T>
+        static sum_type<T> sum(char const* begin, char const* end) {
+            sum_type<T> rc{};
+            for (char const* it(skip_space(begin, end)); it != end; it = skip_space(it, end)) {
+                char const* next(std::find_if(it, end, is_space));
+                rc += boost::lexical_cast<T>(it, next - it);
+                it = next;
+            }
+            return rc;
+        }
+    };
+
+    struct from_chars_read
+    {
+        template <typename T>
+        static sum_type<T> sum(char const* begin, char const* end) {
+            sum_type<T> rc{};
+            for (char const* it(skip_space(begin, end)); it != end; it = skip_space(it, end)) {
+                T value;
+                auto result(std::from_chars(it, end, value));
+                if (result.ec != std::errc()) {
+                    break;
+                }
+                rc += value;
+                it = result.ptr;
+            }
+            return rc;
+        }
+    };
+
+    struct parse_number_read
+    {
+        template <typename T>
+        static std::from_chars_result parse(char const* it, char const* end, T& value) {
+            if constexpr (std::is_floating_point_v<T>) {
+                return cpu::format::parse_double(it, end, value);
+            }
+            else {
+                return cpu::format::parse_int(it, end, value);
+            }
+        }
+        template <typename T>
+        static sum_type<T> sum(char const* begin, char const* end) {
+            sum_type<T> rc{};
+            for (char const* it(skip_space(begin, end)); it != end; it = skip_space(it, end)) {
+                T value;
+                auto result(parse(it, end, value));
+                if (result.ec != std::errc()) {
+                    break;
+                }
+                rc += value;
+                it = result.ptr;
+            }
+            return rc;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+// The file is mapped on top of an anonymous mapping which is one page larger
+// than the file: the bytes following the file are zero, i.e., the text is
+// null-terminated even if the file size is a multiple of the page size.
+
+namespace
+{
+    class mapped_file
+    {
+    private:
+        void*       d_address{MAP_FAILED};
+        std::size_t d_mapped{};
+        std::size_t d_size{};
+
+    public:
+        explicit mapped_file(char const* name) {
+            int fd(::open(name, O_RDONLY));
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), name);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) < 0) {
+                ::close(fd);
+                throw std::system_error(errno, std::generic_category(), "fstat()");
+            }
+            std::size_t page(::sysconf(_SC_PAGESIZE));
+            this->d_size   = st.st_size;
+            this->d_mapped = (this->d_size + page) / page * page;
+            this->d_address = ::mmap(nullptr, this->d_mapped, PROT_READ,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (this->d_address != MAP_FAILED && this->d_size != 0u
+                && ::mmap(this->d_address, this->d_size, PROT_READ,
+                          MAP_PRIVATE | MAP_FIXED | MAP_POPULATE, fd, 0) == MAP_FAILED) {
+                ::munmap(this->d_address, this->d_mapped);
+                this->d_address = MAP_FAILED;
+            }
+            int error(errno);
+            ::close(fd);
+            if (this->d_address == MAP_FAILED) {
+                throw std::system_error(error, std::generic_category(), "mmap()");
+            }
+        }
+        mapped_file(mapped_file const&) = delete;
+        void operator=(mapped_file const&) = delete;
+        ~mapped_file() { ::munmap(this->d_address, this->d_mapped); }
+
+        char const* begin() const { return static_cast<char const*>(this->d_address); }
+        char const* end() const { return this->begin() + this->d_size; }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    template <typename Generate>
+    std::string make_text(Generate generate) {
+        std::string rc;
+        for (int line(0); line != 1000; ++line) {
+            for (int i(0); i != 1000; ++i) {
+                rc += generate(i);
+                rc += ' ';
+            }
+            rc += '\n';
+        }
+        return rc;
+    }
+
+    template <typename T, typename Read>
+    void measure(cpu::tube::context& context, std::string const& name,
+                 char const* begin, char const* end, sum_type<T> expect)
+    {
+        auto timer = context.start();
+        sum_type<T> result(Read::template sum<T>(begin, end));
+        auto time = timer.measure();
+        cpu::tube::prevent_optimize_away(result);
+
+        std::ostringstream out;
+        double microseconds(time.microseconds());
+        out << "MB/s=" << (microseconds == 0.0? 0.0: (end - begin) / microseconds);
+        if (result != expect) {
+            out << " wrong-sum";
+        }
+        context.report(name, time, out.str());
+    }
+
+    template <typename T>
+    void run(cpu::tube::context& context, char const* kind,
+             char const* begin, char const* end)
+    {
+        sum_type<T> expect(from_chars_read::sum<T>(begin, end));
+        std::string suffix(std::string(" [") + kind + "]");
+        measure<T, istream_read>(context, "istream >>" + suffix, begin, end, expect);
+        measure<T, strto_read>(context, (std::is_floating_point_v<T>? "strtod()": "strtol()") + suffix,
+                               begin, end, expect);
+        measure<T, lexical_cast_read>(context, "boost::lexical_cast()" + suffix, begin, end, expect);
+        measure<T, from_chars_read>(context, "std::from_chars()" + suffix, begin, end, expect);
+        measure<T, parse_number_read>(context, (std::is_floating_point_v<T>? "parse_double()": "parse_int()") + suffix,
+                                      begin, end, expect);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    try
+    {
+        cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+        if (1 < ac) {
+            mapped_file file(av[1]);
+            if (2 < ac && std::string(av[2]) == "double") {
+                run<double>(context, "file", file.begin(), file.end());
+            }
+            else {
+                run<long>(context, "file", file.begin(), file.end());
+            }
+            return 0;
+        }
+
+        std::vector<int> values;
+        std::generate_n(std::back_inserter(values), 1000, &rand);
+        std::string const ints(make_text([&](int i){ return std::to_string(values[i]); }));
+        run<int>(context, "rand()", ints.data(), ints.data() + ints.size());
+
+        std::mt19937_64 gen(4711);
+        std::string const longs(make_text([&](int){ return std::to_string(gen()); }));
+        run<unsigned long>(context, "64 bit", longs.data(), longs.data() + longs.size());
+
+        auto format = [](char const* fmt, double value) {
+            char buffer[64];
+            return std::string(buffer, snprintf(buffer, sizeof(buffer), fmt, value));
+        };
+        std::string const fixed(make_text([&](int i){ return format("%.3f", values[i] / 1000.0); }));
+        run<double>(context, "fixed", fixed.data(), fixed.data() + fixed.size());
+
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        std::string const shortest(make_text([&](int){ return format("%.17g", dist(gen)); }));
+        run<double>(context, "%.17g", shortest.data(), shortest.data() + shortest.size());
+    }
+    catch (std::exception const& ex)
+    {
+        std::cerr << "ERROR: " << ex.what() << "\n";
+        return 1;
+    }
+}
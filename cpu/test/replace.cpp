@@ -1,12 +1,16 @@
 #include "cpu/tube/context.hpp"
+#include "cpu/test/stream-filters.hpp"
 #include <algorithm>
 #include <fstream>
 #include <iterator>
 #include <numeric>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
 #include <vector>
 
 // ----------------------------------------------------------------------------
@@ -42,6 +46,14 @@ namespace
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+    using test::use_regex_dfa;
+    using test::use_char_filter;
+}
+
+// ----------------------------------------------------------------------------
+
 namespace
 {
     struct use_remove_if_str_find
@@ -175,18 +187,38 @@ namespace test
 int main(int ac, char* av[])
 {
     cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    std::string allowed("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-");
+
+    std::string path;
+    if (test::stream_requested(ac, av, path)) {
+        test::measure_stream(context, "use_remove_if_table", path, use_remove_if_table(allowed));
+        test::measure_stream(context, "regex_dfa", path, use_regex_dfa<false>(allowed));
+        test::measure_stream(context, "regex_dfa (interleaved)", path, use_regex_dfa<true>(allowed));
+        test::measure_stream(context, "char_filter (scalar)", path, use_char_filter<&cpu::algorithm::char_filter::filter_scalar>(allowed));
+        test::measure_stream(context, "char_filter (sse4.2)", path, use_char_filter<&cpu::algorithm::char_filter::filter_sse42>(allowed));
+        test::measure_stream(context, "char_filter (avx2)", path, use_char_filter<&cpu::algorithm::char_filter::filter_avx2>(allowed));
+        return 0;
+    }
 
     std::ifstream in("cpu/test/input.txt");
     std::string text((std::istreambuf_iterator<char>(in)),
                       std::istreambuf_iterator<char>());
-    std::string allowed("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-");
+    if (text.empty()) {
+        // the input file isn't available: use synthesised text
+        text = cpu::tube::generate_text(1u << 22);
+    }
 
     test::measure(context, "regex (build)",    text, use_regex_build(allowed));
     test::measure(context, "regex (prebuild)", text, use_regex_prebuild(allowed));
+    test::measure(context, "regex_dfa", text, use_regex_dfa<false>(allowed));
+    test::measure(context, "regex_dfa (interleaved)", text, use_regex_dfa<true>(allowed));
     test::measure(context, "use_remove_if_str_find", text, use_remove_if_str_find(allowed));
     test::measure(context, "use_remove_if_find", text, use_remove_if_find(allowed));
     test::measure(context, "use_remove_if_binary_search", text, use_remove_if_binary_search(allowed));
     test::measure(context, "use_remove_if_ctype", text, use_remove_if_ctype(allowed));
     test::measure(context, "use_remove_if_hash", text, use_remove_if_hash(allowed));
     test::measure(context, "use_remove_if_table", text, use_remove_if_table(allowed));
+    test::measure(context, "char_filter (scalar)", text, use_char_filter<&cpu::algorithm::char_filter::filter_scalar>(allowed));
+    test::measure(context, "char_filter (sse4.2)", text, use_char_filter<&cpu::algorithm::char_filter::filter_sse42>(allowed));
+    test::measure(context, "char_filter (avx2)", text, use_char_filter<&cpu::algorithm::char_filter::filter_avx2>(allowed));
 }
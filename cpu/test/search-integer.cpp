@@ -24,12 +24,21 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/lookup.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/data-structures/hash_set.hpp"
+#include "cpu/data-structures/flat_set.hpp"
+#include "cpu/data-structures/eytzinger_set.hpp"
+#include "cpu/data-structures/static_btree_set.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <numeric>
+#include <random>
 #include <set>
 #if !defined(__INTEL_COMPILER)
 #include <unordered_set>
@@ -44,6 +53,8 @@
 #endif
 #include <stdlib.h>
 
+namespace DS = cpu::data_structures;
+
 // ----------------------------------------------------------------------------
 
 namespace
@@ -138,6 +149,57 @@ namespace
     };
 #endif
 
+    // Cache-friendly ordered competitors not requiring boost or Google's
+    // b-tree: a sorted vector, an Eytzinger layout, and a static b-tree.
+    template <typename Set>
+    struct ordered_set_find
+    {
+        Set d_values;
+        ordered_set_find(std::vector<int> const& values)
+            : d_values(values.begin(), values.end()) {}
+        bool contains(int value) const {
+            return this->d_values.contains(value);
+        }
+    };
+    using flat_set_find         = ordered_set_find<DS::flat_set<int>>;
+    using eytzinger_set_find    = ordered_set_find<DS::eytzinger_set<int>>;
+    using static_btree_set_find = ordered_set_find<DS::static_btree_set<int>>;
+
+    // std::hash<int> is the identity which puts runs of consecutive
+    // integers into the same bucket of data_structures::hash_set.
+    struct mix_hash {
+        std::size_t operator()(int value) const {
+            std::uint64_t h(static_cast<unsigned int>(value));
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
+    struct hash_set_find
+    {
+        DS::hash_set<int, mix_hash> d_values;
+        hash_set_find(std::vector<int> const& values)
+            : d_values(values.begin(), values.end()) {}
+        bool contains(int value) const {
+            return this->d_values.find(value) != this->d_values.end();
+        }
+    };
+
+    struct hash_set_batch_find
+        : hash_set_find
+    {
+        using hash_set_find::hash_set_find;
+        template <typename FwdIt>
+        long contains_batch(FwdIt it, FwdIt end) const {
+            long total(0);
+            this->d_values.contains_batch(it, end, cpu::tube::count_iterator(total));
+            return total;
+        }
+    };
 }
 
 // ----------------------------------------------------------------------------
@@ -149,25 +211,15 @@ namespace
                  std::vector<int> const& sought,
                  char const*             name,
                  int                     size,
-                 Competitor const&       competitor)
+                 Competitor const&       competitor,
+                 int                     repetitions = 1000)
     {
-        long total(0);
-        typedef std::vector<int>::const_iterator const_iterator;
-        for (const_iterator it(sought.begin()), end(sought.end());
-             it != end; ++it) {
-            if (competitor.contains(*it)) {
-                ++total;
-            }
-        }
+        long total(cpu::tube::count_contained(competitor, sought));
 
         auto timer = context.start();
-        for (int i(0); i != 1000; ++i) {
-            for (const_iterator it(sought.begin()), end(sought.end());
-                 it != end; ++it) {
-                if (competitor.contains(*it)) {
-                    ++total;
-                }
-            }
+        for (int i(0); i != repetitions; ++i) {
+            total += cpu::tube::count_contained(competitor, sought);
+            cpu::tube::prevent_optimize_away(total); // don't hoist the lookups
         }
         auto time = timer.measure();
 
@@ -225,6 +277,39 @@ namespace
             context.stub(out.str());
         }
 #endif
+        measure(context, sought, "data_structures::flat set find()", size, flat_set_find(values));
+        measure(context, sought, "data_structures::eytzinger set find()", size, eytzinger_set_find(values));
+        measure(context, sought, "data_structures::static b-tree set find()", size, static_btree_set_find(values));
+        measure(context, sought, "data_structures::hash set find()", size, hash_set_find(values));
+        measure(context, sought, "data_structures::hash set contains_batch()", size, hash_set_batch_find(values));
+    }
+
+    // Tables well beyond the size of the last level cache: the keys are
+    // sampled without the quadratic uniqueness check and the sought keys are
+    // too many to stay cached between repetitions.
+    void run_large_tests(cpu::tube::context& context, int size) {
+        std::mt19937 gen(4711);
+        std::vector<int> values(size + size / 2);
+        std::iota(values.begin(), values.end(), 0);
+        std::shuffle(values.begin(), values.end(), gen);
+        values.resize(size);
+        std::sort(values.begin(), values.end());
+
+        std::uniform_int_distribution<int> rand(0, size + size / 2 - 1);
+        std::vector<int> sought;
+        sought.reserve(1 << 20);
+        while (sought.size() != 1u << 20) {
+            sought.push_back(rand(gen));
+        }
+
+        measure(context, sought, "vector lower_bound()",       size, vector_lower_bound(values), 10);
+#if !defined(__INTEL_COMPILER)
+        measure(context, sought, "unordered set find()",       size, unordered_set_find(values), 10);
+#endif
+        measure(context, sought, "data_structures::eytzinger set find()", size, eytzinger_set_find(values), 10);
+        measure(context, sought, "data_structures::static b-tree set find()", size, static_btree_set_find(values), 10);
+        measure(context, sought, "data_structures::hash set find()", size, hash_set_find(values), 10);
+        measure(context, sought, "data_structures::hash set contains_batch()", size, hash_set_batch_find(values), 10);
     }
 }
 
@@ -243,6 +328,9 @@ int main(int ac, char* av[])
                 run_tests(context, i * j);
             }
         }
+        for (int i(1 << 20); i <= 1 << 23; i *= 2) {
+            run_large_tests(context, i);
+        }
     }
 }
 
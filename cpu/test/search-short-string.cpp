@@ -24,13 +24,19 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/lookup.hpp"
+#include "cpu/tube/keys.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/data-structures/hash.hpp"
 #include "cpu/data-structures/hash_set.hpp"
+#include "cpu/data-structures/flat_set.hpp"
+#include "cpu/data-structures/eytzinger_set.hpp"
+#include "cpu/data-structures/static_btree_set.hpp"
 
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
-#include <random>
 #include <set>
 #include <string>
 #include <sstream>
@@ -143,36 +149,56 @@ namespace
         }
     };
 
-    template <typename T, int = std::numeric_limits<T>::digits>
-    inline constexpr T fnv_basis;
-    template <typename T> inline constexpr T fnv_basis<T, 32>{0x811c9dc5};
-    template <typename T> inline constexpr T fnv_basis<T, 64>{0xcbf29ce484222325};
+    struct fnv1a_set_find
+    {
+        DS::hash_set<string_type, DS::fnv1a_hash> d_values;
+        fnv1a_set_find(std::vector<string_type> const& values)
+            : d_values(values.begin(), values.end()) {}
+        bool contains(string_type value) const {
+            return this->d_values.find(value) != this->d_values.end();
+        }
+    };
 
-    template <typename T, int = std::numeric_limits<T>::digits>
-    inline constexpr T fnv_prime;
-    template <typename T> inline constexpr T fnv_prime<T, 32>{16777619};
-    template <typename T> inline constexpr T fnv_prime<T, 64>{1099511628211};
+    template <typename Hash>
+    struct hashed_set_find
+    {
+        DS::hash_set<string_type, Hash> d_values;
+        hashed_set_find(std::vector<string_type> const& values)
+            : d_values(values.begin(), values.end()) {}
+        bool contains(string_type const& value) const {
+            return this->d_values.find(value) != this->d_values.end();
+        }
+    };
+    using wy_set_find  = hashed_set_find<DS::wy_hash>;
+    using aes_set_find = hashed_set_find<DS::aes_hash>;
 
-    struct fnv1a {
-        std::size_t operator()(string_type const& s) const {
-            std::size_t result{fnv_basis<std::size_t>};
-            for (unsigned char octet: s) {
-                result ^= octet;
-                result *= fnv_prime<std::size_t>;
-            }
-            return result;
+    struct fnv1a_set_batch_find
+        : fnv1a_set_find
+    {
+        using fnv1a_set_find::fnv1a_set_find;
+        template <typename FwdIt>
+        long contains_batch(FwdIt it, FwdIt end) const {
+            long total(0);
+            this->d_values.contains_batch(it, end, cpu::tube::count_iterator(total));
+            return total;
         }
     };
 
-    struct fnv1a_set_find
+    // Ordered competitors with a cache-friendly layout not requiring
+    // Google's b-tree.
+    template <typename Set>
+    struct ordered_set_find
     {
-        DS::hash_set<string_type, fnv1a> d_values;
-        fnv1a_set_find(std::vector<string_type> const& values)
+        Set d_values;
+        ordered_set_find(std::vector<string_type> const& values)
             : d_values(values.begin(), values.end()) {}
-        bool contains(string_type value) const {
-            return this->d_values.find(value) != this->d_values.end();
+        bool contains(string_type const& value) const {
+            return this->d_values.contains(value);
         }
     };
+    using flat_set_find         = ordered_set_find<DS::flat_set<string_type>>;
+    using eytzinger_set_find    = ordered_set_find<DS::eytzinger_set<string_type>>;
+    using static_btree_set_find = ordered_set_find<DS::static_btree_set<string_type>>;
 
 #if defined(HAS_GOOGLE_BTREE)
     struct btree_set_find
@@ -199,23 +225,12 @@ namespace
                  int                             size,
                  Competitor const&               competitor)
     {
-        long total(0);
-        typedef std::vector<string_type>::const_iterator const_iterator;
-        for (const_iterator it(sought.begin()), end(sought.end());
-             it != end; ++it) {
-            if (competitor.contains(*it)) {
-                ++total;
-            }
-        }
+        long total(cpu::tube::count_contained(competitor, sought));
 
         auto timer = context.start();
         for (int i(0); i != 1000; ++i) {
-            for (const_iterator it(sought.begin()), end(sought.end());
-                 it != end; ++it) {
-                if (competitor.contains(*it)) {
-                    ++total;
-                }
-            }
+            total += cpu::tube::count_contained(competitor, sought);
+            cpu::tube::prevent_optimize_away(total); // don't hoist the lookups
         }
 
         auto time = timer.measure();
@@ -266,34 +281,18 @@ namespace
         }
 #endif
         measure(context, sought, "boost unordered set find()", size, boost_unordered_set_find(values));
+        measure(context, sought, "data_structures::flat set find()", size, flat_set_find(values));
+        measure(context, sought, "data_structures::eytzinger set find()", size, eytzinger_set_find(values));
+        measure(context, sought, "data_structures::static b-tree set find()", size, static_btree_set_find(values));
         measure(context, sought, "data_structures::hash set find()", size, hash_set_find(values));
         measure(context, sought, "data_structures::hash set (fnv1a) find()", size, fnv1a_set_find(values));
+        measure(context, sought, "data_structures::hash set (fnv1a) contains_batch()", size, fnv1a_set_batch_find(values));
+        measure(context, sought, "data_structures::hash set (wy_hash) find()", size, wy_set_find(values));
+        measure(context, sought, "data_structures::hash set (aes_hash) find()", size, aes_set_find(values));
 #if defined(HAS_GOOGLE_BTREE)
         measure(context, sought, "b-tree set find()",          size, btree_set_find(values));
 #endif
     }
-
-    std::vector<string_type> make_strings(unsigned int size)
-    {
-        std::minstd_rand   rand;
-        rand.seed(17);
-
-        string_type codes[] = {
-            "BE", "DE", "DK", "FR", "GB", "JP", "NL", "NO", "SE", "US"
-        };
-
-        boost::unordered_set<string_type> rc;
-        std::ostringstream out;
-        out.fill('0');
-        while (rc.size() < size) {
-            out.str(std::string());
-            out << codes[rand() % 10]
-                << std::setw(9) << (rand() % 1000000000) << '0';
-            string_type value(out.str().c_str());
-            rc.insert(value);
-        }
-        return std::vector<string_type>(rc.begin(), rc.end());
-    }
 }
 
 // ----------------------------------------------------------------------------
@@ -303,7 +302,7 @@ int main(int ac, char* av[])
     cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
     int size(ac == 1? 0: atoi(av[1]));
     int const max = 100000;
-    std::vector<string_type> strings(make_strings(2 * (size? size: max * 20)));
+    std::vector<string_type> strings(cpu::tube::make_country_codes<string_type>(2 * (size? size: max * 20)));
     if (size) {
         run_tests(context, size, strings);
     }
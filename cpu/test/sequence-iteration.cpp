@@ -24,6 +24,7 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/memory/allocation_policy.hpp"
 
 #include <algorithm>
 #if !defined(__INTEL_COMPILER)
@@ -43,7 +44,8 @@
 #include <unordered_set>
 #endif
 #include <vector>
-#if !defined(__INTEL_COMPILER)
+#if !defined(__INTEL_COMPILER) && __has_include("google/cpp-btree/btree_set.h")
+#define HAS_BTREE
 #include "google/cpp-btree/btree_set.h"
 #endif
 
@@ -71,6 +73,10 @@ namespace test
     Cont initialize(T const* begin, T const* end) {
         return Cont(begin, end);
     }
+    template <typename Cont, typename T, typename Alloc>
+    Cont initialize(T const* begin, T const* end, Alloc const& alloc) {
+        return Cont(begin, end, alloc);
+    }
 
 #if !defined(__INTEL_COMPILER)
     template <>
@@ -125,14 +131,15 @@ namespace test
     }
 #endif
 
-    template <typename Cont>
-    void measure(cpu::tube::context& context, std::string const& name) {
+    template <typename Cont, typename... Alloc>
+    void measure(cpu::tube::context& context, std::string const& name,
+                 Alloc const&... alloc) {
         typename Cont::value_type array[511];
         for (int i(0); i != std::end(array) - std::begin(array); ++i) {
             array[i] = i;
         }
 
-        Cont cont = test::initialize<Cont>(std::begin(array), std::end(array));
+        Cont cont = test::initialize<Cont>(std::begin(array), std::end(array), alloc...);
         long tmp = std::accumulate(cont.begin(), cont.end(), 0);
         tmp += std::accumulate(cont.begin(), cont.end(), 0);
 
@@ -211,11 +218,22 @@ namespace test
 #endif
         test::measure<std::vector<T> >(context, "std::vector<" + type + ">");
         test::measure<test::array<T, 511> >(context, "test::array<" + type + ", 511>");
-#if !defined(__INTEL_COMPILER)
+#if defined(HAS_BTREE)
         test::measure<btree::btree_set<T> >(context, "btree::btree_set<" + type + ">");
 #else
         context.stub("btree::btree_set<" + type + ">");
 #endif
+
+        // The node based containers with the nodes from an allocation policy.
+        cpu::memory::for_each_allocation_policy([&](std::string const& name, auto policy){
+                using Alloc = typename decltype(policy)::template allocator_type<T>;
+                test::measure<std::list<T, Alloc> >(context, "std::list<" + type + "> [" + name + "]",
+                                                    policy.template allocator<T>());
+                policy.release();
+                test::measure<std::set<T, std::less<T>, Alloc> >(context, "std::set<" + type + "> [" + name + "]",
+                                                                 policy.template allocator<T>());
+                policy.release();
+            });
     }
 }
 
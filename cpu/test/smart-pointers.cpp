@@ -24,21 +24,36 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/tube/protect.hpp"
+#include "cpu/tube/threads.hpp"
+#include "cpu/memory/allocation_policy.hpp"
+#include "cpu/memory/biased_ptr.hpp"
+#include "cpu/memory/counted_ptr.hpp"
+#include "cpu/memory/intrusive_ptr.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#if defined(HAS_BSL)
 #include <bsl_memory.h>
 #include <bslma_managedptr.h>
 
 using namespace BloombergLP;
+#endif
 
 // ----------------------------------------------------------------------------
 
@@ -81,6 +96,7 @@ namespace cputube
         }
         rc_ptr& operator=(rc_ptr other) {
             other.swap(*this);
+            return *this;
         }
         ~rc_ptr() {
             if (--this->rep_->count == 0) {
@@ -142,6 +158,7 @@ namespace cputube
         }
         mv_ptr& operator=(mv_ptr other) {
             other.swap(*this);
+            return *this;
         }
         ~mv_ptr() {
             if (this->rep_ && --this->rep_->count == 0) {
@@ -244,6 +261,104 @@ namespace
         }
     };
 
+    // The intrusive pointers need the count in the object: the value is
+    // wrapped into a class deriving from ref_counted.
+    template <typename T, typename Count>
+    struct intrusive_value
+        : cpu::memory::ref_counted<intrusive_value<T, Count>, Count>
+    {
+        T value;
+        explicit intrusive_value(int value): value(value) {}
+        operator int() const { return this->value; }
+    };
+
+    template <typename T, typename Count>
+    struct intrusive_config
+    {
+        using type = cpu::memory::intrusive_ptr<intrusive_value<T, Count>>;
+        template <typename... Args>
+        type make(Args&&... args) const {
+            return cpu::memory::make_intrusive<intrusive_value<T, Count>>(std::forward<Args>(args)...);
+        }
+        void kill(type const&) const {
+        }
+    };
+
+    template <typename T, typename Count>
+    struct counted_config
+    {
+        using type = cpu::memory::counted_ptr<T, Count>;
+        template <typename... Args>
+        type make(Args&&... args) const {
+            return cpu::memory::make_counted<T, Count>(std::forward<Args>(args)...);
+        }
+        void kill(type const&) const {
+        }
+    };
+
+    template <typename T>
+    struct biased_config
+    {
+        using type = cpu::memory::biased_ptr<T>;
+        template <typename... Args>
+        type make(Args&&... args) const {
+            return cpu::memory::make_biased<T>(std::forward<Args>(args)...);
+        }
+        void kill(type const&) const {
+        }
+        void release() const {
+            cpu::memory::biased_collect(); // objects released by other threads
+        }
+    };
+
+    // The configurations using an allocation policy: the policy's memory is
+    // released after each run.
+    template <typename T, typename Policy>
+    struct allocate_shared_config
+    {
+        using type = std::shared_ptr<T>;
+        Policy policy;
+        template <typename... Args>
+        type make(Args&&... args) const {
+            return std::allocate_shared<T>(this->policy.template allocator<T>(),
+                                           std::forward<Args>(args)...);
+        }
+        void kill(type const&) const {
+        }
+        void release() const {
+            this->policy.release();
+        }
+    };
+
+    template <typename T, typename Policy>
+    struct allocate_unique_config
+    {
+        using allocator = typename Policy::template allocator_type<T>;
+        using traits    = std::allocator_traits<allocator>;
+        struct deleter {
+            allocator alloc;
+            void operator()(T* ptr) {
+                traits::destroy(this->alloc, ptr);
+                traits::deallocate(this->alloc, ptr, 1u);
+            }
+        };
+        using type = std::unique_ptr<T, deleter>;
+        Policy policy;
+        template <typename... Args>
+        type make(Args&&... args) const {
+            allocator alloc(this->policy.template allocator<T>());
+            T*        ptr(traits::allocate(alloc, 1u));
+            traits::construct(alloc, ptr, std::forward<Args>(args)...);
+            return type(ptr, deleter{alloc});
+        }
+        void kill(type const&) const {
+        }
+        void release() const {
+            this->policy.release();
+        }
+    };
+
+#if defined(HAS_BSL)
     template <typename T>
     struct bsl_shared_config
     {
@@ -268,6 +383,7 @@ namespace
         void kill(type const&) const {
         }
     };
+#endif
 
 }
 
@@ -288,10 +404,18 @@ namespace
 
 namespace
 {
+    template <typename Competitor>
+    auto release(Competitor const& competitor, int) -> decltype(competitor.release()) {
+        competitor.release();
+    }
+    template <typename Competitor>
+    void release(Competitor const&, long) {
+    }
+
     struct runner
     {
         template <typename Competitor>
-        std::pair<cpu::tube::duration, unsigned int>
+        cpu::tube::measurement<unsigned int>
         measure(cpu::tube::context& context,
                 int                 size,
                 Competitor const&   competitor) const
@@ -310,8 +434,52 @@ namespace
                     competitor.kill(ptr);
                 }
             }
+            release(competitor, 0);
+            auto time = timer.measure();
+            // the items are the pointers, i.e., the results are per pointer
+            return cpu::tube::make_measurement(time, sum, cpu::tube::work{ 0u, std::uint64_t(size) });
+        }
+    };
+
+    // The pointers are created by one thread and copied, read, and destroyed
+    // concurrently by this thread and another one, i.e., the reference
+    // counts are shared between threads.
+    struct sharing_runner
+    {
+        template <typename Competitor>
+        static unsigned int copy_and_sum(std::vector<typename Competitor::type> const& container) {
+            std::vector<typename Competitor::type> copies(container);
+            unsigned int sum{};
+            for (auto&& ptr: copies) {
+                sum += *ptr;
+            }
+            return sum;
+        }
+
+        template <typename Competitor>
+        cpu::tube::measurement<unsigned int>
+        measure(cpu::tube::context& context,
+                int                 size,
+                Competitor const&   competitor) const
+        {
+            auto timer = context.start();
+
+            unsigned int sum{};
+            {
+                std::vector<typename Competitor::type> container;
+                container.reserve(size);
+                for (int i(0); i != size; ++i) {
+                    container.emplace_back(competitor.make(i));
+                }
+                unsigned int other{};
+                std::thread thread([&]{ other = copy_and_sum<Competitor>(container); });
+                sum = copy_and_sum<Competitor>(container);
+                thread.join();
+                sum += other;
+            }
+            release(competitor, 0);
             auto time = timer.measure();
-            return std::make_pair(time, sum);
+            return cpu::tube::make_measurement(time, sum, cpu::tube::work{ 0u, std::uint64_t(size) });
         }
     };
 
@@ -324,12 +492,243 @@ namespace
                     cpu::tube::make_test_case("std::shared_ptr<" + type + ">", shared_config<T>()),
                     cpu::tube::make_test_case("boost::shared_ptr<" + type + ">", boost_shared_config<T>()),
                     cpu::tube::make_test_case("rc_ptr<" + type + ">", rc_config<T>()),
-                    cpu::tube::make_test_case("mv_ptr<" + type + ">", mv_config<T>()),
+                    cpu::tube::make_test_case("intrusive_ptr<" + type + ">(unsynchronized)",
+                                              intrusive_config<T, cpu::memory::unsynchronized_count>()),
+                    cpu::tube::make_test_case("intrusive_ptr<" + type + ">(atomic)",
+                                              intrusive_config<T, cpu::memory::atomic_count>()),
+                    cpu::tube::make_test_case("local_ptr<" + type + ">",
+                                              counted_config<T, cpu::memory::unsynchronized_count>()),
+                    cpu::tube::make_test_case("shared_counted_ptr<" + type + ">",
+                                              counted_config<T, cpu::memory::atomic_count>()),
+                    cpu::tube::make_test_case("biased_ptr<" + type + ">", biased_config<T>()),
+#if defined(HAS_BSL)
 #if !defined(__INTEL_COMPILER)
                     cpu::tube::make_test_case("bslma::ManagedPtr<" + type + ">", bslma_managed_config<T>()),
 #endif
-                    cpu::tube::make_test_case("bsl::shared_ptr<" + type + ">", bsl_shared_config<T>())
+                    cpu::tube::make_test_case("bsl::shared_ptr<" + type + ">", bsl_shared_config<T>()),
+#endif
+                    cpu::tube::make_test_case("mv_ptr<" + type + ">", mv_config<T>())
+                    );
+
+        // only the pointers whose counts can be shared between threads
+        context.run(10, 100000, type + " (shared between threads)", sharing_runner(),
+                    cpu::tube::make_test_case("std::shared_ptr<" + type + ">", shared_config<T>()),
+                    cpu::tube::make_test_case("boost::shared_ptr<" + type + ">", boost_shared_config<T>()),
+                    cpu::tube::make_test_case("intrusive_ptr<" + type + ">(atomic)",
+                                              intrusive_config<T, cpu::memory::atomic_count>()),
+                    cpu::tube::make_test_case("shared_counted_ptr<" + type + ">",
+                                              counted_config<T, cpu::memory::atomic_count>()),
+                    cpu::tube::make_test_case("biased_ptr<" + type + ">", biased_config<T>())
                     );
+
+        cpu::memory::for_each_allocation_policy([&](std::string const& name, auto policy){
+                using Policy = decltype(policy);
+                context.run(10, 100000, type + " (" + name + ")", runner(),
+                            cpu::tube::make_test_case("std::allocate_shared<" + type + ">(" + name + ")",
+                                                      allocate_shared_config<T, Policy>{policy}),
+                            cpu::tube::make_test_case("std::unique_ptr<" + type + ">(" + name + ")",
+                                                      allocate_unique_config<T, Policy>{policy})
+                            );
+            });
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Contention mode: N threads repeatedly copy and destroy a pointer, i.e.,
+// they increment and decrement a reference count. The control blocks are
+// arranged according to a layout:
+//
+// - same:     all threads use the same control block
+// - disjoint: each thread uses its own control block on separate cache lines
+// - packed:   each thread uses its own control block but the blocks are
+//             adjacent, i.e., neighbouring blocks share cache lines
+//
+// The control blocks are placed using an allocator handing out slots of an
+// arena, i.e., only pointers supporting allocate_shared() are used. The
+// operations are timed in batches and the per-operation latency of the
+// batches is reported as percentiles together with the throughput and the
+// speedup relative to one thread (the scaling curve).
+
+namespace
+{
+    enum class layout { same, disjoint, packed };
+
+    char const* to_string(layout l) {
+        switch (l) {
+        case layout::same:     return "same";
+        case layout::disjoint: return "disjoint";
+        case layout::packed:   return "packed";
+        }
+        return "unknown";
+    }
+
+    class slot_arena
+    {
+    private:
+        static constexpr std::size_t line{64u};
+        static constexpr std::size_t slot_size{256u};
+        bool  d_packed;
+        char* d_memory;
+
+    public:
+        slot_arena(int slots, bool packed)
+            : d_packed(packed)
+            , d_memory(static_cast<char*>(::operator new(slots * slot_size,
+                                                         std::align_val_t(line)))) {
+        }
+        slot_arena(slot_arena const&) = delete;
+        void operator=(slot_arena const&) = delete;
+        ~slot_arena() { ::operator delete(this->d_memory, std::align_val_t(line)); }
+
+        // disjoint slots are two cache lines apart to also avoid sharing
+        // due to the adjacent line prefetcher
+        void* slot(int index, std::size_t size) {
+            std::size_t stride(this->d_packed
+                               ? (size + 15u) & ~std::size_t(15u)
+                               : (size + 2u * line - 1u) & ~std::size_t(2u * line - 1u));
+            if (slot_size < stride) {
+                throw std::bad_alloc();
+            }
+            return this->d_memory + index * stride;
+        }
+    };
+
+    template <typename T>
+    struct slot_allocator
+    {
+        using value_type = T;
+        slot_arena* arena;
+        int         index;
+
+        slot_allocator(slot_arena* arena, int index): arena(arena), index(index) {}
+        template <typename S>
+        slot_allocator(slot_allocator<S> const& other): arena(other.arena), index(other.index) {}
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(this->arena->slot(this->index, n * sizeof(T)));
+        }
+        void deallocate(T*, std::size_t) {}
+
+        template <typename S>
+        bool operator== (slot_allocator<S> const& other) const {
+            return this->arena == other.arena && this->index == other.index;
+        }
+        template <typename S>
+        bool operator!= (slot_allocator<S> const& other) const {
+            return !(*this == other);
+        }
+    };
+
+    template <typename T>
+    struct shared_contention
+    {
+        using type = std::shared_ptr<T>;
+        type make(slot_allocator<T> const& alloc, int value) const {
+            return std::allocate_shared<T>(alloc, value);
+        }
+    };
+
+    template <typename T>
+    struct boost_shared_contention
+    {
+        using type = boost::shared_ptr<T>;
+        type make(slot_allocator<T> const& alloc, int value) const {
+            return boost::allocate_shared<T>(alloc, value);
+        }
+    };
+
+    struct contention_result
+    {
+        cpu::tube::duration time;        // the wall clock time of all threads
+        std::vector<double> latencies;   // sorted per-operation ns of the batches
+        long                operations;
+        double              base;        // operations/s using one thread
+
+        double percentile(double p) const {
+            return this->latencies[std::size_t(p * (this->latencies.size() - 1u))];
+        }
+        double per_second() const {
+            return this->operations * 1e6 / std::max(1ul, this->time.microseconds());
+        }
+    };
+
+    std::ostream& operator<< (std::ostream& out, contention_result const& result) {
+        std::ostringstream str; // don't change out's formatting
+        str.setf(std::ios_base::fixed);
+        str.precision(1);
+        str << "p50=" << result.percentile(0.5) << "ns"
+            << ",p90=" << result.percentile(0.9) << "ns"
+            << ",p99=" << result.percentile(0.99) << "ns"
+            << ",p99.9=" << result.percentile(0.999) << "ns"
+            << ",ops=" << result.per_second() / 1e6 << "M/s";
+        str.precision(2);
+        str << ",speedup=" << result.per_second() / result.base;
+        return out << str.str();
+    }
+
+    struct contention_runner
+    {
+        static constexpr int batch{64};
+        static constexpr int batches{4096};
+
+        template <typename Competitor>
+        contention_result measure(int threads, layout l, Competitor const& competitor) const
+        {
+            using clock = std::chrono::steady_clock;
+            using type  = typename Competitor::type;
+
+            slot_arena        arena(threads, l == layout::packed);
+            std::vector<type> pointers;
+            for (int t(0); t != (l == layout::same? 1: threads); ++t) {
+                pointers.push_back(competitor.make(slot_allocator<typename type::element_type>(&arena, t), t));
+            }
+
+            std::vector<std::vector<double>> latencies(threads, std::vector<double>(batches));
+            cpu::tube::duration time(cpu::tube::run_threads(threads, [&](int t){
+                        type const&          source(pointers[l == layout::same? 0: t]);
+                        std::vector<double>& samples(latencies[t]);
+                        for (double& sample: samples) {
+                            auto start(clock::now());
+                            for (int i(0); i != batch; ++i) {
+                                type copy(source);
+                                cpu::tube::escape(&copy);
+                            }
+                            std::chrono::duration<double, std::nano> time(clock::now() - start);
+                            sample = time.count() / batch;
+                        }
+                    }));
+            contention_result result{time, {}, long(threads) * batch * batches, 0.0};
+            for (auto const& samples: latencies) {
+                result.latencies.insert(result.latencies.end(), samples.begin(), samples.end());
+            }
+            std::sort(result.latencies.begin(), result.latencies.end());
+            return result;
+        }
+    };
+
+    template <typename Competitor>
+    void run_contention(cpu::tube::context& context, int max, std::string const& name,
+                        Competitor const& competitor)
+    {
+        std::vector<int> counts(cpu::tube::thread_counts(max));
+        for (layout l: { layout::same, layout::disjoint, layout::packed }) {
+            double base(0.0);
+            for (int threads: counts) {
+                context.start();
+                contention_result result(contention_runner().measure(threads, l, competitor));
+                base = threads == 1? result.per_second(): base;
+                result.base = base;
+                std::ostringstream out;
+                out << name << " [" << to_string(l) << "/" << threads << "]";
+                context.report(out.str(), result.time, result);
+            }
+        }
+    }
+
+    void run_contention(cpu::tube::context& context, int max)
+    {
+        run_contention(context, max, "std::shared_ptr<int>", shared_contention<int>());
+        run_contention(context, max, "boost::shared_ptr<int>", boost_shared_contention<int>());
     }
 }
 
@@ -337,8 +736,14 @@ namespace
 
 int main(int ac, char* av[])
 {
+    // usage: smart-pointers [contention [max-threads]]
     cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
-    run_tests<int>(context, "int");
-    run_tests<array<8>>(context, "array<8>");
-    run_tests<array<16>>(context, "array<16>");
+    bool contention_only(1 < ac && !std::strcmp(av[1], "contention"));
+    int  max(2 < ac? std::atoi(av[2]): 0); // 0 uses all hardware threads
+    if (!contention_only) {
+        run_tests<int>(context, "int");
+        run_tests<array<8>>(context, "array<8>");
+        run_tests<array<16>>(context, "array<16>");
+    }
+    run_contention(context, max);
 }
@@ -0,0 +1,106 @@
+// cpu/test/stream-filters.hpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TEST_STREAM_FILTERS
+#define INCLUDED_CPU_TEST_STREAM_FILTERS
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/stream.hpp"
+#include "cpu/algorithm/char_filter.hpp"
+#include "cpu/algorithm/regex_dfa.hpp"
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+// ----------------------------------------------------------------------------
+// The parts shared by get-digits and replace: both remove the characters not
+// in a set of allowed characters using the char_filter and regex_dfa
+// kernels and both can run the competitors on a corpus streamed from a file.
+
+namespace test
+{
+    template <bool Interleaved>
+    struct use_regex_dfa
+    {
+        cpu::algorithm::regex_dfa dfa;
+        explicit use_regex_dfa(std::string const& allowed)
+            : dfa("[^" + allowed + "]") {
+        }
+        void operator()(std::string& text) const {
+            char* end(Interleaved
+                      ? this->dfa.remove_matches_interleaved(text.data(), text.data() + text.size(), text.data())
+                      : this->dfa.remove_matches(text.data(), text.data() + text.size(), text.data()));
+            text.erase(end - text.data());
+        }
+    };
+
+    template <char* (cpu::algorithm::char_filter::*Kernel)(char const*, char const*, char*) const>
+    struct use_char_filter
+    {
+        cpu::algorithm::char_filter filter;
+        explicit use_char_filter(std::string const& allowed)
+            : filter(allowed) {
+        }
+        void operator()(std::string& text) const {
+            char* end((this->filter.*Kernel)(text.data(), text.data() + text.size(), text.data()));
+            text.erase(end - text.data());
+        }
+    };
+
+    // Processes a corpus larger than the caches chunk by chunk.
+    template <typename Replace>
+    void measure_stream(cpu::tube::context& context, char const* name,
+                        std::string const& path, Replace replace)
+    {
+        for (auto mode: { cpu::tube::stream_mode::read,
+                          cpu::tube::stream_mode::mmap,
+                          cpu::tube::stream_mode::pipelined }) {
+            cpu::tube::stream_result result(cpu::tube::stream_file(
+                path.c_str(), mode, 1u << 20, [&](std::string& chunk){ replace(chunk); }));
+            std::ostringstream out;
+            out << result;
+            context.report(std::string(name) + " [stream " + cpu::tube::to_string(mode) + "]",
+                           result.time, out.str());
+        }
+    }
+
+    // Streaming is requested with the arguments "stream [size in MB [file]]".
+    // The corpus is only written if the file doesn't have the requested size
+    // already, i.e., later runs reuse it.
+    inline bool stream_requested(int ac, char* av[], std::string& path) {
+        if (ac < 2 || std::string(av[1]) != "stream") {
+            return false;
+        }
+        std::uint64_t size(ac < 3? 2048u: std::strtoull(av[2], nullptr, 10));
+        path = ac < 4? "/tmp/cputube-corpus.txt": av[3];
+        cpu::tube::generate_corpus(path, size << 20);
+        return true;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,178 @@
+// cpu/test/unique-strings-mt.cpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/context.hpp"
+#include "cpu/tube/threads.hpp"
+#include "cpu/data-structures/hash_set.hpp"
+#include "cpu/data-structures/concurrent_hash_set.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <stdlib.h>
+
+namespace DS = cpu::data_structures;
+
+// ----------------------------------------------------------------------------
+// Multi-threaded variant of unique-strings: the key stream is split into one
+// contiguous slice per thread and all threads dedup into one shared set. Each
+// competitor returns the number of successful insertions which has to match
+// the number of unique keys.
+
+namespace {
+    template <typename Insert>
+    std::size_t run_threads(std::vector<std::string> const& keys,
+                            int                             threads,
+                            Insert                          insert)
+    {
+        std::atomic<std::size_t> total{0};
+        std::size_t const        size(keys.size());
+        cpu::tube::run_threads(threads, [&](int t){
+                std::size_t count(0);
+                for (std::size_t i(size * t / threads), end(size * (t + 1) / threads);
+                     i != end; ++i) {
+                    count += insert(keys[i]);
+                }
+                total += count;
+            });
+        return total;
+    }
+
+    struct mutex_unordered_set {
+        std::string name() const { return "std::mutex + std::unordered_set<std::string>"; }
+        std::size_t run(std::vector<std::string> const& keys, int threads) const {
+            std::mutex                      mutex;
+            std::unordered_set<std::string> values;
+            return run_threads(keys, threads, [&](std::string const& key){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return values.insert(key).second;
+                });
+        }
+    };
+
+    struct mutex_hash_set {
+        std::string name() const { return "std::mutex + data_structures::hash_set<std::string>"; }
+        std::size_t run(std::vector<std::string> const& keys, int threads) const {
+            std::mutex                mutex;
+            DS::hash_set<std::string> values;
+            return run_threads(keys, threads, [&](std::string const& key){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return values.emplace(key).second;
+                });
+        }
+    };
+
+    struct concurrent_hash_set {
+        std::string name() const { return "data_structures::concurrent_hash_set<std::string>"; }
+        std::size_t run(std::vector<std::string> const& keys, int threads) const {
+            DS::concurrent_hash_set<std::string> values;
+            return run_threads(keys, threads, [&](std::string const& key){
+                    return values.emplace(key);
+                });
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    template <typename Algo>
+    void measure(cpu::tube::context&             context,
+                 std::vector<std::string> const& keys,
+                 std::size_t                     basesize,
+                 int                             threads,
+                 Algo                            algo)
+    {
+        auto timer = context.start();
+        std::size_t size = algo.run(keys, threads);
+        auto time = timer.measure();
+        std::ostringstream out;
+        out << std::left << std::setw(55) << algo.name()
+            << " [" << keys.size() << "/" << basesize << "/" << threads << "]";
+        context.report(out.str(), time, size);
+    }
+}
+
+static void measure(cpu::tube::context&             context,
+                    std::vector<std::string> const& keys,
+                    std::size_t                     basesize)
+{
+    for (int threads: cpu::tube::thread_counts()) {
+        measure(context, keys, basesize, threads, mutex_unordered_set());
+        measure(context, keys, basesize, threads, mutex_hash_set());
+        measure(context, keys, basesize, threads, concurrent_hash_set());
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void run_tests(cpu::tube::context& context, int size) {
+    std::string const bases[] = {
+        "/usr/local/include/",
+        "/some/medium/sized/path/as/a/prefix/to/the/actual/interesting/names/",
+        "/finally/a/rather/long/string/including/pointless/sequences/like/"
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789/"
+        "just/to/make/the/string/longer/to/qualify/as/an/actual/long/string/"
+    };
+
+    std::mt19937 gen(4711);
+    std::uniform_int_distribution<> rand(0, size * 0.8);
+
+    for (std::string const& base: bases) {
+        std::vector<std::string> keys;
+        keys.reserve(size);
+        std::generate_n(std::back_inserter(keys), size,
+                        [&base, &rand, &gen]()mutable{
+                            return base + std::to_string(rand(gen));
+                        });
+        measure(context, keys, base.size());
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    cpu::tube::context context(CPUTUBE_CONTEXT_ARGS(ac, av));
+    int size(ac == 1? 0: atoi(av[1]));
+    if (size) {
+        run_tests(context, size);
+    }
+    else {
+        for (int i(100); i <= 1000000; i *= 10) {
+            for (int j(1); j < 10; j *= 2) {
+                run_tests(context, i * j);
+            }
+        }
+    }
+}
@@ -24,6 +24,8 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/data-structures/string_pool.hpp"
+#include "cpu/memory/allocation_policy.hpp"
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
@@ -125,6 +127,56 @@ namespace {
         }
     };
 
+    // The node based containers using an allocation policy for the nodes;
+    // the strings themselves still use the default allocator.
+    template <typename Policy>
+    struct policy_set {
+        Policy      policy;
+        std::string policy_name;
+        std::string name() const { return "std::set<std::string> [" + this->policy_name + "]"; }
+        std::size_t run(std::vector<std::string> const& keys) const {
+            using allocator = typename Policy::template allocator_type<std::string>;
+            std::size_t size;
+            {
+                std::set<std::string, std::less<std::string>, allocator>
+                    values(keys.begin(), keys.end(), this->policy.template allocator<std::string>());
+                size = values.size();
+            }
+            this->policy.release();
+            return size;
+        }
+    };
+
+    template <typename Policy>
+    struct policy_unordered_set {
+        Policy      policy;
+        std::string policy_name;
+        std::string name() const { return "std::unordered_set<std::string> [" + this->policy_name + "]"; }
+        std::size_t run(std::vector<std::string> const& keys) const {
+            using allocator = typename Policy::template allocator_type<std::string>;
+            std::size_t size;
+            {
+                std::unordered_set<std::string, std::hash<std::string>, std::equal_to<std::string>, allocator>
+                    values(keys.begin(), keys.end(), 0u, std::hash<std::string>(),
+                           std::equal_to<std::string>(), this->policy.template allocator<std::string>());
+                size = values.size();
+            }
+            this->policy.release();
+            return size;
+        }
+    };
+
+    struct string_pool {
+        std::string name() const { return "data_structures::string_pool"; }
+        std::size_t run(std::vector<std::string> const& keys) const {
+            cpu::data_structures::string_pool values;
+            for (std::string const& value: keys) {
+                values.intern(value);
+            }
+            return values.size();
+        }
+    };
+
 #if defined(HAS_BSL)
     struct bsl_set {
         std::string name() const { return "bsl::set<std::string>"; }
@@ -199,13 +251,14 @@ namespace {
                  std::size_t                     basesize,
                  Algo                            algo)
     {
+        std::ostringstream out;
+        out << std::left << std::setw(60) << algo.name()
+            << " [" << keys.size() << "/" << basesize << "]";
+        std::string name(out.str());
         auto timer = context.start();
         std::size_t size = algo.run(keys);
         auto time = timer.measure();
-        std::ostringstream out;
-        out << std::left << std::setw(50) << algo.name()
-            << " [" << keys.size() << "/" << basesize << "]";
-        context.report(out.str(), time, size);
+        context.report(name, time, size);
     }
 }
 
@@ -220,6 +273,12 @@ static void measure(cpu::tube::context&             context,
     measure(context, keys, basesize, std_unordered_set());
     measure(context, keys, basesize, std_insert_unordered_set());
     measure(context, keys, basesize, std_reserve_unordered_set());
+    measure(context, keys, basesize, string_pool());
+    cpu::memory::for_each_allocation_policy([&](std::string const& name, auto policy){
+            using Policy = decltype(policy);
+            measure(context, keys, basesize, policy_set<Policy>{policy, name});
+            measure(context, keys, basesize, policy_unordered_set<Policy>{policy, name});
+        });
 #if defined(HAS_BSL)
     measure(context, keys, basesize, bsl_set());
     measure(context, keys, basesize, bsl_insert_set());
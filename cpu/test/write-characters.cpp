@@ -24,11 +24,17 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/io/async_sink.hpp"
+#include "cpu/io/buffered_sink.hpp"
+#include "cpu/io/direct_sink.hpp"
+#include "cpu/io/mmap_sink.hpp"
+#include "cpu/io/writev_sink.hpp"
 #include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <stdexcept>
+#include <system_error>
 
 #include <stdio.h>
 #include <string.h>
@@ -238,6 +244,27 @@ namespace
             write(this->d_fd, line, strlen(line));
         }
     };
+
+    // The lines are static, i.e., the writev_sink can refer to them until
+    // they are written.
+    template <typename Sink>
+    struct SinkWrite
+    {
+        Sink d_sink;
+        SinkWrite(char const* filename): d_sink(filename) {}
+        void process(char const* line) {
+            this->d_sink.write(line, strlen(line));
+        }
+    };
+
+    template <cpu::io::async_sink::mode Mode>
+    struct AsyncSink
+        : cpu::io::async_sink
+    {
+        AsyncSink(char const* filename)
+            : cpu::io::async_sink(filename, default_size, Mode) {
+        }
+    };
 }
 
 // ----------------------------------------------------------------------------
@@ -246,16 +273,22 @@ template <typename File>
 static void
 measure(cpu::tube::context& context, char const* name, char const* filename)
 {
-    auto timer = context.start();
-    {
-        File file(filename);
-        for (int i = 0; i != 1000; ++i) {
-            for (char const* line: text) {
-                file.process(line);
+    // some sinks don't work with all files, e.g., mmap() with /dev/null
+    try {
+        auto timer = context.start();
+        {
+            File file(filename);
+            for (int i = 0; i != 1000; ++i) {
+                for (char const* line: text) {
+                    file.process(line);
+                }
             }
         }
+        context.report(name, timer);
+    }
+    catch (std::system_error const&) {
+        context.stub(name);
     }
-    context.report(name, timer);
 }
 
 // ----------------------------------------------------------------------------
@@ -280,6 +313,12 @@ int main(int ac, char* av[])
         measure<FStreamOStreamIterator>(context, "std::ostream_iterator", name);
         measure<FStreamOStreambufIterator>(context, "std::ostreambuf_iterator", name);
         measure<FStreamOStreambufIteratorLoop>(context, "std::ostreambuf_iterator loop", name);
+        measure<SinkWrite<cpu::io::buffered_sink>>(context, "io::buffered_sink", name);
+        measure<SinkWrite<cpu::io::writev_sink>>(context, "io::writev_sink", name);
+        measure<SinkWrite<cpu::io::mmap_sink>>(context, "io::mmap_sink", name);
+        measure<SinkWrite<cpu::io::direct_sink>>(context, "io::direct_sink", name);
+        measure<SinkWrite<AsyncSink<cpu::io::async_sink::mode::uring>>>(context, "io::async_sink uring", name);
+        measure<SinkWrite<AsyncSink<cpu::io::async_sink::mode::thread>>>(context, "io::async_sink thread", name);
     }
     catch (std::exception const& ex)
     {
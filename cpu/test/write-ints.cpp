@@ -24,12 +24,23 @@
 // ----------------------------------------------------------------------------
 
 #include "cpu/tube/context.hpp"
+#include "cpu/format/format_int.hpp"
+#include "cpu/io/async_sink.hpp"
+#include "cpu/io/buffered_sink.hpp"
+#include "cpu/io/direct_sink.hpp"
+#include "cpu/io/mmap_sink.hpp"
+#include "cpu/io/writev_sink.hpp"
 #include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <locale>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
+#include <system_error>
 #include <vector>
 #include <stdio.h>
 #include <stdlib.h>
@@ -144,6 +155,95 @@ namespace
             fputc('\n', this->d_file);
         }
     };
+
+    struct to_chars_values
+    {
+        std::ofstream     d_out;
+        std::vector<char> d_buffer;
+
+        to_chars_values(char const* name)
+            : d_out(name, std::ios_base::app)
+            , d_buffer(1000 * 12) {
+        }
+        void process(std::vector<int> const& values) {
+            char* next(this->d_buffer.data());
+            char* end(this->d_buffer.data() + this->d_buffer.size());
+            for (int x: values) {
+                next = std::to_chars(next, end, x).ptr;
+                *next++ = ' ';
+            }
+            *next++ = '\n';
+            this->d_out.write(this->d_buffer.data(), next - this->d_buffer.data());
+        }
+    };
+
+    struct format_int_values
+    {
+        std::ofstream     d_out;
+        std::vector<char> d_buffer;
+
+        format_int_values(char const* name)
+            : d_out(name, std::ios_base::app)
+            , d_buffer(1000 * (cpu::format::max_size<int> + 1) + 1) {
+        }
+        void process(std::vector<int> const& values) {
+            char* next(this->d_buffer.data());
+            for (int x: values) {
+                next = cpu::format::format_int(next, x);
+                *next++ = ' ';
+            }
+            *next++ = '\n';
+            this->d_out.write(this->d_buffer.data(), next - this->d_buffer.data());
+        }
+    };
+
+    // The lines are formatted into a ring of buffers with one buffer for
+    // each iovec held by the sink: a writev_sink refers to the buffer until
+    // it is written, i.e., a buffer can only be reused after the sink is
+    // flushed which happens when all its iovecs are used.
+    constexpr int sink_buffers{64};
+
+    template <typename Sink>
+    struct format_int_sink
+    {
+        static constexpr std::size_t line_size{1000 * (cpu::format::max_size<int> + 1) + 1};
+        Sink              d_sink;
+        std::vector<char> d_buffer;
+        int               d_current{};
+
+        format_int_sink(char const* name)
+            : d_sink(name)
+            , d_buffer(sink_buffers * line_size) {
+        }
+        void process(std::vector<int> const& values) {
+            char* begin(this->d_buffer.data() + this->d_current * line_size);
+            char* next(begin);
+            for (int x: values) {
+                next = cpu::format::format_int(next, x);
+                *next++ = ' ';
+            }
+            *next++ = '\n';
+            this->d_sink.write(begin, next - begin);
+            this->d_current = (this->d_current + 1) % sink_buffers;
+        }
+    };
+
+    struct writev_sink
+        : cpu::io::writev_sink
+    {
+        writev_sink(char const* name)
+            : cpu::io::writev_sink(name, sink_buffers) {
+        }
+    };
+
+    template <cpu::io::async_sink::mode Mode>
+    struct async_sink
+        : cpu::io::async_sink
+    {
+        async_sink(char const* name)
+            : cpu::io::async_sink(name, default_size, Mode) {
+        }
+    };
 }
 
 // ----------------------------------------------------------------------------
@@ -153,14 +253,74 @@ static void
 measure(cpu::tube::context& context, char const* name, char const* filename,
         std::vector<int> const& values)
 {
-    auto timer = context.start();
-    {
-        File file(filename);
-        for (int i = 0; i != 10000; ++i) {
-            file.process(values);
+    // some sinks don't work with all files, e.g., mmap() with /dev/null
+    try {
+        auto timer = context.start();
+        {
+            File file(filename);
+            for (int i = 0; i != 10000; ++i) {
+                file.process(values);
+            }
         }
+        context.report(name, timer);
+    }
+    catch (std::system_error const&) {
+        context.stub(name);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// The throughput hides how the time is distributed over the process() calls:
+// a buffered sink is fast for most calls and stalls on the calls doing the
+// write. The latency of each call is measured to show how much of the write
+// an asynchronous sink takes off the formatting thread.
+
+template <typename File>
+static void
+measure_latency(cpu::tube::context& context, char const* name,
+                char const* filename, std::vector<int> const& values)
+{
+    using clock = std::chrono::steady_clock;
+    std::size_t line(1u);
+    for (int x: values) {
+        char buffer[cpu::format::max_size<int>];
+        line += cpu::format::format_int(buffer, x) - buffer + 1;
+    }
+
+    std::string latency_name(std::string(name) + " latency");
+    try {
+        std::vector<clock::duration> latencies;
+        latencies.reserve(10000);
+        auto timer = context.start();
+        {
+            File file(filename);
+            for (int i = 0; i != 10000; ++i) {
+                auto start(clock::now());
+                file.process(values);
+                latencies.push_back(clock::now() - start);
+            }
+        }
+        auto time = timer.measure();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p){
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                latencies[std::size_t(p * (latencies.size() - 1u))]).count();
+        };
+        std::chrono::duration<double> total(std::accumulate(latencies.begin(), latencies.end(),
+                                                            clock::duration()));
+        double seconds(total.count());
+        std::ostringstream out;
+        out << "process-MB/s=" << (seconds == 0.0? 0.0: 10000.0 * line / seconds / 1e6)
+            << " p50=" << percentile(0.5) << "ns"
+            << " p99=" << percentile(0.99) << "ns"
+            << " p99.9=" << percentile(0.999) << "ns"
+            << " max=" << percentile(1.0) << "ns";
+        context.report(latency_name, time, out.str());
+    }
+    catch (std::system_error const&) {
+        context.stub(latency_name);
     }
-    context.report(name, timer);
 }
 
 // ----------------------------------------------------------------------------
@@ -184,4 +344,17 @@ int main(int ac, char* av[])
     measure<num_put_copy>(context, "num_put()/ofstream", name, values);
     measure<fprintf_values>(context, "fprintf values", name, values);
     measure<snprintf_values>(context, "snprintf/fputs values", name, values);
+    measure<to_chars_values>(context, "to_chars()/ofstream", name, values);
+    measure<format_int_values>(context, "format_int()/ofstream", name, values);
+    measure<format_int_sink<cpu::io::buffered_sink>>(context, "format_int()/io::buffered_sink", name, values);
+    measure<format_int_sink<writev_sink>>(context, "format_int()/io::writev_sink", name, values);
+    measure<format_int_sink<cpu::io::mmap_sink>>(context, "format_int()/io::mmap_sink", name, values);
+    measure<format_int_sink<cpu::io::direct_sink>>(context, "format_int()/io::direct_sink", name, values);
+    measure<format_int_sink<async_sink<cpu::io::async_sink::mode::uring>>>(context, "format_int()/io::async_sink uring", name, values);
+    measure<format_int_sink<async_sink<cpu::io::async_sink::mode::thread>>>(context, "format_int()/io::async_sink thread", name, values);
+
+    measure_latency<format_int_values>(context, "format_int()/ofstream", name, values);
+    measure_latency<format_int_sink<cpu::io::buffered_sink>>(context, "format_int()/io::buffered_sink", name, values);
+    measure_latency<format_int_sink<async_sink<cpu::io::async_sink::mode::uring>>>(context, "format_int()/io::async_sink uring", name, values);
+    measure_latency<format_int_sink<async_sink<cpu::io::async_sink::mode::thread>>>(context, "format_int()/io::async_sink thread", name, values);
 }
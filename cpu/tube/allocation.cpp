@@ -0,0 +1,347 @@
+// cpu/tube/allocation.cpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/allocation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <ostream>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <pthread.h>
+
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#  define CPUTUBE_INTERPOSE_MALLOC 1
+extern "C" {
+    void* __libc_malloc(std::size_t);
+    void  __libc_free(void*);
+    void* __libc_calloc(std::size_t, std::size_t);
+    void* __libc_realloc(void*, std::size_t);
+    void* __libc_memalign(std::size_t, std::size_t);
+    void* __libc_valloc(std::size_t);
+    void* __libc_pvalloc(std::size_t);
+}
+#else
+#  define CPUTUBE_INTERPOSE_MALLOC 0
+#endif
+
+// ----------------------------------------------------------------------------
+// The counts are updated only by the owning thread using relaxed loads and
+// stores. The last slot is shared by all threads beyond the available slots
+// and is updated using atomic read-modify-write operations. When a thread
+// exits its slot is returned and a new thread continues to count in it, i.e.,
+// the counts of exited threads remain available and only more than 255
+// concurrently running threads share the last slot. Allocations done on
+// an exiting thread after its slot was returned go to the shared slot.
+
+namespace
+{
+    struct alignas(64) counts
+    {
+        std::atomic<std::uint64_t> allocations;
+        std::atomic<std::uint64_t> deallocations;
+        std::atomic<std::uint64_t> bytes;
+        std::atomic<std::int64_t>  live;
+        std::atomic<std::int64_t>  peak;
+        std::atomic<bool>          owned;
+    };
+
+    constexpr std::size_t      s_slots{256u};
+    counts                     s_counts[s_slots];
+    counts* const              s_shared{s_counts + s_slots - 1u};
+    std::atomic<bool>          s_enabled{false};
+    thread_local counts*       t_counts{nullptr};
+
+    counts* acquire_slot()
+    {
+        for (counts* it(s_counts); it != s_shared; ++it) {
+            if (!it->owned.load(std::memory_order_relaxed)
+                && !it->owned.exchange(true, std::memory_order_acquire)) {
+                return it;
+            }
+        }
+        return s_shared;
+    }
+
+    // Returns the thread's slot when the thread exits. A pthread key is used
+    // rather than a thread_local object with a destructor as registering
+    // such a destructor allocates memory, i.e., it would show in the counts.
+    extern "C" void release_slot(void* slot)
+    {
+        static_cast<counts*>(slot)->owned.store(false, std::memory_order_release);
+        t_counts = s_shared;
+    }
+
+    pthread_key_t make_release_key()
+    {
+        pthread_key_t key;
+        pthread_key_create(&key, release_slot);
+        return key;
+    }
+
+    counts& local()
+    {
+        if (!t_counts) {
+            static pthread_key_t const key(make_release_key());
+            t_counts = acquire_slot();
+            if (t_counts != s_shared) {
+                pthread_setspecific(key, t_counts);
+            }
+        }
+        return *t_counts;
+    }
+
+    template <typename T>
+    T add(std::atomic<T>& counter, T value, bool shared)
+    {
+        if (shared) {
+            return counter.fetch_add(value, std::memory_order_relaxed) + value;
+        }
+        T rc(counter.load(std::memory_order_relaxed) + value);
+        counter.store(rc, std::memory_order_relaxed);
+        return rc;
+    }
+
+    std::int64_t usable_size(void* ptr)
+    {
+#if CPUTUBE_INTERPOSE_MALLOC
+        return malloc_usable_size(ptr);
+#else
+        (void)ptr;
+        return 0;
+#endif
+    }
+
+    void count_allocation(std::size_t size, void* ptr)
+    {
+        if (ptr && s_enabled.load(std::memory_order_relaxed)) {
+            counts&      c(local());
+            bool         shared(&c == s_shared);
+            add(c.allocations, std::uint64_t(1u), shared);
+            add(c.bytes, std::uint64_t(size), shared);
+            std::int64_t live(add(c.live, usable_size(ptr), shared));
+            if (c.peak.load(std::memory_order_relaxed) < live) {
+                c.peak.store(live, std::memory_order_relaxed);
+            }
+        }
+    }
+    void count_deallocation(std::int64_t size)
+    {
+        counts& c(local());
+        bool    shared(&c == s_shared);
+        add(c.deallocations, std::uint64_t(1u), shared);
+        add(c.live, -size, shared);
+    }
+    void count_deallocation(void* ptr)
+    {
+        if (ptr && s_enabled.load(std::memory_order_relaxed)) {
+            count_deallocation(usable_size(ptr));
+        }
+    }
+
+    // The allocation functions used by operator new and operator delete:
+    // with interposed allocation functions the counting is done by these.
+    void* allocate(std::size_t size, std::size_t alignment = 0u)
+    {
+        size += size == 0u;
+        void* rc(alignment <= alignof(std::max_align_t)
+                 ? std::malloc(size)
+                 : std::aligned_alloc(alignment, (size + alignment - 1u) / alignment * alignment));
+        if (!CPUTUBE_INTERPOSE_MALLOC) {
+            count_allocation(size, rc);
+        }
+        return rc;
+    }
+    void* allocate_or_throw(std::size_t size, std::size_t alignment = 0u)
+    {
+        void* rc(allocate(size, alignment));
+        if (!rc) {
+            throw std::bad_alloc();
+        }
+        return rc;
+    }
+    void deallocate(void* ptr)
+    {
+        if (!CPUTUBE_INTERPOSE_MALLOC) {
+            count_deallocation(ptr);
+        }
+        std::free(ptr);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::allocation_count cpu::tube::allocation_counts()
+{
+    allocation_count rc{ 0u, 0u, 0u, 0, 0 };
+    for (counts const* it(s_counts), *last(s_counts + s_slots); it != last; ++it) {
+        rc.allocations   += it->allocations.load(std::memory_order_relaxed);
+        rc.deallocations += it->deallocations.load(std::memory_order_relaxed);
+        rc.bytes         += it->bytes.load(std::memory_order_relaxed);
+        rc.live          += it->live.load(std::memory_order_relaxed);
+        rc.peak          += it->peak.load(std::memory_order_relaxed);
+    }
+    return rc;
+}
+
+void cpu::tube::reset_allocation_peak()
+{
+    for (counts* it(s_counts), *last(s_counts + s_slots); it != last; ++it) {
+        it->peak.store(it->live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+bool cpu::tube::count_allocations(bool enable)
+{
+    return s_enabled.exchange(enable);
+}
+
+bool cpu::tube::counting_allocations()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+std::ostream& cpu::tube::operator<< (std::ostream& out, allocation_count const& count)
+{
+    return out << "allocations=" << count.allocations << ','
+               << "bytes=" << count.bytes << ','
+               << "peak=" << count.peak;
+}
+
+// ----------------------------------------------------------------------------
+
+#if CPUTUBE_INTERPOSE_MALLOC
+extern "C" void* malloc(std::size_t size) noexcept
+{
+    void* rc(__libc_malloc(size));
+    count_allocation(size, rc);
+    return rc;
+}
+
+extern "C" void free(void* ptr) noexcept
+{
+    count_deallocation(ptr);
+    __libc_free(ptr);
+}
+
+extern "C" void* calloc(std::size_t n, std::size_t size) noexcept
+{
+    void* rc(__libc_calloc(n, size));
+    count_allocation(n * size, rc);
+    return rc;
+}
+
+extern "C" void* realloc(void* ptr, std::size_t size) noexcept
+{
+    if (!s_enabled.load(std::memory_order_relaxed)) {
+        return __libc_realloc(ptr, size);
+    }
+    std::int64_t old(ptr? usable_size(ptr): 0);
+    void*        rc(__libc_realloc(ptr, size));
+    if (ptr && (rc || size == 0u)) {
+        count_deallocation(old);
+    }
+    count_allocation(size, rc);
+    return rc;
+}
+
+extern "C" void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    void* rc(__libc_memalign(alignment, size));
+    count_allocation(size, rc);
+    return rc;
+}
+
+extern "C" void* valloc(std::size_t size) noexcept
+{
+    void* rc(__libc_valloc(size));
+    count_allocation(size, rc);
+    return rc;
+}
+
+extern "C" void* pvalloc(std::size_t size) noexcept
+{
+    void* rc(__libc_pvalloc(size));
+    count_allocation(size, rc);
+    return rc;
+}
+
+// glibc's reallocarray() doesn't use the interposed realloc()
+extern "C" void* reallocarray(void* ptr, std::size_t n, std::size_t size) noexcept
+{
+    std::size_t total;
+    if (__builtin_mul_overflow(n, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, total);
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** ptr, std::size_t alignment, std::size_t size) noexcept
+{
+    if (alignment % sizeof(void*) != 0u || (alignment & (alignment - 1u)) != 0u) {
+        return EINVAL;
+    }
+    void* rc(memalign(alignment, size));
+    if (!rc) {
+        return ENOMEM;
+    }
+    *ptr = rc;
+    return 0;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return allocate_or_throw(size, std::size_t(a)); }
+void* operator new[](std::size_t size, std::align_val_t a) { return allocate_or_throw(size, std::size_t(a)); }
+void* operator new(std::size_t size, std::align_val_t a, std::nothrow_t const&) noexcept {
+    return allocate(size, std::size_t(a));
+}
+void* operator new[](std::size_t size, std::align_val_t a, std::nothrow_t const&) noexcept {
+    return allocate(size, std::size_t(a));
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::nothrow_t const&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept { deallocate(ptr); }
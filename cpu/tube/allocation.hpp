@@ -0,0 +1,99 @@
+// cpu/tube/allocation.hpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_ALLOCATION
+#define INCLUDED_CPU_TUBE_ALLOCATION
+
+#include <iosfwd>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Counting of the allocations done by a test program: the library replaces
+// operator new and operator delete and, when using glibc, interposes
+// malloc(), free(), and the other allocation functions from the C library
+// (calloc(), realloc(), reallocarray(), memalign(), aligned_alloc(),
+// posix_memalign(), valloc(), and pvalloc()) such that all blocks which
+// can be passed to free() are counted.
+// As the replacements are linked into all test programs the counting is
+// only done after it was enabled using count_allocations(true) or by
+// setting the environment variable CPUTUBE_ALLOCATIONS to a value other
+// than 0 (see cpu::tube::context); otherwise the replacements merely
+// forward to the C library.
+//
+// The counts are kept per thread, i.e., counting doesn't need atomic
+// read-modify-write operations (except for the threads beyond the first
+// few hundred running concurrently which share one set of counts; the
+// counts of an exited thread are taken over by a later thread).
+// allocation_counts() sums up the counts of all threads including those
+// which have exited:
+//
+// - allocations, deallocations, and bytes are cumulative, i.e., the
+//   allocations of a piece of code are the difference of the counts
+//   obtained before and after the code.
+// - live is the number of bytes currently allocated and peak is the high-
+//   water mark of live since the last call to reset_allocation_peak().
+//   Both use the size of the allocated block (malloc_usable_size()) as
+//   the size isn't passed when memory is released. With multiple threads
+//   peak is the sum of the per thread high-water marks, i.e., it is an
+//   upper bound of the real peak.
+
+namespace cpu
+{
+    namespace tube
+    {
+        struct allocation_count;
+        std::ostream& operator<< (std::ostream&, allocation_count const&);
+
+        allocation_count allocation_counts();
+        void             reset_allocation_peak();
+        bool             count_allocations(bool enable); // returns the old state
+        bool             counting_allocations();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::allocation_count
+{
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+    std::uint64_t bytes; // the requested bytes
+    std::int64_t  live;
+    std::int64_t  peak;
+
+    // The difference of the cumulative counts; live and peak are levels
+    // and become relative to the bytes live in other.
+    allocation_count operator- (allocation_count const& other) const {
+        return allocation_count{ this->allocations - other.allocations,
+                                 this->deallocations - other.deallocations,
+                                 this->bytes - other.bytes,
+                                 this->live - other.live,
+                                 this->peak - other.live };
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,197 @@
+// cpu/tube/allocation.t.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "allocation.hpp"
+#include "cpu/tube/protect.hpp"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "operator new", []{
+            CT::allocation_count before(CT::allocation_counts());
+            std::unique_ptr<char[]> ptr(new char[100]);
+            CT::escape(ptr.get());
+            CT::allocation_count during(CT::allocation_counts() - before);
+            ptr.reset();
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return during.allocations == 1u && during.deallocations == 0u
+                && during.bytes == 100u && during.live >= 100
+                && after.allocations == 1u && after.deallocations == 1u
+                && after.live == 0;
+        }
+    },
+    { "malloc", []{
+            CT::allocation_count before(CT::allocation_counts());
+            void* ptr(std::malloc(10u));
+            CT::escape(ptr);
+            ptr = std::realloc(ptr, 1000u);
+            CT::escape(ptr);
+            char* str(strdup("hello"));
+            std::free(str);
+            std::free(ptr);
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return after.allocations == 3u && after.deallocations == 3u
+                && after.bytes == 10u + 1000u + 6u
+                && after.live == 0;
+        }
+    },
+#if defined(__GLIBC__)
+    { "other allocation functions", []{
+            CT::allocation_count before(CT::allocation_counts());
+            void* ptrs[7] = {};
+            ptrs[0] = ::valloc(100u);
+            ptrs[1] = ::pvalloc(100u);
+            ptrs[2] = ::aligned_alloc(64u, 128u);
+            bool aligned(::posix_memalign(ptrs + 3, 64u, 100u) == 0);
+            ptrs[4] = ::reallocarray(nullptr, 10u, 10u);
+            ptrs[5] = ::reallocarray(std::malloc(10u), 20u, 10u);
+            ptrs[6] = ::reallocarray(nullptr, ~std::size_t(), 2u); // overflows
+            CT::allocation_count during(CT::allocation_counts() - before);
+            for (void* p: ptrs) {
+                CT::escape(p);
+                std::free(p);
+            }
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return aligned && !ptrs[6]
+                && during.allocations == 7u && during.deallocations == 1u
+                && after.allocations == 7u && after.deallocations == 7u
+                && after.live == 0;
+        }
+    },
+#endif
+    { "peak", []{
+            CT::reset_allocation_peak();
+            CT::allocation_count before(CT::allocation_counts());
+            void* ptr(std::malloc(1u << 16));
+            CT::escape(ptr);
+            std::free(ptr);
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return before.peak == before.live
+                && after.peak >= (1 << 16)
+                && after.live == 0;
+        }
+    },
+    { "threads", []{
+            CT::allocation_count before(CT::allocation_counts());
+            std::vector<std::thread> threads;
+            for (int i(0); i != 4; ++i) {
+                threads.emplace_back([]{
+                        for (int j(0); j != 1000; ++j) {
+                            void* ptr(std::malloc(16u));
+                            CT::escape(ptr);
+                            std::free(ptr);
+                        }
+                    });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return after.allocations >= 4000u && after.deallocations >= 4000u;
+        }
+    },
+    { "more threads than slots", []{
+            // the slots of exited threads are reused by later threads
+            CT::allocation_count before(CT::allocation_counts());
+            for (int i(0); i != 100; ++i) {
+                std::vector<std::thread> threads;
+                for (int j(0); j != 8; ++j) {
+                    threads.emplace_back([]{
+                            for (int k(0); k != 10; ++k) {
+                                void* ptr(std::malloc(16u));
+                                CT::escape(ptr);
+                                std::free(ptr);
+                            }
+                        });
+                }
+                for (auto& thread: threads) {
+                    thread.join();
+                }
+            }
+            CT::allocation_count after(CT::allocation_counts() - before);
+            return after.allocations >= 8000u && after.deallocations >= 8000u
+                && after.live == 0;
+        }
+    },
+    { "disabled", []{
+            bool enabled(CT::count_allocations(false));
+            CT::allocation_count before(CT::allocation_counts());
+            void* ptr(std::malloc(16u));
+            CT::escape(ptr);
+            std::free(ptr);
+            int* value(new int(17));
+            CT::escape(value);
+            delete value;
+            CT::allocation_count after(CT::allocation_counts() - before);
+            CT::count_allocations(enabled);
+            return enabled && after.allocations == 0u && after.deallocations == 0u;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    CT::count_allocations(true);
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -24,7 +24,6 @@
 // ----------------------------------------------------------------------------
 
 #include <iostream>
-#include <limits>
 #include <fstream>
 #include <string>
 #include <map>
@@ -42,6 +41,55 @@ namespace
             value.erase(pos, remove.size());
         }
     }
+
+    // the value of a "key=value," field of the reported results or "0"
+    std::string field(std::string const& results, std::string const& key)
+    {
+        std::string::size_type pos(results.find("," + key + "="));
+        if (pos == results.npos) {
+            return "0";
+        }
+        pos += key.size() + 2u;
+        return results.substr(pos, results.find_first_of(",%", pos) - pos);
+    }
+
+    typedef std::map<std::string, std::vector<std::string> > series;
+
+    void data(std::ostream& out, std::string const& var,
+              std::vector<std::string> const& system,
+              std::vector<std::string> const& order, series& values)
+    {
+        out << "        var " << var << " = google.visualization.arrayToDataTable([\n";
+        out << "[ 'Test'";
+        for (std::vector<std::string>::const_iterator it(system.begin()), end(system.end());
+             it != end; ++it) {
+            out << ", '" << *it << "'";
+        }
+        out << "],\n";
+        for (std::vector<std::string>::const_iterator it(order.begin()), end(order.end());
+             it != end; ++it) {
+            out << "['" << *it << "'";
+            std::vector<std::string>& results(values[*it]);
+            results.resize(system.size(), "0");
+            for (std::vector<std::string>::const_iterator rit(results.begin()), rend(results.end());
+                 rit != rend; ++rit) {
+                 out << ", " << *rit;
+            }
+            out << "]" << (&*it == &order.back()? "": ",") << '\n';
+        }
+        out << "]);\n";
+    }
+
+    void chart(std::ostream& out, std::string const& var, std::string const& div,
+               std::string const& title, std::string const& axis)
+    {
+        out << "        new google.visualization.BarChart(document.getElementById('"
+            << div << "')).draw(" << var << ", {\n";
+        out << "          chartArea: { width: \"60%\", height: \"95%\" },\n";
+        out << "          title: '" << title << "',\n";
+        out << "          hAxis: {title: '" << axis << "'}\n";
+        out << "        });\n";
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -50,10 +98,14 @@ int main(int ac, char* av[])
 {
     try
     {
-        std::streamsize const max(std::numeric_limits<std::streamsize>::max());
         std::vector<std::string>                        order;
         std::vector<std::string>                        system;
-        std::map<std::string, std::vector<std::string> > values;
+        series                                          values;
+        // the throughput declared by the tests: GB/s or, without bytes, items/s
+        series                                          gbps;
+        series                                          items;
+        bool                                            has_gbps(false);
+        bool                                            has_items(false);
 
         if (ac < 2) {
             throw std::runtime_error("usage: " + std::string(av[0]) + " <name> [<results>*]");
@@ -73,15 +125,23 @@ int main(int ac, char* av[])
                 erase(tmp, "flags=");
                 system.push_back(tmp);
             }
-            for (std::string test, result;
-                 std::getline(std::getline(in, test, '|'), result, ',').ignore(max, '\n'); ) {
-                std::map<std::string, std::vector<std::string> >::iterator it(values.find(test));
+            for (std::string test, line; std::getline(std::getline(in, test, '|'), line); ) {
+                std::string result(line.substr(0, line.find(',')));
+                series::iterator it(values.find(test));
                 if (it == values.end()) {
                     order.push_back(test);
                     it = values.insert(std::make_pair(test, std::vector<std::string>())).first;
                 }
                 it->second.resize(system.size() - 1u, "0");
                 it->second.push_back(result);
+                std::vector<std::string>& bandwidth(gbps[test]);
+                bandwidth.resize(system.size() - 1u, "0");
+                bandwidth.push_back(field(line, "gb/s"));
+                has_gbps = has_gbps || bandwidth.back() != "0";
+                std::vector<std::string>& rate(items[test]);
+                rate.resize(system.size() - 1u, "0");
+                rate.push_back(field(line, "items/s"));
+                has_items = has_items || rate.back() != "0";
             }
         }
 
@@ -95,36 +155,16 @@ int main(int ac, char* av[])
         out << "      google.load(\"visualization\", \"1\", {packages:[\"corechart\"]});\n";
         out << "      google.setOnLoadCallback(drawChart);\n";
         out << "      function drawChart() {\n";
-        out << "        var data = google.visualization.arrayToDataTable([\n";
-
-        out << "[ 'Test'";
-        for (std::vector<std::string>::const_iterator it(system.begin()), end(system.end());
-             it != end; ++it) {
-            out << ", '" << *it << "'";
-        }
-        out << "],\n";
-        for (std::vector<std::string>::const_iterator it(order.begin()), end(order.end());
-             it != end; ++it) {
-            out << "['" << *it << "'";
-            std::vector<std::string>& results(values[*it]);
-            results.resize(system.size(), "0");
-            for (std::vector<std::string>::const_iterator rit(results.begin()), rend(results.end());
-                 rit != rend; ++rit) {
-                 out << ", " << *rit;
-            }
-            out << "]" << (&*it == &order.back()? "": ",") << '\n';
+        data(out, "data", system, order, values);
+        if (has_gbps || has_items) {
+            data(out, "throughput", system, order, has_gbps? gbps: items);
         }
-        out << "]);\n";
-
-        out << "        var options = {\n";
-        out << "          chartArea: { width: \"60%\", height: \"95%\" },\n";
-        out << "          title: '" << name << "',\n";
-        out << "          hAxis: {title: 'time'}\n";
-        out << "        };\n";
         out << "\n";
-        out << "        var chart = new google.visualization.BarChart(document.getElementById('chart_div'));\n";
-        out << "\n";
-        out << "        chart.draw(data, options);\n";
+        chart(out, "data", "chart_div", name, "time");
+        if (has_gbps || has_items) {
+            chart(out, "throughput", "throughput_div", name + " (throughput)",
+                  has_gbps? "GB/s": "items/s");
+        }
         out << "      }\n";
         out << "    </script>\n";
         out << "  </head>\n";
@@ -133,6 +173,10 @@ int main(int ac, char* av[])
         out.clear();
         out << "    <div id=\"chart_div\" style=\"width: 1400px; height: "
             << (13 * (1 + system.size()) * order.size()) << "px;\"></div>\n";
+        if (has_gbps || has_items) {
+            out << "    <div id=\"throughput_div\" style=\"width: 1400px; height: "
+                << (13 * (1 + system.size()) * order.size()) << "px;\"></div>\n";
+        }
         out << "  </body>\n";
         out << "</html>\n";
     }
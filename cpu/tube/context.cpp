@@ -25,10 +25,25 @@
 
 #include "cpu/tube/context.hpp"
 #include "cpu/tube/processor.hpp"
+#include "cpu/tube/numa.hpp"
+#include "cpu/memory/huge_page_allocator.hpp"
 #include <iostream>
 #include <iomanip>
 #include <iterator>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    heap_fragmenter::config fragment_config()
+    {
+        char const* text(std::getenv("CPUTUBE_FRAGMENT"));
+        return heap_fragmenter::config::parse(text? text: "");
+    }
+}
 
 // ----------------------------------------------------------------------------
 
@@ -41,13 +56,45 @@ cpu::tube::context::context(int, char*  av[],
     , d_processor(cpu::tube::processor().value())
     , d_compiler(compiler)
     , d_flags(flags)
-      //-dk:TODO the fragmentation should probably be configurable
       // this will leave a the heap in a fragmented state
       // with many small allocations (1b-64k) littered around at random
-      // , d_fragment(1024*1024, 64*1024)
-    , d_fragment(1024, 64*1024)
+      // unless CPUTUBE_FRAGMENT configures a different aging model,
+      // e.g., CPUTUBE_FRAGMENT=count=1M,sizes=lognormal,live=256M,rounds=8
+    , d_fragment(fragment_config())
     , d_json()
+    , d_allocations()
+    , d_region()
+    , d_dtlb()
+    , d_dtlb_start()
+    , d_dtlb_misses()
+    , d_stopped()
 {
+    // CPUTUBE_ALLOCATIONS=1 adds the allocations of each measured region,
+    // i.e., since the last start(), to the reported results.
+    if (char const* count = std::getenv("CPUTUBE_ALLOCATIONS")) {
+        if (*count && std::strcmp(count, "0")) {
+            cpu::tube::count_allocations(true);
+        }
+    }
+    // CPUTUBE_HUGE_PAGES=off|transparent|hugetlb selects the default mode
+    // of cpu::memory::huge_page_allocator and adds the dTLB misses of each
+    // measured region to the results if the counter is available, i.e.,
+    // runs with different modes can be compared. The misses are counted on
+    // all CPUs if the kernel permits it (including the pooled workers of
+    // parallel algorithms) and for the process otherwise; dtlb-scope tells
+    // which one is used.
+    char const* huge_pages(std::getenv("CPUTUBE_HUGE_PAGES"));
+    if (huge_pages) {
+        cpu::memory::set_default_huge_pages(cpu::memory::parse_huge_pages(huge_pages));
+        // the system scope includes the work of pooled worker threads
+        for (perf_scope scope: { perf_scope::system, perf_scope::thread }) {
+            std::unique_ptr<perf_counter> dtlb(new perf_counter(perf_event::dtlb_load_misses, scope));
+            if (dtlb->available()) {
+                this->d_dtlb = std::move(dtlb);
+                break;
+            }
+        }
+    }
     this->d_json.setstate(std::ios_base::failbit);
     std::replace(d_testname.begin(), d_testname.end(), '/', '-');
     std::string::size_type pos(this->d_testname.find("cputest_"));
@@ -58,8 +105,28 @@ cpu::tube::context::context(int, char*  av[],
               << "arch=" << arch << ' '
               << "processor=" << cpu::tube::processor() << ' '
               << "compiler=" << compiler << ' '
-              << "flags=" << flags << ' '
-              << '\n';
+              << "flags=" << flags << ' ';
+    if (std::getenv("CPUTUBE_FRAGMENT")) {
+        std::cout << this->d_fragment.statistics() << ' ';
+    }
+    if (huge_pages) {
+        std::cout << "huge-pages=" << cpu::memory::to_string(cpu::memory::default_huge_pages()) << ' '
+                  << "dtlb-misses=" << (this->d_dtlb? "counted": "unavailable") << ' ';
+        if (this->d_dtlb) {
+            // see perf_counter: with the thread scope the pooled worker
+            // threads aren't included
+            std::cout << "dtlb-scope="
+                      << (this->d_dtlb->scope() == perf_scope::system
+                          ? "system": "main+exited-threads") << ' ';
+        }
+    }
+    if (!cpu::tube::processor::memory().empty()) {
+        std::cout << cpu::tube::processor::memory() << ' ';
+    }
+    if (1 < cpu::tube::numa_topology::system().size()) {
+        std::cout << cpu::tube::numa_topology::system() << ' ';
+    }
+    std::cout << '\n';
 }
  
 cpu::tube::context::~context() {
@@ -76,11 +143,21 @@ cpu::tube::context::stub(char const* name)
 void
 cpu::tube::context::do_report(char const*                     name,
                               cpu::tube::duration             duration,
-                              std::vector<std::string> const& argv)
+                              std::vector<std::string> const& argv,
+                              cpu::tube::work const&          work)
 {
     std::cout << std::setw(0) << name << '|'
               << std::setw(0) << duration << ',';
     std::copy(argv.begin(), argv.end(),
               std::ostream_iterator<std::string>(std::cout, ","));
+    if (!work.empty()) {
+        std::cout << cpu::tube::throughput(duration, work);
+    }
+    if (cpu::tube::counting_allocations()) {
+        std::cout << this->d_region << ',';
+    }
+    if (this->d_dtlb) {
+        std::cout << "dtlb-misses=" << this->d_dtlb_misses << ',';
+    }
     std::cout << '\n' << std::flush;
 }
@@ -26,11 +26,15 @@
 #ifndef INCLUDED_CPU_TUBE_CONTEXT
 #define INCLUDED_CPU_TUBE_CONTEXT
 
+#include "cpu/tube/allocation.hpp"
 #include "cpu/tube/timer.hpp"
 #include "cpu/tube/heap_fragment.hpp"
+#include "cpu/tube/perf_counter.hpp"
 #include "cpu/tube/test_case.hpp"
+#include "cpu/tube/throughput.hpp"
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <utility>
@@ -60,12 +64,21 @@ private:
     char const*     d_flags;
     heap_fragmenter d_fragment;
     std::ofstream   d_json;
+    allocation_count d_allocations; // the counts at start()
+    allocation_count d_region;      // the allocations being reported
+    std::unique_ptr<perf_counter> d_dtlb; // only with CPUTUBE_HUGE_PAGES
+    std::uint64_t    d_dtlb_start;  // the dTLB misses at start()
+    std::uint64_t    d_dtlb_misses; // the dTLB misses being reported
+    bool             d_stopped;     // the region was ended by the timer
 	
     template <typename T>
     static void format(std::vector<std::string>& argv, T const& value);
 
+    void p_region();
+    static void p_stop(void* self);
     void do_report(char const* name, cpu::tube::duration duration,
-                   std::vector<std::string> const& argv);
+                   std::vector<std::string> const& argv,
+                   cpu::tube::work const& work = cpu::tube::work{ 0u, 0u });
 
     template <typename Measure, typename Case>
     void intern_run(std::ostream&, int start, int end, Measure measure,
@@ -91,6 +104,10 @@ public:
     void report(char const* name, cpu::tube::duration duration);
     template <typename T>
     void report(char const* name, cpu::tube::duration duration, T const& arg);
+    // additionally reports the throughput for the work done
+    template <typename T>
+    void report(char const* name, cpu::tube::duration duration, T const& arg,
+                cpu::tube::work const& work);
 
     template <typename T>
     void report(std::string const& name, cpu::tube::timer& timer, T const& arg) {
@@ -100,6 +117,11 @@ public:
     void report(std::string const& name, cpu::tube::duration duration, T const& arg) {
         this->report(name.c_str(), duration, arg);
     }
+    template <typename T>
+    void report(std::string const& name, cpu::tube::duration duration, T const& arg,
+                cpu::tube::work const& work) {
+        this->report(name.c_str(), duration, arg, work);
+    }
 
     template <typename Measure, typename... Cases>
     void run(int start, int end, std::string const& group, Measure measure,
@@ -120,7 +142,41 @@ cpu::tube::context::format(std::vector<std::string>& argv, T const& value)
 inline cpu::tube::timer
 cpu::tube::context::start()
 {
-    return cpu::tube::timer();
+    if (cpu::tube::counting_allocations()) {
+        cpu::tube::reset_allocation_peak();
+        this->d_allocations = cpu::tube::allocation_counts();
+    }
+    if (this->d_dtlb) {
+        this->d_dtlb_start = this->d_dtlb->value();
+    }
+    this->d_stopped = false;
+    return cpu::tube::timer(&cpu::tube::context::p_stop, this);
+}
+
+// The region of the counters ends when the timer returned from start() is
+// measured, i.e., allocations done while formatting the report aren't
+// included. Results measured with other timers end the region when they
+// are reported.
+inline void
+cpu::tube::context::p_stop(void* self)
+{
+    cpu::tube::context* context(static_cast<cpu::tube::context*>(self));
+    if (cpu::tube::counting_allocations()) {
+        context->d_region = cpu::tube::allocation_counts() - context->d_allocations;
+    }
+    if (context->d_dtlb) {
+        context->d_dtlb_misses = context->d_dtlb->value() - context->d_dtlb_start;
+    }
+    context->d_stopped = true;
+}
+
+inline void
+cpu::tube::context::p_region()
+{
+    if (!this->d_stopped) {
+        cpu::tube::context::p_stop(this);
+    }
+    this->d_stopped = false;
 }
 
 inline void
@@ -141,6 +197,7 @@ cpu::tube::context::report(char const*       name,
 inline void
 cpu::tube::context::report(char const* name, cpu::tube::duration duration)
 {
+    this->p_region();
     std::vector<std::string> argv;
     this->do_report(name, duration, argv);
 }
@@ -151,11 +208,25 @@ cpu::tube::context::report(char const*         name,
                            cpu::tube::duration duration,
                            T const&            arg)
 {
+    this->p_region();
     std::vector<std::string> argv;
     cpu::tube::context::format(argv, arg);
     this->do_report(name, duration, argv);
 }
 
+template <typename T>
+void
+cpu::tube::context::report(char const*            name,
+                           cpu::tube::duration    duration,
+                           T const&               arg,
+                           cpu::tube::work const& work)
+{
+    this->p_region();
+    std::vector<std::string> argv;
+    cpu::tube::context::format(argv, arg);
+    this->do_report(name, duration, argv, work);
+}
+
 // ----------------------------------------------------------------------------
 
 template <typename Measure, typename Case>
@@ -175,12 +246,18 @@ cpu::tube::context::intern_run(std::ostream&              out,
         for (int j(1); j < 10; j *= 2) {
             int size(i * j);
             auto result = measure.measure(*this, size, case_.test());
-            this->report(case_.name().c_str(), result.first, size);
+            cpu::tube::work work(cpu::tube::work_of(result));
+            this->report(case_.name().c_str(), result.first, size, work);
             out << (first? "": ",")
                 << " { "
                 << "result:\"" << result.second << "\", "
-                << "size:" << size << ", "
-                << "time:" << result.first << "  "
+                << "size:" << size << ", ";
+            if (!work.empty()) {
+                out << "bytes:" << work.bytes << ", "
+                    << "items:" << work.items << ", ";
+                cpu::tube::throughput(result.first, work).json(out);
+            }
+            out << "time:" << result.first << "  "
                 << "} " << std::flush;
             first = false;
         }
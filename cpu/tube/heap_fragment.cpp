@@ -25,34 +25,255 @@
 
 #include "cpu/tube/heap_fragment.hpp"
 #include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <cstdlib>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#endif
 
 // ----------------------------------------------------------------------------
-//
-heap_fragmenter::heap_fragmenter( int count, int size )
+
+namespace
+{
+    std::invalid_argument malformed(std::string const& key, std::string const& value)
+    {
+        return std::invalid_argument("heap_fragmenter: malformed value '" + value
+                                     + "' for '" + key + "'");
+    }
+
+    std::uint64_t parse_size(std::string const& key, std::string const& value)
+    {
+        std::size_t   end(0u);
+        std::uint64_t rc(0u);
+        try {
+            rc = std::stoull(value, &end);
+        }
+        catch (std::exception const&) {
+            throw malformed(key, value);
+        }
+        if (end + 1u == value.size()) {
+            switch (value[end]) {
+            default: throw malformed(key, value);
+            case 'k': rc <<= 10; break;
+            case 'M': rc <<= 20; break;
+            case 'G': rc <<= 30; break;
+            }
+        }
+        else if (end != value.size()) {
+            throw malformed(key, value);
+        }
+        return rc;
+    }
+
+    double parse_double(std::string const& key, std::string const& value)
+    {
+        std::size_t end(0u);
+        double      rc(0.0);
+        try {
+            rc = std::stod(value, &end);
+        }
+        catch (std::exception const&) {
+            throw malformed(key, value);
+        }
+        if (end != value.size()) {
+            throw malformed(key, value);
+        }
+        return rc;
+    }
+
+    // ------------------------------------------------------------------------
+
+    class size_generator
+    {
+    private:
+        heap_fragmenter::config const&             d_config;
+        std::uniform_int_distribution<std::size_t> d_uniform;
+        std::lognormal_distribution<double>        d_lognormal;
+        std::vector<std::size_t>                   d_sizes;
+        std::discrete_distribution<std::size_t>    d_histogram;
+
+    public:
+        explicit size_generator(heap_fragmenter::config const& cfg)
+            : d_config(cfg)
+            , d_uniform(std::max(std::size_t(1u), cfg.min_size),
+                        std::max(std::max(std::size_t(1u), cfg.min_size), cfg.max_size))
+            , d_lognormal(std::log(cfg.median), cfg.sigma)
+        {
+            if (cfg.sizes == heap_fragmenter::distribution::histogram) {
+                std::ifstream in(cfg.histogram);
+                if (!in) {
+                    throw std::runtime_error("heap_fragmenter: failed to open histogram '"
+                                             + cfg.histogram + "'");
+                }
+                std::vector<double> weights;
+                for (std::string line; std::getline(in, line); ) {
+                    std::istringstream lin(line.substr(0u, line.find('#')));
+                    std::size_t size;
+                    double      weight;
+                    if (lin >> size >> weight) {
+                        this->d_sizes.push_back(std::max(std::size_t(1u), size));
+                        weights.push_back(weight);
+                    }
+                }
+                if (this->d_sizes.empty()) {
+                    throw std::runtime_error("heap_fragmenter: empty histogram '"
+                                             + cfg.histogram + "'");
+                }
+                this->d_histogram = std::discrete_distribution<std::size_t>(weights.begin(),
+                                                                            weights.end());
+            }
+        }
+
+        template <typename Generator>
+        std::size_t operator()(Generator& gen)
+        {
+            switch (this->d_config.sizes) {
+            default:
+            case heap_fragmenter::distribution::uniform:
+                return this->d_uniform(gen);
+            case heap_fragmenter::distribution::lognormal:
+                return std::clamp(std::size_t(std::llround(this->d_lognormal(gen))),
+                                  this->d_uniform.min(), this->d_uniform.max());
+            case heap_fragmenter::distribution::histogram:
+                return this->d_sizes[this->d_histogram(gen)];
+            }
+        }
+    };
+
+    std::size_t resident_size()
+    {
+        std::ifstream in("/proc/self/statm");
+        std::size_t   size(0u), resident(0u);
+        return in >> size >> resident? resident * ::sysconf(_SC_PAGESIZE): 0u;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+heap_fragmenter::config
+heap_fragmenter::config::parse(std::string const& text)
+{
+    config rc;
+    std::istringstream in(text);
+    for (std::string item; std::getline(in, item, ','); ) {
+        if (item.empty()) {
+            continue;
+        }
+        std::string::size_type pos(item.find('='));
+        std::string key(item.substr(0u, pos));
+        std::string value(pos == item.npos? std::string(): item.substr(pos + 1u));
+        if (key == "count")          { rc.count = parse_size(key, value); }
+        else if (key == "min")       { rc.min_size = parse_size(key, value); }
+        else if (key == "max")       { rc.max_size = parse_size(key, value); }
+        else if (key == "median")    { rc.median = parse_double(key, value); }
+        else if (key == "sigma")     { rc.sigma = parse_double(key, value); }
+        else if (key == "live")      { rc.live = parse_size(key, value); }
+        else if (key == "rounds")    { rc.rounds = parse_size(key, value); }
+        else if (key == "seed")      { rc.seed = parse_size(key, value); }
+        else if (key == "histogram") {
+            rc.histogram = value;
+            rc.sizes     = distribution::histogram;
+        }
+        else if (key == "sizes") {
+            if (value == "uniform")        { rc.sizes = distribution::uniform; }
+            else if (value == "lognormal") { rc.sizes = distribution::lognormal; }
+            else if (value == "histogram") { rc.sizes = distribution::histogram; }
+            else { throw malformed(key, value); }
+        }
+        else {
+            throw std::invalid_argument("heap_fragmenter: unknown key '" + key + "'");
+        }
+    }
+    if (rc.median <= 0.0 || rc.sigma < 0.0) {
+        throw std::invalid_argument("heap_fragmenter: lognormal needs median > 0 and sigma >= 0");
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+heap_fragmenter::heap_fragmenter(config const& cfg)
+{
+    std::mt19937_64 gen(cfg.seed);
+    size_generator  sizes(cfg);
+    std::size_t     live(0u);
+
+    for (unsigned round(0u); round != cfg.rounds; ++round)
+    {
+        // create 2 * count allocations
+        allocated.reserve(allocated.size() + 2u * cfg.count);
+        for (std::size_t i(0u); i != 2u * cfg.count; ++i)
+        {
+            std::size_t size(sizes(gen));
+            allocated.emplace_back(new char[size], size);
+            live += size;
+        }
+
+        // shuffle them up
+        std::shuffle(allocated.begin(), allocated.end(), gen);
+
+        // remove random blocks until the target is reached
+        std::size_t keep(allocated.size() / 2u);
+        while (!allocated.empty()
+               && (cfg.live? cfg.live < live: keep < allocated.size()))
+        {
+            live -= allocated.back().second;
+            delete[] allocated.back().first;
+            allocated.pop_back();
+        }
+    }
+}
+
+heap_fragmenter::heap_fragmenter(int count, int size)
+    : heap_fragmenter([=]{
+            // create 'count' allocations of 1..size-1 bytes
+            config cfg;
+            cfg.count    = count;
+            cfg.max_size = std::max(1, size - 1);
+            return cfg;
+        }())
 {
-	// create 'count' allocations of 1..size bytes
-	allocated.reserve(count*2);
-	for (int i=0;i!=count*2;++i)
-		allocated.push_back( new char[ 1 + rand()%(size-1) ] );
-
-	// shuffle them up
-	std::random_shuffle(allocated.begin(), allocated.end());
-
-	// remove half
-	for (int i=0;i!=count;++i)
-	{
-		delete[] allocated.back();
-		allocated.pop_back();
-	}
 }
 
 heap_fragmenter::~heap_fragmenter()
 {
-	while (allocated.empty()==false)
-	{
-		delete[] allocated.back();
-		allocated.pop_back();
-	}
+    while (allocated.empty()==false)
+    {
+        delete[] allocated.back().first;
+        allocated.pop_back();
+    }
 }
 
+heap_fragmenter::stats
+heap_fragmenter::statistics() const
+{
+    stats rc{ allocated.size(), 0u, resident_size(), 0u, 0u, 0u };
+    for (auto const& block: allocated)
+    {
+        rc.bytes += block.second;
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info(::mallinfo2());
+    rc.arena      = info.arena;
+    rc.arena_free = info.fordblks;
+    rc.mmapped    = info.hblkhd;
+#endif
+    return rc;
+}
+
+std::ostream&
+operator<< (std::ostream& out, heap_fragmenter::stats const& s)
+{
+    return out << "heap-blocks=" << s.blocks << ' '
+               << "heap-bytes=" << s.bytes << ' '
+               << "rss=" << s.rss << ' '
+               << "arena=" << s.arena << ' '
+               << "arena-free=" << s.arena_free << ' '
+               << "mmapped=" << s.mmapped;
+}
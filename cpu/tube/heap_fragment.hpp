@@ -26,23 +26,91 @@
 #ifndef INCLUDED_CPU_TUBE_HEAP_FRAGMENT
 #define INCLUDED_CPU_TUBE_HEAP_FRAGMENT
 
+#include <iosfwd>
+#include <string>
+#include <utility>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 // ----------------------------------------------------------------------------
-// Creating this object leaves the heap in a fragmented state, with N allocations
-//  of 1...S bytes still allocated, remaining allocations are freed on destruction
-// the goal is to approximate the memory conditions of a live application
-// so cache coherency of heap allocated data structure access can be tested 
-// under closer to real world conditions
+// Creating this object leaves the heap in a fragmented state, with a set of
+// allocations still allocated, remaining allocations are freed on
+// destruction. The goal is to approximate the memory conditions of a live
+// application so cache coherency of heap allocated data structure access
+// can be tested under closer to real world conditions.
+//
+// The heap is aged in rounds: each round allocates 2 * count blocks whose
+// sizes are drawn from the configured distribution and then frees randomly
+// chosen blocks (of all rounds) until the live set is at most the target
+// (half of the blocks if no target is given). Thus, older blocks are more
+// likely to be freed, similar to a long running process. All random
+// choices use a seeded generator, i.e., the resulting heap is reproducible.
+//
+// A configuration can be created from a string of comma separated
+// key=value pairs (sizes accept the suffixes k, M, and G), e.g.
+//
+//     count=100000,sizes=lognormal,median=64,sigma=1.5,live=64M,rounds=8
+//
+// - count:   the number of blocks allocated per round (default 1024)
+// - sizes:   uniform, lognormal, or histogram (default uniform)
+// - min/max: the size range used by uniform and to clamp lognormal
+//            (default 1 and 64k)
+// - median/sigma: the parameters of lognormal (default 64 and 1.5)
+// - histogram: a file with lines "size weight"; '#' starts a comment
+// - live:    the target of the live bytes after each round (default: none)
+// - rounds:  the number of rounds (default 1)
+// - seed:    the seed of the random number generator (default 17)
 
 class heap_fragmenter
 {
 public:
-    heap_fragmenter( int n, int s );
+    enum class distribution { uniform, lognormal, histogram };
+    struct config;
+    struct stats;
+
+    explicit heap_fragmenter(config const& cfg);
+    heap_fragmenter(int n, int s);
+    heap_fragmenter(heap_fragmenter const&) = delete;
+    void operator=(heap_fragmenter const&) = delete;
     ~heap_fragmenter();
-	
+
+    // the live blocks of the fragmenter and the state of the process' heap
+    stats statistics() const;
+
 private:
-    std::vector<char*> allocated;
+    std::vector<std::pair<char*, std::size_t>> allocated;
 };
 
+// ----------------------------------------------------------------------------
+
+struct heap_fragmenter::config
+{
+    std::size_t  count{1024u};
+    distribution sizes{distribution::uniform};
+    std::size_t  min_size{1u};
+    std::size_t  max_size{64u * 1024u};
+    double       median{64.0};
+    double       sigma{1.5};
+    std::string  histogram;
+    std::size_t  live{0u}; // 0: free half of the blocks
+    unsigned     rounds{1u};
+    std::uint64_t seed{17u};
+
+    // throws std::invalid_argument for unknown keys or malformed values
+    static config parse(std::string const& text);
+};
+
+struct heap_fragmenter::stats
+{
+    std::size_t blocks;      // live blocks held by the fragmenter
+    std::size_t bytes;       // live bytes held by the fragmenter
+    std::size_t rss;         // resident set size of the process
+    std::size_t arena;       // bytes obtained by malloc using sbrk (0 if unknown)
+    std::size_t arena_free;  // free bytes within the malloc arena
+    std::size_t mmapped;     // bytes obtained by malloc using mmap
+};
+
+std::ostream& operator<< (std::ostream&, heap_fragmenter::stats const&);
+
 #endif // INCLUDED_CPU_TUBE_HEAP_FRAGMENT
@@ -0,0 +1,133 @@
+// cpu/tube/heap_fragment.t.cpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "heap_fragment.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+
+using config = heap_fragmenter::config;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "parse defaults", []{
+            config cfg(config::parse(""));
+            return cfg.count == 1024u && cfg.sizes == heap_fragmenter::distribution::uniform
+                && cfg.max_size == 64u * 1024u && cfg.live == 0u && cfg.rounds == 1u;
+        }
+    },
+    { "parse", []{
+            config cfg(config::parse("count=2k,sizes=lognormal,median=32,sigma=0.5,"
+                                     "max=1M,live=64M,rounds=8,seed=4711"));
+            return cfg.count == 2048u && cfg.sizes == heap_fragmenter::distribution::lognormal
+                && cfg.median == 32.0 && cfg.sigma == 0.5 && cfg.max_size == 1u << 20
+                && cfg.live == 64u << 20 && cfg.rounds == 8u && cfg.seed == 4711u;
+        }
+    },
+    { "parse errors", []{
+            int errors(0);
+            for (char const* text: { "unknown=1", "count=x", "count=1X", "sizes=normal", "sigma=-1" }) {
+                try {
+                    config::parse(text);
+                }
+                catch (std::invalid_argument const&) {
+                    ++errors;
+                }
+            }
+            return errors == 5;
+        }
+    },
+    { "half of the blocks", []{
+            heap_fragmenter fragment(100, 1000);
+            heap_fragmenter::stats s(fragment.statistics());
+            return s.blocks == 100u && s.bytes <= 100u * 999u && 0u < s.rss;
+        }
+    },
+    { "reproducible", []{
+            config cfg(config::parse("count=1000,sizes=lognormal,rounds=4,seed=3"));
+            heap_fragmenter f0(cfg), f1(cfg);
+            cfg.seed = 4;
+            heap_fragmenter f2(cfg);
+            return f0.statistics().bytes == f1.statistics().bytes
+                && f0.statistics().blocks == f1.statistics().blocks
+                && f0.statistics().bytes != f2.statistics().bytes;
+        }
+    },
+    { "live target", []{
+            heap_fragmenter fragment(config::parse("count=1000,max=1k,live=100k,rounds=5"));
+            heap_fragmenter::stats s(fragment.statistics());
+            return s.bytes <= 100u * 1024u && 100u * 1024u - 1024u < s.bytes;
+        }
+    },
+    { "histogram", []{
+            char const* name("/tmp/cputube-heap_fragment.t.histogram");
+            {
+                std::ofstream out(name);
+                out << "# size weight\n24 1\n\n4000 0 # never\n";
+            }
+            heap_fragmenter fragment(config::parse(std::string("count=10,histogram=") + name));
+            heap_fragmenter::stats s(fragment.statistics());
+            std::remove(name);
+            return s.blocks == 10u && s.bytes == 240u;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
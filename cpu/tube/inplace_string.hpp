@@ -0,0 +1,138 @@
+// cpu/tube/inplace_string.hpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_INPLACE_STRING
+#define INCLUDED_CPU_TUBE_INPLACE_STRING
+
+#include "cpu/format/compiled_format.hpp"
+#include <algorithm>
+#include <string_view>
+#include <cstddef>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// A string builder with an embedded buffer of N characters: as long as the
+// built string doesn't exceed N characters no memory is allocated. Longer
+// strings move to a heap buffer which is kept when the builder is clear()ed,
+// i.e., a hoisted builder allocates only until it has grown to the largest
+// string built. The characters are appended using
+//
+// - append(literal) for string literals (the terminating null isn't copied)
+// - append(view) for std::string_view
+// - append(value) for types with a cpu::format::formatter<T>, i.e., the
+//   integer types, char, and any type formatter is specialised for
+//
+// and operator<< is a shorthand for append(). The content isn't
+// null-terminated.
+
+namespace cpu
+{
+    namespace tube
+    {
+        template <std::size_t N>
+        class inplace_string;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <std::size_t N>
+class cpu::tube::inplace_string
+{
+private:
+    char* d_begin;
+    char* d_end;
+    char* d_limit;
+    char  d_buffer[N];
+
+    char* p_reserve(std::size_t n);
+
+public:
+    inplace_string(): d_begin(this->d_buffer), d_end(this->d_buffer), d_limit(this->d_buffer + N) {}
+    inplace_string(inplace_string const&) = delete;
+    void operator=(inplace_string const&) = delete;
+    ~inplace_string() { if (this->on_heap()) { delete[] this->d_begin; } }
+
+    bool        on_heap() const  { return this->d_begin != this->d_buffer; }
+    bool        empty() const    { return this->d_begin == this->d_end; }
+    std::size_t size() const     { return this->d_end - this->d_begin; }
+    std::size_t capacity() const { return this->d_limit - this->d_begin; }
+    char const* data() const     { return this->d_begin; }
+    char const* begin() const    { return this->d_begin; }
+    char const* end() const      { return this->d_end; }
+    std::string_view view() const { return std::string_view(this->d_begin, this->size()); }
+
+    void clear() { this->d_end = this->d_begin; }
+    void reserve(std::size_t n) { this->p_reserve(n < this->size()? 0u: n - this->size()); }
+
+    void push_back(char c) { *this->p_reserve(1u) = c; ++this->d_end; }
+    inplace_string& append(char const* s, std::size_t n) {
+        std::memcpy(this->p_reserve(n), s, n);
+        this->d_end += n;
+        return *this;
+    }
+    template <std::size_t M>
+    inplace_string& append(char const (&literal)[M]) { return this->append(literal, M - 1u); }
+    inplace_string& append(std::string_view view) { return this->append(view.data(), view.size()); }
+    template <typename T, std::size_t = cpu::format::formatter<T>::max_size>
+    inplace_string& append(T const& value) {
+        std::size_t const max_size(cpu::format::formatter<T>::max_size);
+        if (std::size_t(this->d_limit - this->d_end) < max_size) {
+            // the result may still fit: only grow if it actually doesn't
+            char tmp[max_size];
+            return this->append(tmp, cpu::format::formatter<T>::format(tmp, value) - tmp);
+        }
+        this->d_end = cpu::format::formatter<T>::format(this->d_end, value);
+        return *this;
+    }
+
+    template <typename T>
+    inplace_string& operator<< (T const& value) { return this->append(value); }
+};
+
+// ----------------------------------------------------------------------------
+
+template <std::size_t N>
+char*
+cpu::tube::inplace_string<N>::p_reserve(std::size_t n)
+{
+    if (std::size_t(this->d_limit - this->d_end) < n) {
+        std::size_t size(this->size());
+        std::size_t capacity(std::max(2u * this->capacity(), size + n));
+        char*       buffer(new char[capacity]);
+        std::memcpy(buffer, this->d_begin, size);
+        if (this->on_heap()) {
+            delete[] this->d_begin;
+        }
+        this->d_begin = buffer;
+        this->d_end   = buffer + size;
+        this->d_limit = buffer + capacity;
+    }
+    return this->d_end;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
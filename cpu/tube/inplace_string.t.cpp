@@ -0,0 +1,159 @@
+// cpu/tube/inplace_string.t.cpp                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "inplace_string.hpp"
+#include "cpu/tube/allocation.hpp"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct point {
+        int x, y;
+    };
+}
+
+template <>
+struct cpu::format::formatter<point> {
+    static constexpr std::size_t max_size = 2u * cpu::format::max_size<int> + 3u;
+    static char* format(char* to, point p) {
+        *to++ = '(';
+        to = format_int(to, p.x);
+        *to++ = ',';
+        to = format_int(to, p.y);
+        *to++ = ')';
+        return to;
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "empty", []{
+            CT::inplace_string<16> s;
+            return s.empty() && s.size() == 0u && s.capacity() == 16u
+                && !s.on_heap() && s.view() == "";
+        }
+    },
+    { "append", []{
+            CT::inplace_string<64> s;
+            s.append("value=").append(-17).append(std::string_view(", ")).append(point{1, 2});
+            s << ' ' << 42u << std::string("!");
+            s.push_back('\n');
+            return s.view() == "value=-17, (1,2) 42!\n" && !s.on_heap();
+        }
+    },
+    { "no allocation within capacity", []{
+            CT::allocation_count before(CT::allocation_counts());
+            {
+                CT::inplace_string<64> s;
+                for (int i(0); i != 100; ++i) {
+                    s.clear();
+                    s << "message " << i << " from " << point{i, -i} << '\n';
+                }
+            }
+            return (CT::allocation_counts() - before).allocations == 0u;
+        }
+    },
+    { "formatting near the capacity", []{
+            // less than the maximal size of an int is left but the value fits
+            CT::inplace_string<16> s;
+            s << "hello, w" << 7;
+            s << "-123456";
+            bool fits(!s.on_heap() && s.view() == "hello, w7-123456");
+            s << 42;
+            return fits && s.on_heap() && s.view() == "hello, w7-12345642";
+        }
+    },
+    { "spill to heap", []{
+            CT::inplace_string<8> s;
+            std::string expect;
+            for (int i(0); i != 100; ++i) {
+                s << i << ',';
+                expect += std::to_string(i) + ',';
+            }
+            return s.on_heap() && s.view() == expect && s.capacity() >= s.size();
+        }
+    },
+    { "clear keeps heap buffer", []{
+            CT::inplace_string<8> s;
+            s << "a string longer than eight characters";
+            std::size_t capacity(s.capacity());
+            CT::allocation_count before(CT::allocation_counts());
+            s.clear();
+            s << "another long string";
+            return s.on_heap() && s.capacity() == capacity
+                && s.view() == "another long string"
+                && (CT::allocation_counts() - before).allocations == 0u;
+        }
+    },
+    { "reserve", []{
+            CT::inplace_string<8> s;
+            s << "abc";
+            s.reserve(8u);
+            bool inplace(!s.on_heap());
+            s.reserve(100u);
+            return inplace && s.on_heap() && s.capacity() >= 100u && s.view() == "abc";
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    CT::count_allocations(true);
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,83 @@
+// cpu/tube/keys.hpp                                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_KEYS
+#define INCLUDED_CPU_TUBE_KEYS
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// The short string keys used by search-short-string and hash-functions: a
+// two letter country code followed by ten digits, e.g., "DE0123456780".
+// make_country_codes() returns size distinct keys in the order they are
+// generated, i.e., in a pseudo random order which is the same for each
+// call. The String type needs to be constructible from a char const*.
+
+namespace cpu
+{
+    namespace tube
+    {
+        template <typename String = std::string>
+        std::vector<String> make_country_codes(std::size_t size);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename String>
+std::vector<String> cpu::tube::make_country_codes(std::size_t size)
+{
+    std::minstd_rand rand;
+    rand.seed(17);
+
+    char const* const codes[] = {
+        "BE", "DE", "DK", "FR", "GB", "JP", "NL", "NO", "SE", "US"
+    };
+
+    std::unordered_set<std::string> seen;
+    std::vector<String>             rc;
+    rc.reserve(size);
+    std::ostringstream out;
+    out.fill('0');
+    while (rc.size() < size) {
+        out.str(std::string());
+        out << codes[rand() % 10]
+            << std::setw(9) << (rand() % 1000000000) << '0';
+        if (seen.insert(out.str()).second) {
+            rc.emplace_back(out.str().c_str());
+        }
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,97 @@
+// cpu/tube/keys.t.cpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/keys.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "format", []{
+            std::vector<std::string> keys(CT::make_country_codes(1000u));
+            return keys.size() == 1000u
+                && std::all_of(keys.begin(), keys.end(), [](std::string const& key){
+                        return key.size() == 12u
+                            && std::isupper(static_cast<unsigned char>(key[0]))
+                            && std::isupper(static_cast<unsigned char>(key[1]))
+                            && std::all_of(key.begin() + 2, key.end(), [](char c){
+                                    return std::isdigit(static_cast<unsigned char>(c));
+                                })
+                            && key.back() == '0';
+                    });
+        }},
+    { "distinct", []{
+            std::vector<std::string> keys(CT::make_country_codes(20000u));
+            return std::set<std::string>(keys.begin(), keys.end()).size() == keys.size();
+        }},
+    { "deterministic", []{
+            std::vector<std::string> small(CT::make_country_codes(100u));
+            std::vector<std::string> large(CT::make_country_codes(200u));
+            return small == CT::make_country_codes(100u)
+                && std::equal(small.begin(), small.end(), large.begin())
+                && !std::is_sorted(small.begin(), small.end());
+        }},
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
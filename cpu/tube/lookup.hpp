@@ -0,0 +1,106 @@
+// cpu/tube/lookup.hpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_LOOKUP
+#define INCLUDED_CPU_TUBE_LOOKUP
+
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Support for the lookup benchmarks (search-integer, search-short-string):
+// count_contained() yields the number of sought keys contained in a
+// competitor. Competitors providing contains_batch(begin, end) returning
+// the number of contained keys get all sought keys at once allowing them to
+// overlap the lookups. All other competitors are probed one key at a time
+// using contains(key). A count_iterator is an output iterator counting the
+// true values written to it, e.g., to implement contains_batch() using a
+// set's batch lookup writing one bool per key.
+
+namespace cpu
+{
+    namespace tube
+    {
+        class count_iterator;
+
+        template <typename Competitor, typename T>
+        long count_contained(Competitor const& competitor, std::vector<T> const& sought);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::tube::count_iterator
+{
+private:
+    long* d_total;
+
+public:
+    explicit count_iterator(long& total): d_total(&total) {}
+    count_iterator& operator*() { return *this; }
+    count_iterator& operator=(bool found) { *this->d_total += found; return *this; }
+    count_iterator& operator++() { return *this; }
+};
+
+// ----------------------------------------------------------------------------
+
+namespace cpu
+{
+    namespace tube
+    {
+        namespace lookup_detail
+        {
+            template <typename Competitor, typename T>
+            auto count_contained(Competitor const& competitor,
+                                 std::vector<T> const& sought, int)
+                -> decltype(competitor.contains_batch(sought.begin(), sought.end()))
+            {
+                return competitor.contains_batch(sought.begin(), sought.end());
+            }
+
+            template <typename Competitor, typename T>
+            long count_contained(Competitor const& competitor,
+                                 std::vector<T> const& sought, long)
+            {
+                long total(0);
+                for (T const& key: sought) {
+                    if (competitor.contains(key)) {
+                        ++total;
+                    }
+                }
+                return total;
+            }
+        }
+    }
+}
+
+template <typename Competitor, typename T>
+long cpu::tube::count_contained(Competitor const& competitor, std::vector<T> const& sought)
+{
+    return cpu::tube::lookup_detail::count_contained(competitor, sought, 0);
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,114 @@
+// cpu/tube/lookup.t.cpp                                              -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/lookup.hpp"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    struct probe {
+        std::set<int> values{ 1, 3, 5 };
+        mutable int   probes{0};
+        bool contains(int value) const {
+            ++this->probes;
+            return this->values.count(value) != 0u;
+        }
+    };
+    struct batch
+        : probe {
+        mutable int batches{0};
+        template <typename FwdIt>
+        long contains_batch(FwdIt it, FwdIt end) const {
+            ++this->batches;
+            long total(0);
+            CT::count_iterator out(total);
+            for (; it != end; ++it, ++out) {
+                *out = this->values.count(*it) != 0u;
+            }
+            return total;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "count_iterator", []{
+            long total(0);
+            std::vector<bool> found{ true, false, true, true };
+            std::copy(found.begin(), found.end(), CT::count_iterator(total));
+            return total == 3;
+        }},
+    { "probing one key at a time", []{
+            probe p;
+            return CT::count_contained(p, std::vector<int>{ 1, 2, 3, 4, 5 }) == 3
+                && p.probes == 5;
+        }},
+    { "batch lookup", []{
+            batch b;
+            return CT::count_contained(b, std::vector<int>{ 1, 2, 3, 4, 5 }) == 3
+                && b.batches == 1 && b.probes == 0;
+        }},
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,238 @@
+// cpu/tube/numa.cpp                                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/numa.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <cctype>
+#include <cstdlib>
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+std::vector<int> cpu::tube::parse_cpulist(std::string const& list)
+{
+    std::vector<int> cpus;
+    char const*      it(list.c_str());
+    while (*it) {
+        char* end;
+        long  first(std::strtol(it, &end, 10));
+        if (end == it) {
+            ++it; // skip separators and anything unexpected
+            continue;
+        }
+        long last(first);
+        it = end;
+        if (*it == '-') {
+            last = std::strtol(it + 1, &end, 10);
+            it = end == it + 1? it + 1: end;
+        }
+        for (long cpu(first); cpu <= last; ++cpu) {
+            cpus.push_back(int(cpu));
+        }
+    }
+    return cpus;
+}
+
+bool cpu::tube::pin_thread(std::vector<int> const& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu: cpus) {
+        if (0 <= cpu && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) && ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::numa_topology::numa_topology(std::vector<numa_node> nodes)
+    : d_nodes(std::move(nodes))
+{
+    this->d_nodes.erase(std::remove_if(this->d_nodes.begin(), this->d_nodes.end(),
+                                       [](numa_node const& node){ return node.cpus.empty(); }),
+                        this->d_nodes.end());
+    std::sort(this->d_nodes.begin(), this->d_nodes.end(),
+              [](numa_node const& n0, numa_node const& n1){ return n0.id < n1.id; });
+    if (this->d_nodes.empty()) {
+        numa_node node{0, {}};
+        for (int cpu(0), count(std::max(1u, std::thread::hardware_concurrency()));
+             cpu != count; ++cpu) {
+            node.cpus.push_back(cpu);
+        }
+        this->d_nodes.push_back(node);
+    }
+}
+
+cpu::tube::numa_topology cpu::tube::numa_topology::read(std::string const& root)
+{
+    std::vector<numa_node> nodes;
+#if defined(__linux__)
+    if (DIR* dir = ::opendir(root.c_str())) {
+        while (dirent* entry = ::readdir(dir)) {
+            std::string name(entry->d_name);
+            if (name.size() <= 4u || name.compare(0, 4, "node")
+                || !std::all_of(name.begin() + 4, name.end(),
+                                [](unsigned char c){ return std::isdigit(c); })) {
+                continue;
+            }
+            std::ifstream in(root + "/" + name + "/cpulist");
+            std::string   list((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+            nodes.push_back(numa_node{ std::atoi(name.c_str() + 4), parse_cpulist(list) });
+        }
+        ::closedir(dir);
+    }
+#else
+    (void)root;
+#endif
+    return numa_topology(std::move(nodes));
+}
+
+cpu::tube::numa_topology const& cpu::tube::numa_topology::system()
+{
+    static numa_topology const rc(read("/sys/devices/system/node"));
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int cpu::tube::numa_topology::cpus() const
+{
+    int rc(0);
+    for (auto const& node: this->d_nodes) {
+        rc += int(node.cpus.size());
+    }
+    return rc;
+}
+
+int cpu::tube::numa_topology::worker_node(int worker, int workers) const
+{
+    return workers <= 0? 0: int((long(worker) * this->size()) / workers);
+}
+
+int cpu::tube::numa_topology::worker_cpu(int worker, int workers) const
+{
+    int  node(this->worker_node(worker, workers));
+    long first((long(node) * workers + this->size() - 1) / this->size());
+    auto const& cpus(this->d_nodes[node].cpus);
+    return cpus[(worker - first) % cpus.size()];
+}
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::numa_pool::numa_pool(numa_topology const& topology, int workers)
+    : d_threads()
+    , d_lock()
+    , d_start()
+    , d_done()
+    , d_job()
+    , d_generation(0u)
+    , d_pending(0)
+    , d_stop(false)
+{
+    this->d_threads.reserve(workers);
+    for (int worker(0); worker < workers; ++worker) {
+        // each thread gets a copy of the topology to pin itself
+        this->d_threads.emplace_back(&numa_pool::p_work, this, topology, worker, workers);
+    }
+}
+
+cpu::tube::numa_pool::~numa_pool()
+{
+    {
+        std::lock_guard<std::mutex> kerberos(this->d_lock);
+        this->d_stop = true;
+    }
+    this->d_start.notify_all();
+    for (auto& thread: this->d_threads) {
+        thread.join();
+    }
+}
+
+cpu::tube::numa_pool& cpu::tube::numa_pool::system()
+{
+    numa_topology const&    topology(numa_topology::system());
+    static numa_pool        rc(topology, topology.cpus());
+    return rc;
+}
+
+void cpu::tube::numa_pool::p_work(numa_topology const& topology, int worker, int workers)
+{
+    cpu::tube::pin_thread({ topology.worker_cpu(worker, workers) });
+    std::uint64_t generation(0u);
+    std::unique_lock<std::mutex> kerberos(this->d_lock);
+    while (true) {
+        this->d_start.wait(kerberos, [&]{
+                return this->d_stop || generation != this->d_generation;
+            });
+        if (this->d_stop) {
+            return;
+        }
+        generation = this->d_generation;
+        kerberos.unlock();
+        this->d_job(worker);
+        kerberos.lock();
+        if (--this->d_pending == 0) {
+            this->d_done.notify_one();
+        }
+    }
+}
+
+void cpu::tube::numa_pool::run(std::function<void(int)> job)
+{
+    std::unique_lock<std::mutex> kerberos(this->d_lock);
+    this->d_job     = std::move(job);
+    this->d_pending = this->workers();
+    ++this->d_generation;
+    this->d_start.notify_all();
+    this->d_done.wait(kerberos, [this]{ return this->d_pending == 0; });
+}
+
+// ----------------------------------------------------------------------------
+
+std::ostream& cpu::tube::operator<< (std::ostream& out, numa_topology const& topology)
+{
+    std::ostringstream cpus;
+    for (auto const& node: topology.nodes()) {
+        cpus << (&node == &topology.nodes().front()? "": "+") << node.cpus.size();
+    }
+    return out << "numa-nodes=" << topology.size() << ' '
+               << "numa-cpus=" << cpus.str();
+}
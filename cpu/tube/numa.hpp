@@ -0,0 +1,151 @@
+// cpu/tube/numa.hpp                                                  -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_NUMA
+#define INCLUDED_CPU_TUBE_NUMA
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// The NUMA topology of the machine as described by /sys/devices/system/node:
+// each directory nodeN lists the CPUs of the node in the file cpulist
+// (e.g. "0-7,16-23"). Nodes without CPUs (memory only nodes) are ignored.
+// If no node is found, e.g., because the kernel doesn't support NUMA or on
+// systems other than Linux, the topology is a single node with all CPUs.
+//
+// The worker layout assigns the workers of a parallel algorithm to the
+// nodes in blocks: with W workers and N nodes, worker w runs on node
+// w * N / W. Consecutive workers stay on the same node, i.e., when the
+// workers process contiguous chunks in worker order and the data is
+// partitioned the same way (see cpu::memory::numa_array) all accesses are
+// node local. run_workers() runs fun(w) for all workers on threads pinned
+// according to this layout. A numa_pool keeps such pinned workers alive,
+// i.e., running a parallel algorithm on the pool doesn't include the cost
+// of creating and pinning the threads.
+
+namespace cpu
+{
+    namespace tube
+    {
+        struct numa_node;
+        class numa_topology;
+        class numa_pool;
+        std::ostream& operator<< (std::ostream&, numa_topology const&);
+
+        std::vector<int> parse_cpulist(std::string const& list);
+        bool             pin_thread(std::vector<int> const& cpus);
+
+        template <typename Fun>
+        void run_workers(numa_topology const& topology, int workers, Fun fun);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::numa_node
+{
+    int              id;
+    std::vector<int> cpus;
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::tube::numa_topology
+{
+private:
+    std::vector<numa_node> d_nodes;
+
+public:
+    // an empty list of nodes yields a single node with all CPUs
+    explicit numa_topology(std::vector<numa_node> nodes);
+    static numa_topology        read(std::string const& root);
+    static numa_topology const& system(); // read("/sys/devices/system/node")
+
+    std::vector<numa_node> const& nodes() const { return this->d_nodes; }
+    int size() const { return int(this->d_nodes.size()); }
+    int cpus() const;
+
+    // the index into nodes() and the CPU used by the worker
+    int worker_node(int worker, int workers) const;
+    int worker_cpu(int worker, int workers) const;
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::tube::numa_pool
+{
+private:
+    std::vector<std::thread>  d_threads;
+    std::mutex                d_lock;
+    std::condition_variable   d_start;
+    std::condition_variable   d_done;
+    std::function<void(int)>  d_job;
+    std::uint64_t             d_generation;
+    int                       d_pending;
+    bool                      d_stop;
+
+    void p_work(numa_topology const& topology, int worker, int workers);
+
+public:
+    numa_pool(numa_topology const& topology, int workers);
+    numa_pool(numa_pool const&) = delete;
+    void operator=(numa_pool const&) = delete;
+    ~numa_pool();
+    // a pool with a worker for each CPU of the system's topology
+    static numa_pool& system();
+
+    int workers() const { return int(this->d_threads.size()); }
+    // runs job(w) for all workers and waits for them to complete
+    void run(std::function<void(int)> job);
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename Fun>
+void cpu::tube::run_workers(numa_topology const& topology, int workers, Fun fun)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (int worker(0); worker != workers; ++worker) {
+        threads.emplace_back([&topology, &fun, worker, workers](){
+                cpu::tube::pin_thread({ topology.worker_cpu(worker, workers) });
+                fun(worker);
+            });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
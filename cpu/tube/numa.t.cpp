@@ -0,0 +1,186 @@
+// cpu/tube/numa.t.cpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "numa.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    std::string fake_root() {
+        std::string root("/tmp/cputube-numa-" + std::to_string(::getpid()));
+        ::mkdir(root.c_str(), 0700);
+        return root;
+    }
+    void fake_node(std::string const& root, std::string const& name,
+                   std::string const& cpulist) {
+        std::string dir(root + "/" + name);
+        ::mkdir(dir.c_str(), 0700);
+        std::ofstream(dir + "/cpulist") << cpulist;
+    }
+    void remove(std::string const& root, std::vector<std::string> const& names) {
+        for (auto const& name: names) {
+            std::string dir(root + "/" + name);
+            ::unlink((dir + "/cpulist").c_str());
+            ::rmdir(dir.c_str());
+        }
+        ::rmdir(root.c_str());
+    }
+
+    CT::numa_topology two_nodes() {
+        return CT::numa_topology({ { 1, { 4, 5, 6, 7 } }, { 0, { 0, 1, 2, 3 } } });
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "parse cpulist", []{
+            return CT::parse_cpulist("") == std::vector<int>()
+                && CT::parse_cpulist("3\n") == std::vector<int>{ 3 }
+                && CT::parse_cpulist("0-3") == std::vector<int>{ 0, 1, 2, 3 }
+                && CT::parse_cpulist("0-1,8,10-11\n") == std::vector<int>{ 0, 1, 8, 10, 11 };
+        }
+    },
+    { "single node fallback", []{
+            CT::numa_topology topology(CT::numa_topology::read("/does/not/exist"));
+            return topology.size() == 1
+                && 1 <= topology.cpus()
+                && topology.nodes()[0].cpus[0] == 0;
+        }
+    },
+    { "read nodes", []{
+            std::string root(fake_root());
+            fake_node(root, "node1", "8-15\n");
+            fake_node(root, "node0", "0-7\n");
+            fake_node(root, "node2", "\n");     // memory only
+            fake_node(root, "nodelist", "0");   // not a node
+            CT::numa_topology topology(CT::numa_topology::read(root));
+            remove(root, { "node0", "node1", "node2", "nodelist" });
+            return topology.size() == 2
+                && topology.cpus() == 16
+                && topology.nodes()[0].id == 0
+                && topology.nodes()[1].id == 1
+                && topology.nodes()[1].cpus.front() == 8;
+        }
+    },
+    { "system", []{
+            CT::numa_topology const& topology(CT::numa_topology::system());
+            std::ostringstream out;
+            out << topology;
+            return 1 <= topology.size()
+                && &topology == &CT::numa_topology::system()
+                && out.str().find("numa-nodes=") == 0u;
+        }
+    },
+    { "worker layout", []{
+            CT::numa_topology topology(two_nodes());
+            std::vector<int> nodes, cpus;
+            for (int worker(0); worker != 8; ++worker) {
+                nodes.push_back(topology.worker_node(worker, 8));
+                cpus.push_back(topology.worker_cpu(worker, 8));
+            }
+            return nodes == std::vector<int>{ 0, 0, 0, 0, 1, 1, 1, 1 }
+                && cpus == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7 }
+                && topology.worker_cpu(2, 3) == 4       // workers 0, 1 on node 0
+                && topology.worker_cpu(9, 10) == 4;     // wraps around on node 1
+        }
+    },
+    { "run workers", []{
+            std::atomic<int>  count{0};
+            std::vector<int>  seen(5, 0);
+            CT::run_workers(CT::numa_topology::system(), 5, [&](int worker){
+                    ++seen[worker];
+                    ++count;
+                });
+            return count == 5
+                && std::all_of(seen.begin(), seen.end(), [](int s){ return s == 1; });
+        }
+    },
+    { "pool", []{
+            std::vector<int> seen(3, 0);
+            bool success(true);
+            {
+                CT::numa_pool pool(two_nodes(), 3);
+                for (int round(1); round != 100; ++round) {
+                    pool.run([&](int worker){ ++seen[worker]; });
+                    success = success && seen == std::vector<int>(3, round);
+                }
+                success = success && pool.workers() == 3;
+            }
+            CT::numa_pool& system(CT::numa_pool::system());
+            std::atomic<int> count{0};
+            system.run([&](int){ ++count; });
+            return success
+                && &system == &CT::numa_pool::system()
+                && system.workers() == CT::numa_topology::system().cpus()
+                && count == system.workers();
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
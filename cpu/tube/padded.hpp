@@ -0,0 +1,97 @@
+// cpu/tube/padded.hpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_PADDED
+#define INCLUDED_CPU_TUBE_PADDED
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+// padded<T> holds a T aligned to and padded to a multiple of the
+// destructive interference size, i.e., objects accessed by different
+// threads don't share a cache line when they are padded. For example,
+// per-thread counters in an array of padded<std::atomic<long>> don't
+// suffer from false sharing.
+//
+// The interference size is std::hardware_destructive_interference_size
+// where the library provides it and 64 otherwise. The value is used for
+// the layout of objects compiled separately, i.e., it isn't tuned for the
+// processor the code happens to run on.
+
+namespace cpu
+{
+    namespace tube
+    {
+#if defined(__cpp_lib_hardware_interference_size)
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Winterference-size"
+#  endif
+        constexpr std::size_t destructive_interference_size{std::hardware_destructive_interference_size};
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif
+#else
+        constexpr std::size_t destructive_interference_size{64u};
+#endif
+
+        template <typename T, std::size_t Align = destructive_interference_size>
+        struct padded;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T, std::size_t Align>
+struct alignas(Align) cpu::tube::padded
+{
+private:
+    // a single padded argument uses the copy or move constructor
+    template <typename... Args>
+    struct is_self: std::false_type {};
+    template <typename Arg>
+    struct is_self<Arg>: std::is_same<typename std::decay<Arg>::type, padded> {};
+
+public:
+    T value;
+
+    template <typename... Args,
+              typename = typename std::enable_if<!is_self<Args...>::value>::type>
+    padded(Args&&... args): value(std::forward<Args>(args)...) {}
+
+    T&       get()              { return this->value; }
+    T const& get() const        { return this->value; }
+    T&       operator*()        { return this->value; }
+    T const& operator*() const  { return this->value; }
+    T*       operator->()       { return &this->value; }
+    T const* operator->() const { return &this->value; }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,114 @@
+// cpu/tube/padded.t.cpp                                              -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "padded.hpp"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "layout", []{
+            using type = CT::padded<std::atomic<long>>;
+            type array[3];
+            auto distance(reinterpret_cast<char*>(&array[1].value)
+                          - reinterpret_cast<char*>(&array[0].value));
+            return sizeof(type) == CT::destructive_interference_size
+                && alignof(type) == CT::destructive_interference_size
+                && std::size_t(distance) == CT::destructive_interference_size
+                && reinterpret_cast<std::uintptr_t>(&array[2]) % CT::destructive_interference_size == 0u;
+        }
+    },
+    { "large values", []{
+            using type = CT::padded<char[100], 32u>;
+            return sizeof(type) == 128u && alignof(type) == 32u;
+        }
+    },
+    { "access", []{
+            CT::padded<std::string> value(3u, 'x');
+            value->append("y");
+            CT::padded<std::string> const& ref(value);
+            return *ref == "xxxy" && ref.get().size() == 4u && &value.get() == &value.value;
+        }
+    },
+    { "copy", []{
+            CT::padded<int>         i0(17);
+            CT::padded<int>         i1(i0);   // non-const lvalue
+            CT::padded<int> const   i2(i1);
+            CT::padded<int>         i3(i2);   // const lvalue
+            CT::padded<std::string> s0(std::string("hello"));
+            CT::padded<std::string> s1(s0);
+            s1 = s0;
+            return *i1 == 17 && *i3 == 17 && *s0 == "hello" && *s1 == "hello";
+        }
+    },
+    { "move", []{
+            CT::padded<std::string> s0(std::string(100, 'x'));
+            char const*             data(s0->data());
+            CT::padded<std::string> s1(std::move(s0));
+            CT::padded<std::string> s2;
+            s2 = std::move(s1);
+            return s2->size() == 100u && s2->data() == data;
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,169 @@
+// cpu/tube/perf_counter.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/perf_counter.hpp"
+#include <utility>
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+char const* cpu::tube::to_string(perf_event event)
+{
+    switch (event) {
+    case perf_event::cycles:           return "cycles";
+    case perf_event::instructions:     return "instructions";
+    case perf_event::dtlb_load_misses: return "dtlb-misses";
+    case perf_event::llc_load_misses:  return "llc-misses";
+    }
+    return "unknown";
+}
+
+char const* cpu::tube::to_string(perf_scope scope)
+{
+    switch (scope) {
+    case perf_scope::thread: return "thread";
+    case perf_scope::system: return "system";
+    }
+    return "unknown";
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(__linux__)
+namespace
+{
+    // with pid == 0 the calling thread is counted, with pid == -1 all
+    // threads on the given CPU
+    int open_counter(cpu::tube::perf_event event, int pid, int cpu)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.inherit        = pid == 0; // threads created later are counted, too
+        auto cache = [](unsigned long cache){
+            return cache
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        switch (event) {
+        case cpu::tube::perf_event::cycles:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case cpu::tube::perf_event::instructions:
+            attr.type   = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case cpu::tube::perf_event::dtlb_load_misses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_DTLB);
+            break;
+        case cpu::tube::perf_event::llc_load_misses:
+            attr.type   = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_LL);
+            break;
+        }
+        return int(::syscall(__NR_perf_event_open, &attr, pid, cpu, -1, 0));
+    }
+
+    // One counter per CPU; CPUs which are offline are skipped. If any other
+    // counter can't be opened, none is used.
+    std::vector<int> open_system_counters(cpu::tube::perf_event event)
+    {
+        std::vector<int> rc;
+        for (long cpu(0), cpus(::sysconf(_SC_NPROCESSORS_CONF)); cpu < cpus; ++cpu) {
+            int fd(open_counter(event, -1, int(cpu)));
+            if (0 <= fd) {
+                rc.push_back(fd);
+            }
+            else if (errno != ENODEV) {
+                for (int open: rc) {
+                    ::close(open);
+                }
+                return std::vector<int>();
+            }
+        }
+        return rc;
+    }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::perf_counter::perf_counter(perf_event event, perf_scope scope)
+    : d_fds()
+    , d_scope(scope)
+{
+#if defined(__linux__)
+    if (scope == perf_scope::system) {
+        this->d_fds = open_system_counters(event);
+    }
+    else {
+        int fd(open_counter(event, 0, -1));
+        if (0 <= fd) {
+            this->d_fds.push_back(fd);
+        }
+    }
+#else
+    (void)event;
+#endif
+}
+
+cpu::tube::perf_counter::perf_counter(perf_counter&& other)
+    : d_fds(std::exchange(other.d_fds, std::vector<int>()))
+    , d_scope(other.d_scope)
+{
+}
+
+cpu::tube::perf_counter::~perf_counter()
+{
+#if defined(__linux__)
+    for (int fd: this->d_fds) {
+        ::close(fd);
+    }
+#endif
+}
+
+std::uint64_t cpu::tube::perf_counter::value() const
+{
+    std::uint64_t rc(0u);
+#if defined(__linux__)
+    for (int fd: this->d_fds) {
+        std::uint64_t count(0u);
+        if (::read(fd, &count, sizeof(count)) == sizeof(count)) {
+            rc += count;
+        }
+    }
+#endif
+    return rc;
+}
@@ -0,0 +1,83 @@
+// cpu/tube/perf_counter.hpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_PERF_COUNTER
+#define INCLUDED_CPU_TUBE_PERF_COUNTER
+
+#include <vector>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// A hardware event counter using perf_event_open(2): the counter starts
+// counting when it is constructed and value() yields the number of events
+// counted so far in user space. The scope determines what is counted:
+//
+// - thread: the calling thread. Threads created after the counter inherit
+//   it but the kernel adds their events to value() only when they exit,
+//   i.e., the events of worker threads staying alive, e.g., in a thread
+//   pool, are missing.
+// - system: all threads on all CPUs using one counter per CPU, i.e., it
+//   includes pooled workers but also other processes. It usually needs
+//   perf_event_paranoid to be at most 0 (or CAP_PERFMON).
+//
+// Counters are only available on Linux and if the kernel permits their use
+// (see /proc/sys/kernel/perf_event_paranoid); otherwise available() is
+// false and value() is always 0.
+
+namespace cpu
+{
+    namespace tube
+    {
+        enum class perf_event { cycles, instructions, dtlb_load_misses, llc_load_misses };
+        enum class perf_scope { thread, system };
+        char const* to_string(perf_event);
+        char const* to_string(perf_scope);
+        class perf_counter;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+class cpu::tube::perf_counter
+{
+private:
+    std::vector<int> d_fds; // one per CPU for the system scope
+    perf_scope       d_scope;
+
+public:
+    explicit perf_counter(perf_event event, perf_scope scope = perf_scope::thread);
+    perf_counter(perf_counter&& other);
+    perf_counter(perf_counter const&) = delete;
+    void operator=(perf_counter const&) = delete;
+    ~perf_counter();
+
+    bool          available() const { return !this->d_fds.empty(); }
+    perf_scope    scope() const { return this->d_scope; }
+    std::uint64_t value() const;
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
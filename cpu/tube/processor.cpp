@@ -25,11 +25,14 @@
 
 #include "processor.hpp"
 #include <algorithm>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <ostream>
 #include <sstream>
 #include <cctype>
+#include <cstdlib>
+#include <limits>
 #include <inttypes.h>
 
 // ----------------------------------------------------------------------------
@@ -129,3 +132,79 @@ std::ostream& cpu::tube::operator<< (std::ostream&               out,
 {
     return processor.print(out);
 }
+
+// ----------------------------------------------------------------------------
+
+double cpu::tube::memory_profile::bandwidth() const
+{
+    return std::max({ this->copy, this->scale, this->add, this->triad,
+                      this->nt_copy, this->nt_triad });
+}
+
+std::string cpu::tube::memory_profile::path()
+{
+    char const* path(std::getenv("CPUTUBE_MEMORY_PROFILE"));
+    return path && *path? path: "results/memory-profile";
+}
+
+cpu::tube::memory_profile cpu::tube::memory_profile::load(std::string const& path)
+{
+    memory_profile profile;
+    std::ifstream  in(path);
+    std::string    key;
+    while (in >> key) {
+        double* value(key == "copy"?     &profile.copy
+                      : key == "scale"?    &profile.scale
+                      : key == "add"?      &profile.add
+                      : key == "triad"?    &profile.triad
+                      : key == "nt_copy"?  &profile.nt_copy
+                      : key == "nt_triad"? &profile.nt_triad
+                      : nullptr);
+        std::size_t size;
+        double      latency;
+        if (value) {
+            in >> *value;
+        }
+        else if (key == "latency" && in >> size >> latency) {
+            profile.latency.emplace_back(size, latency);
+        }
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return profile;
+}
+
+bool cpu::tube::memory_profile::save(std::string const& path) const
+{
+    std::ofstream out(path);
+    out << "copy " << this->copy << "\n"
+        << "scale " << this->scale << "\n"
+        << "add " << this->add << "\n"
+        << "triad " << this->triad << "\n"
+        << "nt_copy " << this->nt_copy << "\n"
+        << "nt_triad " << this->nt_triad << "\n";
+    for (auto const& latency: this->latency) {
+        out << "latency " << latency.first << " " << latency.second << "\n";
+    }
+    return bool(out.flush());
+}
+
+std::ostream& cpu::tube::operator<< (std::ostream&                    out,
+                                     cpu::tube::memory_profile const& profile)
+{
+    std::ostringstream str;
+    str.precision(3);
+    str << "bandwidth=" << profile.bandwidth() << "GB/s";
+    if (!profile.latency.empty()) {
+        str << " latency=" << profile.latency.front().second << "-"
+            << profile.latency.back().second << "ns";
+    }
+    return out << str.str();
+}
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::memory_profile const& cpu::tube::processor::memory()
+{
+    static memory_profile const profile(memory_profile::load(memory_profile::path()));
+    return profile;
+}
@@ -27,6 +27,10 @@
 #define INCLUDED_CPU_TUBE_PROCESSOR
 
 #include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
 
 // ----------------------------------------------------------------------------
 
@@ -36,9 +40,40 @@ namespace cpu
     {
         class processor;
         std::ostream& operator<< (std::ostream&, processor const&);
+        struct memory_profile;
+        std::ostream& operator<< (std::ostream&, memory_profile const&);
     }
 }
 
+// ----------------------------------------------------------------------------
+// The memory characteristics of the machine as measured by the
+// memory-hierarchy benchmark: the best STREAM bandwidths over the thread
+// counts in GB/s and the latency of a dependent load in ns for working
+// sets of different sizes. The profile is stored in a text file with one
+// "key value" line per value (latencies use the key "latency <bytes>") at
+// the location given by the environment variable CPUTUBE_MEMORY_PROFILE or
+// results/memory-profile. Other benchmarks can use the profile to relate
+// their throughput to the achievable bandwidth.
+
+struct cpu::tube::memory_profile
+{
+    double copy{0.0};
+    double scale{0.0};
+    double add{0.0};
+    double triad{0.0};
+    double nt_copy{0.0};  // copy using non-temporal stores
+    double nt_triad{0.0}; // triad using non-temporal stores
+    std::vector<std::pair<std::size_t, double>> latency;
+
+    bool   empty() const { return this->triad == 0.0 && this->latency.empty(); }
+    // the best of the measured bandwidths
+    double bandwidth() const;
+
+    static std::string    path();
+    static memory_profile load(std::string const& path);
+    bool                  save(std::string const& path) const;
+};
+
 // ----------------------------------------------------------------------------
 
 class cpu::tube::processor
@@ -47,6 +82,8 @@ public:
     static std::string value();
     // possibly there are some useful attributes to be exposed
     static std::ostream& print(std::ostream&);
+    // the profile loaded from memory_profile::path(); empty if there is none
+    static memory_profile const& memory();
 };
 
 // ----------------------------------------------------------------------------
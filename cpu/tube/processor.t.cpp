@@ -0,0 +1,101 @@
+// cpu/tube/processor.t.cpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "processor.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "empty profile", []{
+            CT::memory_profile profile(CT::memory_profile::load("/nonexistent/memory-profile"));
+            return profile.empty() && profile.bandwidth() == 0.0;
+        }
+    },
+    { "save and load", []{
+            CT::memory_profile profile;
+            profile.copy     = 10.5;
+            profile.triad    = 12.25;
+            profile.nt_triad = 14.0;
+            profile.latency  = { { 4096u, 1.5 }, { 1u << 30, 95.0 } };
+            std::string path("memory-profile.t.tmp");
+            bool saved(profile.save(path));
+            CT::memory_profile loaded(CT::memory_profile::load(path));
+            std::remove(path.c_str());
+            return saved && !loaded.empty()
+                && loaded.copy == 10.5 && loaded.scale == 0.0 && loaded.triad == 12.25
+                && loaded.bandwidth() == 14.0
+                && loaded.latency == profile.latency;
+        }
+    },
+    { "print", []{
+            CT::memory_profile profile;
+            profile.add     = 8.0;
+            profile.latency = { { 4096u, 1.5 }, { 8192u, 2.0 } };
+            std::ostringstream out;
+            out << profile;
+            return out.str() == "bandwidth=8GB/s latency=1.5-2ns";
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,354 @@
+// cpu/tube/stream.cpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/stream.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+char const* cpu::tube::to_string(stream_mode mode)
+{
+    switch (mode) {
+    case stream_mode::read:      return "read";
+    case stream_mode::mmap:      return "mmap";
+    case stream_mode::pipelined: return "pipelined";
+    }
+    return "unknown";
+}
+
+double cpu::tube::stream_result::gb_per_second() const
+{
+    unsigned long microseconds(this->time.microseconds());
+    return microseconds? this->bytes / (microseconds * 1e3): 0.0;
+}
+
+std::ostream& cpu::tube::operator<< (std::ostream&                   out,
+                                     cpu::tube::stream_result const& result)
+{
+    return out << "GB/s=" << std::fixed << std::setprecision(3) << result.gb_per_second()
+               << " bytes=" << result.bytes << " kept=" << result.kept;
+}
+
+// ----------------------------------------------------------------------------
+// The text is produced by a xorshift generator picking between a few kinds
+// of tokens; this is fast enough to create several GB in a few seconds.
+
+namespace
+{
+    class text_generator
+    {
+    private:
+        std::uint64_t d_state;
+
+        std::uint64_t next() {
+            this->d_state ^= this->d_state << 13;
+            this->d_state ^= this->d_state >> 7;
+            this->d_state ^= this->d_state << 17;
+            return this->d_state;
+        }
+        void word(std::string& out, char const* letters, std::size_t count,
+                  std::uint64_t length) {
+            for (; length; --length) {
+                out.push_back(letters[this->next() % count]);
+            }
+        }
+
+    public:
+        explicit text_generator(unsigned seed): d_state(0x9E3779B97F4A7C15u ^ seed) {}
+
+        void append(std::string& out, std::size_t size) {
+            static char const lower[] = "etaoinshrdlcumwfgypbvkjxqz";
+            static char const ident[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+            static char const punct[] = ".,;:!?()[]{}<>=+*/\"'#%&@";
+            std::size_t column(0u);
+            while (out.size() < size) {
+                std::uint64_t r(this->next());
+                std::size_t   before(out.size());
+                switch (r % 8u) {
+                default: this->word(out, lower, 26u, 1u + (r >> 8) % 9u); break;
+                case 5:  this->word(out, ident, 63u, 4u + (r >> 8) % 16u); break;
+                case 6:  this->word(out, ident + 53, 10u, 1u + (r >> 8) % 12u); break;
+                case 7:  this->word(out, punct, sizeof(punct) - 1u, 1u); break;
+                }
+                column += out.size() - before + 1u;
+                if (60u + (r >> 32) % 40u < column) {
+                    out.push_back('\n');
+                    column = 0u;
+                }
+                else {
+                    out.push_back(' ');
+                }
+            }
+            out.resize(size);
+        }
+    };
+}
+
+std::string cpu::tube::generate_text(std::size_t size, unsigned seed)
+{
+    std::string rc;
+    rc.reserve(size + 32u);
+    text_generator(seed).append(rc, size);
+    return rc;
+}
+
+void cpu::tube::generate_corpus(std::string const& path, std::uint64_t size, unsigned seed)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && std::uint64_t(st.st_size) == size) {
+        return;
+    }
+    std::ofstream   out(path, std::ios::binary | std::ios::trunc);
+    text_generator  gen(seed);
+    std::string     chunk;
+    std::size_t const chunk_size(1u << 22);
+    for (std::uint64_t done(0u); done < size; done += chunk.size()) {
+        chunk.clear();
+        gen.append(chunk, std::size_t(std::min<std::uint64_t>(chunk_size, size - done)));
+        out.write(chunk.data(), chunk.size());
+    }
+    if (!out.flush()) {
+        throw std::runtime_error("failed to write the corpus '" + path + "'");
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::chunk_source::impl
+{
+    int           d_fd;
+    std::uint64_t d_size;
+    std::size_t   d_chunk;
+
+    explicit impl(char const* path, std::size_t chunk)
+        : d_fd(::open(path, O_RDONLY))
+        , d_chunk(chunk) {
+        struct stat st;
+        if (this->d_fd < 0 || ::fstat(this->d_fd, &st) < 0) {
+            int error(errno);
+            if (0 <= this->d_fd) {
+                ::close(this->d_fd);
+            }
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        this->d_size = st.st_size;
+        ::posix_fadvise(this->d_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    virtual ~impl() { ::close(this->d_fd); }
+    virtual bool next(std::string& buffer) = 0;
+
+    bool read(std::string& buffer) {
+        buffer.resize(this->d_chunk);
+        std::size_t size(0u);
+        while (size != buffer.size()) {
+            ssize_t rc(::read(this->d_fd, &buffer[size], buffer.size() - size));
+            if (rc < 0 && errno == EINTR) {
+                continue;
+            }
+            if (rc < 0) {
+                throw std::system_error(errno, std::generic_category(), "read()");
+            }
+            if (rc == 0) {
+                break;
+            }
+            size += rc;
+        }
+        buffer.resize(size);
+        return size != 0u;
+    }
+};
+
+namespace
+{
+    struct read_source
+        : cpu::tube::chunk_source::impl
+    {
+        using impl::impl;
+        bool next(std::string& buffer) override { return this->read(buffer); }
+    };
+
+    struct mmap_source
+        : cpu::tube::chunk_source::impl
+    {
+        char const*   d_data;
+        std::uint64_t d_offset{};
+
+        mmap_source(char const* path, std::size_t chunk)
+            : impl(path, chunk)
+            , d_data(static_cast<char const*>(this->d_size == 0u? nullptr
+                     : ::mmap(nullptr, this->d_size, PROT_READ, MAP_PRIVATE, this->d_fd, 0))) {
+            if (this->d_data == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "mmap()");
+            }
+            ::madvise(const_cast<char*>(this->d_data), this->d_size, MADV_SEQUENTIAL);
+        }
+        ~mmap_source() {
+            if (this->d_data) {
+                ::munmap(const_cast<char*>(this->d_data), this->d_size);
+            }
+        }
+        bool next(std::string& buffer) override {
+            std::size_t size(std::min<std::uint64_t>(this->d_chunk, this->d_size - this->d_offset));
+            buffer.assign(this->d_data + this->d_offset, size);
+            this->d_offset += size;
+            return size != 0u;
+        }
+    };
+
+    // The reader thread fills the buffers from `free` and queues them in
+    // `ready`; next() swaps the caller's buffer with the first ready one
+    // and returns the caller's buffer to `free`, i.e., the memory is reused.
+    struct pipelined_source
+        : cpu::tube::chunk_source::impl
+    {
+        static constexpr std::size_t depth{4u};
+        std::mutex               d_mutex;
+        std::condition_variable  d_condition;
+        std::deque<std::string>  d_free;
+        std::deque<std::string>  d_ready;
+        bool                     d_end{false};
+        bool                     d_stop{false};
+        std::exception_ptr       d_error;
+        std::thread              d_thread;
+
+        void run() {
+            while (true) {
+                std::string buffer;
+                {
+                    std::unique_lock<std::mutex> lock(this->d_mutex);
+                    this->d_condition.wait(lock, [this]{ return this->d_stop || !this->d_free.empty(); });
+                    if (this->d_stop) {
+                        return;
+                    }
+                    buffer = std::move(this->d_free.front());
+                    this->d_free.pop_front();
+                }
+                bool more(false);
+                try {
+                    more = this->read(buffer);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(this->d_mutex);
+                    this->d_error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(this->d_mutex);
+                if (more) {
+                    this->d_ready.push_back(std::move(buffer));
+                }
+                else {
+                    this->d_end = true;
+                }
+                this->d_condition.notify_all();
+                if (!more) {
+                    return;
+                }
+            }
+        }
+
+        pipelined_source(char const* path, std::size_t chunk)
+            : impl(path, chunk)
+            , d_free(depth) {
+            for (std::string& buffer: this->d_free) {
+                buffer.reserve(chunk);
+            }
+            this->d_thread = std::thread([this]{ this->run(); });
+        }
+        ~pipelined_source() {
+            {
+                std::lock_guard<std::mutex> lock(this->d_mutex);
+                this->d_stop = true;
+            }
+            this->d_condition.notify_all();
+            this->d_thread.join();
+        }
+        bool next(std::string& buffer) override {
+            std::unique_lock<std::mutex> lock(this->d_mutex);
+            this->d_condition.wait(lock, [this]{
+                    return this->d_end || this->d_error || !this->d_ready.empty();
+                });
+            if (this->d_error) {
+                std::rethrow_exception(this->d_error);
+            }
+            if (this->d_ready.empty()) {
+                return false;
+            }
+            buffer.swap(this->d_ready.front());
+            this->d_free.push_back(std::move(this->d_ready.front()));
+            this->d_ready.pop_front();
+            this->d_condition.notify_all();
+            return true;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::chunk_source::chunk_source(char const* path, stream_mode mode,
+                                      std::size_t chunk_size)
+{
+    switch (mode) {
+    case stream_mode::read:
+        this->d_impl.reset(new read_source(path, chunk_size));
+        break;
+    case stream_mode::mmap:
+        this->d_impl.reset(new mmap_source(path, chunk_size));
+        break;
+    case stream_mode::pipelined:
+        this->d_impl.reset(new pipelined_source(path, chunk_size));
+        break;
+    }
+}
+
+cpu::tube::chunk_source::~chunk_source()
+{
+}
+
+std::uint64_t cpu::tube::chunk_source::size() const
+{
+    return this->d_impl->d_size;
+}
+
+bool cpu::tube::chunk_source::next(std::string& buffer)
+{
+    return this->d_impl->next(buffer);
+}
@@ -0,0 +1,126 @@
+// cpu/tube/stream.hpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_STREAM
+#define INCLUDED_CPU_TUBE_STREAM
+
+#include "cpu/tube/timer.hpp"
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Support for measuring text processing on inputs which don't fit into the
+// caches: a file is fed in fixed-size chunks into a reusable std::string
+// which is passed to the function being measured. The chunks are obtained
+// using one of these modes:
+//
+// - read:      read(2) directly into the buffer
+// - mmap:      copying from a mapping of the whole file
+// - pipelined: a separate thread read(2)s ahead into a few buffers which
+//              are handed to the processing thread
+//
+// The input is synthesised deterministically, i.e., it doesn't depend on a
+// checked-in file: generate_text() creates text with words, identifiers,
+// numbers, punctuation, and lines of varying length. generate_corpus()
+// writes such text to a file unless the file already has the requested
+// size.
+
+namespace cpu
+{
+    namespace tube
+    {
+        enum class stream_mode { read, mmap, pipelined };
+        char const* to_string(stream_mode);
+        struct stream_result;
+        std::ostream& operator<< (std::ostream&, stream_result const&);
+        class chunk_source;
+
+        std::string generate_text(std::size_t size, unsigned seed = 17u);
+        void        generate_corpus(std::string const& path, std::uint64_t size,
+                                    unsigned seed = 17u);
+
+        template <typename Process>
+        stream_result stream_file(char const* path, stream_mode mode,
+                                  std::size_t chunk_size, Process process);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::stream_result
+{
+    cpu::tube::duration time;
+    std::uint64_t       bytes; // the size of the input
+    std::uint64_t       kept;  // the sum of the sizes after processing
+
+    double gb_per_second() const;
+};
+
+// ----------------------------------------------------------------------------
+
+class cpu::tube::chunk_source
+{
+public:
+    struct impl; // the mode specific implementation
+
+private:
+    std::unique_ptr<impl> d_impl;
+
+public:
+    chunk_source(char const* path, stream_mode mode, std::size_t chunk_size);
+    chunk_source(chunk_source const&) = delete;
+    void operator=(chunk_source const&) = delete;
+    ~chunk_source();
+
+    std::uint64_t size() const;
+    // replaces the content of buffer by the next chunk; false at the end
+    bool next(std::string& buffer);
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename Process>
+cpu::tube::stream_result
+cpu::tube::stream_file(char const* path, stream_mode mode, std::size_t chunk_size,
+                       Process process)
+{
+    std::uint64_t kept(0u);
+    std::string   buffer;
+    buffer.reserve(chunk_size);
+    cpu::tube::timer timer;
+    chunk_source source(path, mode, chunk_size);
+    while (source.next(buffer)) {
+        process(buffer);
+        kept += buffer.size();
+    }
+    return stream_result{ timer.measure(), source.size(), kept };
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,218 @@
+// cpu/tube/stream.t.cpp                                              -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/stream.hpp"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    CT::stream_mode const modes[] = {
+        CT::stream_mode::read, CT::stream_mode::mmap, CT::stream_mode::pipelined
+    };
+
+    // a file with the given content which is removed at the end of the scope
+    class temp_file {
+    private:
+        std::string d_path;
+
+    public:
+        explicit temp_file(std::string const& content) {
+            char path[] = "/tmp/cputube-stream-XXXXXX";
+            int  fd(::mkstemp(path));
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "mkstemp()");
+            }
+            ::close(fd);
+            this->d_path = path;
+            std::ofstream(path, std::ios::binary) << content;
+        }
+        temp_file(temp_file const&) = delete;
+        void operator=(temp_file const&) = delete;
+        ~temp_file() { ::unlink(this->d_path.c_str()); }
+        char const* path() const { return this->d_path.c_str(); }
+    };
+
+    std::string contents(char const* path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // the concatenation of the chunks, checking that no chunk is too big
+    std::string drain(char const* path, CT::stream_mode mode, std::size_t chunk) {
+        CT::chunk_source source(path, mode, chunk);
+        std::string      rc, buffer;
+        while (source.next(buffer)) {
+            if (buffer.empty() || chunk < buffer.size()) {
+                return "<bad chunk>";
+            }
+            rc += buffer;
+        }
+        return rc;
+    }
+
+    bool all_modes_deliver(std::string const& content, std::size_t chunk) {
+        temp_file file(content);
+        for (CT::stream_mode mode: modes) {
+            if (CT::chunk_source(file.path(), mode, chunk).size() != content.size()
+                || drain(file.path(), mode, chunk) != content) {
+                std::cout << "mode " << CT::to_string(mode) << " failed for "
+                          << content.size() << " bytes in chunks of " << chunk << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Fun>
+    bool throws_system_error(Fun fun) {
+        try { fun(); }
+        catch (std::system_error const&) { return true; }
+        return false;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "generate_text", []{
+            std::string text(CT::generate_text(10000u));
+            return text.size() == 10000u
+                && text == CT::generate_text(10000u)
+                && text != CT::generate_text(10000u, 18u)
+                && text.find('\n') != text.npos
+                && text.find('\0') == text.npos
+                ;
+        }},
+    { "empty file", []{
+            return all_modes_deliver(std::string(), 4096u);
+        }},
+    { "partial last chunk", []{
+            return all_modes_deliver(CT::generate_text(10000u), 4096u)
+                && all_modes_deliver("x", 4096u)
+                ;
+        }},
+    { "multiple of the chunk size", []{
+            return all_modes_deliver(CT::generate_text(3u * 4096u), 4096u)
+                && all_modes_deliver(CT::generate_text(4096u), 4096u)
+                ;
+        }},
+    { "more chunks than pipeline buffers", []{
+            return all_modes_deliver(CT::generate_text(100000u), 1000u);
+        }},
+    { "stream_file", []{
+            std::string content(CT::generate_text(10000u));
+            temp_file   file(content);
+            for (CT::stream_mode mode: modes) {
+                std::string seen;
+                CT::stream_result result(CT::stream_file(file.path(), mode, 4096u,
+                                                         [&](std::string& buffer){
+                                                             seen += buffer;
+                                                             buffer.resize(buffer.size() / 2u);
+                                                         }));
+                if (seen != content
+                    || result.bytes != content.size()
+                    || result.kept != 2048u + 2048u + 904u) {
+                    return false;
+                }
+            }
+            return true;
+        }},
+    { "open error", []{
+            for (CT::stream_mode mode: modes) {
+                if (!throws_system_error([=]{
+                            CT::chunk_source("/nonexistent/cputube-stream", mode, 4096u);
+                        })) {
+                    return false;
+                }
+            }
+            return true;
+        }},
+    { "read error", []{
+            // a directory can be opened but neither read nor mapped
+            for (CT::stream_mode mode: modes) {
+                if (!throws_system_error([=]{ drain("/tmp", mode, 4096u); })) {
+                    std::cout << "mode " << CT::to_string(mode) << " didn't report\n";
+                    return false;
+                }
+            }
+            return true;
+        }},
+    { "generate_corpus", []{
+            temp_file file("");
+            CT::generate_corpus(file.path(), 5000u);
+            if (contents(file.path()) != CT::generate_text(5000u)) {
+                return false;
+            }
+            // a file with the requested size is kept, otherwise it is replaced
+            std::ofstream(file.path(), std::ios::binary) << std::string(5000u, 'x');
+            CT::generate_corpus(file.path(), 5000u);
+            bool kept(contents(file.path()) == std::string(5000u, 'x'));
+            CT::generate_corpus(file.path(), 3000u);
+            return kept && contents(file.path()) == CT::generate_text(3000u);
+        }},
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
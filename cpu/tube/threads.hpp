@@ -0,0 +1,84 @@
+// cpu/tube/threads.hpp                                               -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_THREADS
+#define INCLUDED_CPU_TUBE_THREADS
+
+#include "cpu/tube/timer.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Support for multi-threaded measurements: run_threads() runs fun(t) for t
+// in [0, threads) on separate threads. The threads are created first and
+// released together, i.e., the returned time from the release to the last
+// thread finishing doesn't include the thread creation and no thread gets
+// a head start. thread_counts() yields the thread counts 1, 2, 4, ... up
+// to max (the number of hardware threads by default) with max itself as
+// the last count.
+
+namespace cpu
+{
+    namespace tube
+    {
+        std::vector<int> thread_counts(int max = 0);
+
+        template <typename Fun>
+        cpu::tube::duration run_threads(int threads, Fun fun);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename Fun>
+cpu::tube::duration cpu::tube::run_threads(int threads, Fun fun)
+{
+    std::atomic<int>         ready{0};
+    std::atomic<bool>        go{false};
+    std::vector<std::thread> pool;
+    for (int t(0); t != threads; ++t) {
+        pool.emplace_back([&, t]{
+                ++ready;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                fun(t);
+            });
+    }
+    while (ready != threads) {
+        std::this_thread::yield();
+    }
+    cpu::tube::timer timer;
+    go = true;
+    for (auto& thread: pool) {
+        thread.join();
+    }
+    return timer.measure();
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
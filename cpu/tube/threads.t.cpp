@@ -0,0 +1,102 @@
+// cpu/tube/threads.t.cpp                                             -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/threads.hpp"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "thread_counts", []{
+            return CT::thread_counts(1) == std::vector<int>{ 1 }
+                && CT::thread_counts(2) == std::vector<int>{ 1, 2 }
+                && CT::thread_counts(8) == std::vector<int>{ 1, 2, 4, 8 }
+                && CT::thread_counts(12) == std::vector<int>{ 1, 2, 4, 8, 12 }
+                && CT::thread_counts().front() == 1
+                && 1 <= CT::thread_counts().back()
+                ;
+        }},
+    { "run_threads", []{
+            std::mutex    mutex;
+            std::set<int> seen;
+            CT::run_threads(5, [&](int t){
+                    std::lock_guard<std::mutex> kerberos(mutex);
+                    seen.insert(t);
+                });
+            return seen == std::set<int>{ 0, 1, 2, 3, 4 };
+        }},
+    { "started together", []{
+            // each thread waits for all others: this only terminates if
+            // all threads run concurrently
+            std::atomic<int> arrived{0};
+            CT::run_threads(4, [&](int){
+                    ++arrived;
+                    while (arrived != 4) {
+                        std::this_thread::yield();
+                    }
+                });
+            return arrived == 4;
+        }},
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
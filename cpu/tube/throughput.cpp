@@ -0,0 +1,89 @@
+// cpu/tube/throughput.cpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "cpu/tube/throughput.hpp"
+#include "cpu/tube/processor.hpp"
+#include <iostream>
+
+// ----------------------------------------------------------------------------
+
+cpu::tube::throughput::throughput(cpu::tube::duration time, cpu::tube::work work)
+    : throughput(time, work, cpu::tube::processor::memory().bandwidth())
+{
+}
+
+cpu::tube::throughput::throughput(cpu::tube::duration time, cpu::tube::work work,
+                                  double peak)
+    : gb_per_second()
+    , items_per_second()
+    , ns_per_item()
+    , percent_of_peak()
+{
+    double const seconds(time.seconds());
+    if (seconds <= 0.0) {
+        return;
+    }
+    if (work.bytes) {
+        this->gb_per_second = double(work.bytes) / seconds * 1e-9;
+        if (0.0 < peak) {
+            this->percent_of_peak = 100.0 * this->gb_per_second / peak;
+        }
+    }
+    if (work.items) {
+        this->items_per_second = double(work.items) / seconds;
+        this->ns_per_item      = seconds * 1e9 / double(work.items);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void cpu::tube::throughput::json(std::ostream& out) const
+{
+    if (this->gb_per_second) {
+        out << "gb_per_second:" << this->gb_per_second << ", ";
+    }
+    if (this->items_per_second) {
+        out << "items_per_second:" << this->items_per_second << ", "
+            << "ns_per_item:" << this->ns_per_item << ", ";
+    }
+    if (this->percent_of_peak) {
+        out << "percent_of_peak:" << this->percent_of_peak << ", ";
+    }
+}
+
+std::ostream& cpu::tube::operator<< (std::ostream& out, throughput const& value)
+{
+    if (value.gb_per_second) {
+        out << "gb/s=" << value.gb_per_second << ',';
+    }
+    if (value.items_per_second) {
+        out << "items/s=" << value.items_per_second << ','
+            << "ns/item=" << value.ns_per_item << ',';
+    }
+    if (value.percent_of_peak) {
+        out << "peak-bw=" << value.percent_of_peak << "%,";
+    }
+    return out;
+}
@@ -0,0 +1,142 @@
+// cpu/tube/throughput.hpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_CPU_TUBE_THROUGHPUT
+#define INCLUDED_CPU_TUBE_THROUGHPUT
+
+#include "cpu/tube/timer.hpp"
+#include <iosfwd>
+#include <utility>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Normalising the measured times: a test declares the work done by a
+// measured region, i.e., the bytes read from and written to memory and
+// the number of items processed. The throughput derived from the time and
+// the work makes results for different sizes and different tests
+// comparable:
+//
+// - gb/s:    the bytes per nanosecond
+// - items/s: the processed items per second
+// - ns/item: the time per processed item
+// - peak-bw: the bandwidth relative to the best bandwidth of the memory
+//            profile (see cpu::tube::processor::memory()), i.e., the
+//            roofline of memory bound code
+//
+// Values which can't be determined, e.g., the peak without a memory profile,
+// are omitted. The work is passed to cpu::tube::context::report() or, with
+// cpu::tube::context::run(), returned from the Measure as a measurement.
+
+namespace cpu
+{
+    namespace tube
+    {
+        struct work;
+        struct throughput;
+        std::ostream& operator<< (std::ostream&, throughput const&);
+
+        template <typename Result> struct measurement;
+        template <typename Result>
+        measurement<Result> make_measurement(duration, Result const&, work);
+
+        template <typename T>
+        work work_of(T const&);
+        template <typename Result>
+        work work_of(measurement<Result> const&);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::work
+{
+    std::uint64_t bytes; // the bytes read and written
+    std::uint64_t items; // the items processed
+
+    bool empty() const { return !this->bytes && !this->items; }
+
+    // items of type T each accessed the given number of times, e.g., 2 for
+    // reading and writing each item
+    template <typename T>
+    static work of(std::uint64_t items, unsigned accesses = 1u) {
+        return work{ items * sizeof(T) * accesses, items };
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+struct cpu::tube::throughput
+{
+    double gb_per_second;    // 0 without bytes
+    double items_per_second; // 0 without items
+    double ns_per_item;      // 0 without items
+    double percent_of_peak;  // 0 without bytes or peak
+
+    // the peak defaults to the bandwidth of the processor's memory profile
+    throughput(cpu::tube::duration time, cpu::tube::work work);
+    throughput(cpu::tube::duration time, cpu::tube::work work, double peak);
+
+    // writes the non-zero values as JSON members, each followed by ", "
+    void json(std::ostream& out) const;
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename Result>
+struct cpu::tube::measurement
+    : std::pair<cpu::tube::duration, Result>
+{
+    cpu::tube::work work;
+
+    measurement(cpu::tube::duration time, Result const& result, cpu::tube::work work)
+        : std::pair<cpu::tube::duration, Result>(time, result)
+        , work(work) {
+    }
+};
+
+template <typename Result>
+cpu::tube::measurement<Result>
+cpu::tube::make_measurement(cpu::tube::duration time, Result const& result, cpu::tube::work work)
+{
+    return cpu::tube::measurement<Result>(time, result, work);
+}
+
+template <typename T>
+cpu::tube::work
+cpu::tube::work_of(T const&)
+{
+    return cpu::tube::work{ 0u, 0u };
+}
+
+template <typename Result>
+cpu::tube::work
+cpu::tube::work_of(cpu::tube::measurement<Result> const& measurement)
+{
+    return measurement.work;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
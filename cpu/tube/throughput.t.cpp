@@ -0,0 +1,136 @@
+// cpu/tube/throughput.t.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//  Copyright (C) 2018 Dietmar Kuehl http://www.dietmar-kuehl.de         
+//                                                                       
+//  Permission is hereby granted, free of charge, to any person          
+//  obtaining a copy of this software and associated documentation       
+//  files (the "Software"), to deal in the Software without restriction, 
+//  including without limitation the rights to use, copy, modify,        
+//  merge, publish, distribute, sublicense, and/or sell copies of        
+//  the Software, and to permit persons to whom the Software is          
+//  furnished to do so, subject to the following conditions:             
+//                                                                       
+//  The above copyright notice and this permission notice shall be       
+//  included in all copies or substantial portions of the Software.      
+//                                                                       
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,      
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES      
+//  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND             
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT          
+//  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,         
+//  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING         
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR        
+//  OTHER DEALINGS IN THE SOFTWARE. 
+// ----------------------------------------------------------------------------
+
+#include "throughput.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+namespace CT = cpu::tube;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+    CT::duration milliseconds(long ms) {
+        return std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::milliseconds(ms));
+    }
+    bool near(double value, double expect) {
+        return std::abs(value - expect) <= 1e-9 * std::abs(expect);
+    }
+    template <typename T>
+    std::string text(T const& value) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static std::pair<char const*, bool(*)()> const tests[] = {
+    { "work", []{
+            CT::work none{ 0u, 0u };
+            CT::work doubles(CT::work::of<double>(1000u, 2u));
+            return none.empty()
+                && !doubles.empty()
+                && doubles.bytes == 16000u
+                && doubles.items == 1000u;
+        }
+    },
+    { "seconds", []{
+            return near(milliseconds(250).seconds(), 0.25)
+                && milliseconds(250).microseconds() == 250000u;
+        }
+    },
+    { "throughput", []{
+            // 2GB and 500M items in 500ms against a 16GB/s peak
+            CT::throughput t(milliseconds(500), CT::work{ 2000000000u, 500000000u }, 16.0);
+            return near(t.gb_per_second, 4.0)
+                && near(t.items_per_second, 1e9)
+                && near(t.ns_per_item, 1.0)
+                && near(t.percent_of_peak, 25.0)
+                && text(t) == "gb/s=4,items/s=1e+09,ns/item=1,peak-bw=25%,";
+        }
+    },
+    { "partial", []{
+            CT::throughput items(milliseconds(2), CT::work{ 0u, 1000u }, 16.0);
+            CT::throughput bytes(milliseconds(2), CT::work{ 4000000u, 0u }, 0.0);
+            CT::throughput none(milliseconds(0), CT::work{ 4000000u, 1000u }, 16.0);
+            std::ostringstream json;
+            items.json(json);
+            return text(items) == "items/s=500000,ns/item=2000,"
+                && json.str() == "items_per_second:500000, ns_per_item:2000, "
+                && text(bytes) == "gb/s=2,"
+                && text(none) == "";
+        }
+    },
+    { "measurement", []{
+            auto m(CT::make_measurement(milliseconds(1), 17, CT::work{ 8u, 1u }));
+            auto p(std::make_pair(milliseconds(1), 17));
+            return m.first.microseconds() == 1000u
+                && m.second == 17
+                && CT::work_of(m).bytes == 8u
+                && CT::work_of(m).items == 1u
+                && CT::work_of(p).empty();
+        }
+    },
+};
+
+// ----------------------------------------------------------------------------
+
+static bool run_test(std::pair<char const*, bool(*)()> test) {
+    static char const* const fail{"\x1b[31mFAIL\x1b[0m: "};
+    bool rc{false};
+    try {
+        rc = test.second();
+        std::cout << (rc? "PASS: ": fail) << test.first << "\n";
+    }
+    catch (std::exception const& ex) {
+        std::cout << "ERROR: " << test.first << " caught exception: "
+                  << ex.what() << "\n";
+    }
+    catch (...) {
+        std::cout << "ERROR: " << test.first << " caught unknown exception\n";
+    }
+    return rc;
+}
+
+// ----------------------------------------------------------------------------
+
+int main()
+{
+    int rc = EXIT_SUCCESS;
+    for (auto test: tests) {
+        if (!run_test(test)) {
+            rc = EXIT_FAILURE;
+        }
+    }
+    return rc;
+}
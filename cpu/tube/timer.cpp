@@ -33,6 +33,15 @@ unsigned long cpu::tube::duration::microseconds() const
     return duration_cast<cpu::tube::chrono::microseconds>(this->d_duration).count();
 }
 
+double cpu::tube::duration::seconds() const
+{
+#ifdef USE_CXX11
+    return std::chrono::duration<double>(this->d_duration).count();
+#else
+    return this->microseconds() * 1e-6;
+#endif
+}
+
 std::ostream& cpu::tube::duration::print(std::ostream& out) const
 {
     return out << this->microseconds();
@@ -55,22 +55,38 @@ public:
     duration(clock::time_point::duration value): d_duration(value) {}
     std::ostream& print(std::ostream& out) const;
     unsigned long microseconds() const;
+    double        seconds() const;
 };
 
 // ----------------------------------------------------------------------------
 
+// A timer can be given a function which is called with its argument each
+// time the time is measured, after the clock was read. cpu::tube::context
+// uses that to end the region of the counters, too.
+
 class cpu::tube::timer
 {
 private:
     friend class cpu::tube::duration;
     typedef cpu::tube::chrono::high_resolution_clock clock;
     clock::time_point d_start;
+    void            (*d_stop)(void*);
+    void*             d_argument;
 
     clock::time_point::duration intern_measure() const {
-        return clock::now() - this->d_start;
+        clock::time_point::duration rc(clock::now() - this->d_start);
+        if (this->d_stop) {
+            this->d_stop(this->d_argument);
+        }
+        return rc;
     }
 public:
-    timer(): d_start(clock::now()) {}
+    timer(): d_start(clock::now()), d_stop(), d_argument() {}
+    timer(void (*stop)(void*), void* argument)
+        : d_start(clock::now())
+        , d_stop(stop)
+        , d_argument(argument) {
+    }
 
     cpu::tube::duration measure() const {
         return this->intern_measure();